@@ -0,0 +1,188 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file convert.c
+ * @brief 型変換つきの配列のアンパック・パックの試験
+ *
+ * ワイヤ上の型と格納先の型のすべての組み合わせについて、両方のエンディアン、
+ * スケール・オフセットの有無で、cstruct_unpack_convert()とcstruct_pack_convert()の
+ * 結果をlong doubleで計算した素朴な実装と比べます。
+ *
+ * ビルドはREADMEの「Host Examples」を参照してください。
+ * 成功すると"OK"を表示して0を、失敗すると理由を表示して1を返します。
+ */
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cstruct/cstruct.h"
+
+#define COUNT 200 // ブロック（64要素）をまたぎ、端数も残る要素数
+
+static int failures;
+
+static void check(int cond, const char *what, int wtype, int ctype, int endian, int scaled)
+{
+    if (!cond) {
+        printf("FAILED: %s (wire %d, c %d, endian %d, scaled %d)\n", what, wtype, ctype, endian, scaled);
+        failures++;
+    }
+}
+
+// ワイヤ上のバイト数（型の列挙値で引く）
+static size_t wire_size(int type)
+{
+    static const size_t SIZE[] = {1, 1, 2, 2, 4, 4, 8, 8, 16, 16, 2, 4, 8};
+    return SIZE[type];
+}
+
+// C言語上のバイト数（float16はfloatで受け渡す）
+static size_t c_size(int type)
+{
+    return type == CSTRUCT_TYPE_FLOAT16 ? 4 : wire_size(type);
+}
+
+static long double get(int type, const void *p)
+{
+    switch (type) {
+        case CSTRUCT_TYPE_INT8:   return *(const int8_t *)p;
+        case CSTRUCT_TYPE_UINT8:  return *(const uint8_t *)p;
+        case CSTRUCT_TYPE_INT16:  return *(const int16_t *)p;
+        case CSTRUCT_TYPE_UINT16: return *(const uint16_t *)p;
+        case CSTRUCT_TYPE_INT32:  return *(const int32_t *)p;
+        case CSTRUCT_TYPE_UINT32: return *(const uint32_t *)p;
+        case CSTRUCT_TYPE_INT64:  return *(const int64_t *)p;
+        case CSTRUCT_TYPE_UINT64: return *(const uint64_t *)p;
+        case CSTRUCT_TYPE_FLOAT64: return *(const double *)p;
+        default:                  return *(const float *)p;
+    }
+}
+
+// 素朴な実装: 整数は最も近い整数に丸め（0.5は0から遠い方）、範囲外は飽和、NaNは0
+static void put(int type, void *p, long double v, int exact)
+{
+    static const long double LO[] = {-128.0L, 0, -32768.0L, 0, -2147483648.0L, 0, -9223372036854775808.0L, 0};
+    static const long double HI[] = {127.0L, 255.0L, 32767.0L, 65535.0L, 2147483647.0L, 4294967295.0L,
+                                     9223372036854775807.0L, 18446744073709551615.0L};
+    if (type == CSTRUCT_TYPE_FLOAT64) {
+        *(double *)p = (double)v;
+        return;
+    }
+    if (type >= CSTRUCT_TYPE_FLOAT16) {
+        *(float *)p = (float)v;
+        return;
+    }
+    if (v != v) {
+        v = 0;
+    }
+    if (v <= LO[type]) {
+        v = LO[type];
+    } else if (v >= HI[type]) {
+        v = HI[type];
+    } else if (!exact) {
+        v = v >= 0 ? floorl(v + 0.5L) : ceill(v - 0.5L);
+    }
+    switch (type) {
+        case CSTRUCT_TYPE_INT8:   *(int8_t *)p = (int8_t)v; break;
+        case CSTRUCT_TYPE_UINT8:  *(uint8_t *)p = (uint8_t)v; break;
+        case CSTRUCT_TYPE_INT16:  *(int16_t *)p = (int16_t)v; break;
+        case CSTRUCT_TYPE_UINT16: *(uint16_t *)p = (uint16_t)v; break;
+        case CSTRUCT_TYPE_INT32:  *(int32_t *)p = (int32_t)v; break;
+        case CSTRUCT_TYPE_UINT32: *(uint32_t *)p = (uint32_t)v; break;
+        case CSTRUCT_TYPE_INT64:  *(int64_t *)p = (int64_t)v; break;
+        default:                  *(uint64_t *)p = (uint64_t)v; break;
+    }
+}
+
+static void check_pair(int wtype, int ctype, cstruct_endian_t endian, int scaled)
+{
+    cstruct_token_t tok = {(cstruct_type_t)wtype, endian, wire_size(wtype), COUNT, 0};
+    uint8_t wire[COUNT * 8], wire2[COUNT * 8], want_wire[COUNT * 8];
+    uint8_t native[COUNT * 8], out[COUNT * 8], want[COUNT * 8], back[COUNT * 8];
+    double scale = scaled ? 0.37 : 1.0;
+    double offset = scaled ? -3.5 : 0.0;
+    // 整数どうしでスケール・オフセットなしの場合は浮動小数点数を経由しない
+    int exact = !scaled && wtype < CSTRUCT_TYPE_INT128 && ctype < CSTRUCT_TYPE_INT128;
+
+    for (size_t i = 0; i < sizeof(wire); i++) {
+        wire[i] = (uint8_t)rand();
+    }
+    if (wtype >= CSTRUCT_TYPE_FLOAT16) {
+        // NaNのビットパターンは比較できないため、有限の値にしておく
+        float f[COUNT];
+        double d[COUNT];
+        for (size_t i = 0; i < COUNT; i++) {
+            f[i] = (float)(d[i] = (rand() % 200000 - 100000) / 7.0);
+        }
+        cstruct_pack_token(wire, &tok, wtype == CSTRUCT_TYPE_FLOAT64 ? (const void *)d : (const void *)f);
+    }
+
+    // アンパック: x * scale + offset
+    cstruct_unpack_token(wire, &tok, native);
+    for (size_t i = 0; i < COUNT; i++) {
+        long double x = get(wtype, native + i * c_size(wtype));
+        put(ctype, want + i * c_size(ctype), exact ? x : (long double)((double)x * scale + offset), exact);
+    }
+    const void *end = cstruct_unpack_convert(wire, sizeof(wire), &tok, out, (cstruct_type_t)ctype, scale, offset);
+    check(end == wire + COUNT * tok.size, "unpack end", wtype, ctype, endian, scaled);
+    check(memcmp(out, want, COUNT * c_size(ctype)) == 0, "unpack", wtype, ctype, endian, scaled);
+
+    // パック: (v - offset) / scale
+    int back_type = wtype == CSTRUCT_TYPE_FLOAT16 ? CSTRUCT_TYPE_FLOAT32 : wtype;
+    for (size_t i = 0; i < COUNT; i++) {
+        long double v = get(ctype, out + i * c_size(ctype));
+        put(back_type, back + i * c_size(wtype), exact ? v : (long double)(((double)v - offset) / scale), exact);
+    }
+    cstruct_pack_token(want_wire, &tok, back);
+    end = cstruct_pack_convert(wire2, sizeof(wire2), &tok, out, (cstruct_type_t)ctype, scale, offset);
+    check(end == wire2 + COUNT * tok.size, "pack end", wtype, ctype, endian, scaled);
+    check(memcmp(wire2, want_wire, COUNT * tok.size) == 0, "pack", wtype, ctype, endian, scaled);
+}
+
+// 対応していない型・引数はエラーになる
+static void check_errors(void)
+{
+    cstruct_token_t tok = {CSTRUCT_TYPE_INT16, CSTRUCT_ENDIAN_LITTLE, 2, 4, 0};
+    uint8_t wire[8] = {0};
+    float f[4] = {0};
+    check(cstruct_unpack_convert(wire, 7, &tok, f, CSTRUCT_TYPE_FLOAT32, 1.0, 0.0) == NULL, "short input", 0, 0, 0, 0);
+    check(cstruct_pack_convert(wire, 7, &tok, f, CSTRUCT_TYPE_FLOAT32, 1.0, 0.0) == NULL, "short output", 0, 0, 0, 0);
+    check(cstruct_pack_convert(wire, 8, &tok, f, CSTRUCT_TYPE_FLOAT32, 0.0, 0.0) == NULL, "zero scale", 0, 0, 0, 0);
+    check(cstruct_unpack_convert(wire, 8, &tok, f, CSTRUCT_TYPE_FLOAT16, 1.0, 0.0) == NULL, "float16 dest", 0, 0, 0, 0);
+    tok.type = CSTRUCT_TYPE_INT128;
+    tok.size = 16;
+    tok.count = 1;
+    check(cstruct_unpack_convert(wire, 16, &tok, f, CSTRUCT_TYPE_FLOAT32, 1.0, 0.0) == NULL, "int128", 0, 0, 0, 0);
+}
+
+int main(void)
+{
+    static const int TYPES[] = {
+        CSTRUCT_TYPE_INT8,  CSTRUCT_TYPE_UINT8,  CSTRUCT_TYPE_INT16,   CSTRUCT_TYPE_UINT16,
+        CSTRUCT_TYPE_INT32, CSTRUCT_TYPE_UINT32, CSTRUCT_TYPE_INT64,   CSTRUCT_TYPE_UINT64,
+        CSTRUCT_TYPE_FLOAT16, CSTRUCT_TYPE_FLOAT32, CSTRUCT_TYPE_FLOAT64,
+    };
+    const size_t ntypes = sizeof(TYPES) / sizeof(TYPES[0]);
+
+    srand(1);
+    for (size_t w = 0; w < ntypes; w++) {
+        for (size_t c = 0; c < ntypes; c++) {
+            if (TYPES[c] == CSTRUCT_TYPE_FLOAT16) {
+                continue; // float16はワイヤ上の型としてのみ扱える
+            }
+            for (int scaled = 0; scaled < 2; scaled++) {
+                check_pair(TYPES[w], TYPES[c], CSTRUCT_ENDIAN_LITTLE, scaled);
+                check_pair(TYPES[w], TYPES[c], CSTRUCT_ENDIAN_BIG, scaled);
+            }
+        }
+    }
+    check_errors();
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,169 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file ingest_loopback.c
+ * @brief cstruct_ingestのループバック試験（Linux専用）
+ *
+ * 127.0.0.1で待ち受けたインジェストサーバへUDPデータグラム20個とTCPフレーム10個を送り、
+ * すべてのフレームが正しくデコードされることを確認します。
+ * TCPフレームのうち1つは2回のsend()に分けて送り、read境界をまたいだフレームを試験します。
+ * また、構造体へデコードできないプランを初期化時に拒否することを確認します。
+ *
+ * ビルドはREADMEの「Host Examples」を参照してください。
+ * 成功すると"OK"を表示して0を、失敗すると理由を表示して1を返します。
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "cstruct/cstruct_ingest.h"
+
+#define UDP_FRAMES 20
+#define TCP_FRAMES 10
+#define SPLIT_FRAME 4   // 2回に分けて送るTCPフレーム
+
+// 種別1: 種別バイト, 通番, 値
+typedef struct {
+    uint8_t type;
+    uint16_t seq;
+    int32_t value;
+} sample_t;
+
+static const char SAMPLE_FORMAT[] = "<BHi";
+
+static int received;
+static int errors;
+
+static void on_sample(void *ctx, const uint8_t *frame, size_t len, void *record)
+{
+    const sample_t *s = (const sample_t *)record;
+    (void)ctx;
+    (void)frame;
+
+    // 通番順に届き、値は通番から決まる
+    if (len != 7 || s->type != 1 || s->seq != received || s->value != -1000 * (int32_t)s->seq) {
+        printf("bad frame #%d: len=%zu type=%u seq=%u value=%ld\n", received, len, s->type, s->seq,
+               (long)s->value);
+        errors++;
+    }
+    received++;
+}
+
+// 全フレームが届くまで（最大で約2秒）ポーリングする
+static void poll_until(cstruct_ingest_t *ing, int expected)
+{
+    for (int i = 0; i < 100 && received < expected; i++) {
+        cstruct_ingest_poll(ing, 20);
+    }
+}
+
+int main(void)
+{
+    cstruct_token_t tokens[4];
+    cstruct_plan_t plan;
+    if (!cstruct_compile(&plan, tokens, 4, SAMPLE_FORMAT)) {
+        printf("compile failed\n");
+        return 1;
+    }
+
+    static const size_t offsets[] = {offsetof(sample_t, type), offsetof(sample_t, seq), offsetof(sample_t, value)};
+    sample_t record;
+    const cstruct_ingest_route_t routes[] = {{1, &plan, offsets, &record, on_sample, NULL}};
+
+    cstruct_ingest_t ing;
+
+    // インターリーブした配列を含むプランは構造体へデコードできない
+    cstruct_token_t il_tokens[4];
+    cstruct_plan_t il_plan;
+    cstruct_compile(&il_plan, il_tokens, 4, "<BH2*2h");
+    const cstruct_ingest_route_t il_routes[] = {{1, &il_plan, offsets, &record, on_sample, NULL}};
+    if (cstruct_ingest_init(&ing, il_routes, 1, 0, 8, 256) != NULL) {
+        printf("interleaved plan with offsets was accepted\n");
+        cstruct_ingest_close(&ing);
+        return 1;
+    }
+
+    if (!cstruct_ingest_init(&ing, routes, 1, 0, 8, 256)) {
+        printf("init failed\n");
+        return 1;
+    }
+    int udp_port = cstruct_ingest_listen_udp(&ing, "127.0.0.1", 0);
+    int tcp_port = cstruct_ingest_listen_tcp(&ing, "127.0.0.1", 0);
+    if (udp_port < 0 || tcp_port < 0) {
+        printf("listen failed\n");
+        cstruct_ingest_close(&ing);
+        return 1;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    uint8_t frame[16];
+    int seq = 0;
+
+    // UDP: 1データグラムに1フレーム
+    int us = socket(AF_INET, SOCK_DGRAM, 0);
+    addr.sin_port = htons((uint16_t)udp_port);
+    for (int i = 0; i < UDP_FRAMES; i++, seq++) {
+        uint8_t *end = cstruct_pack(frame, sizeof(frame), SAMPLE_FORMAT, 1, seq, -1000 * seq);
+        sendto(us, frame, (size_t)(end - frame), 0, (const struct sockaddr *)&addr, sizeof(addr));
+    }
+    close(us);
+    poll_until(&ing, UDP_FRAMES);
+
+    // TCP: 1フレームずつ送り、SPLIT_FRAMEだけは途中で分けて送る
+    int ts = socket(AF_INET, SOCK_STREAM, 0);
+    addr.sin_port = htons((uint16_t)tcp_port);
+    if (connect(ts, (const struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        printf("connect failed\n");
+        close(ts);
+        cstruct_ingest_close(&ing);
+        return 1;
+    }
+    for (int i = 0; i < TCP_FRAMES; i++, seq++) {
+        uint8_t *end = cstruct_pack(frame, sizeof(frame), SAMPLE_FORMAT, 1, seq, -1000 * seq);
+        size_t len = (size_t)(end - frame);
+        if (i == SPLIT_FRAME) {
+            send(ts, frame, 3, 0);
+            for (int k = 0; k < 5; k++) {   // 前半だけを受信させる
+                cstruct_ingest_poll(&ing, 20);
+            }
+            if (received != seq) {
+                printf("split frame was dispatched before it was complete\n");
+                errors++;
+            }
+            send(ts, frame + 3, len - 3, 0);
+        } else {
+            send(ts, frame, len, 0);
+        }
+        poll_until(&ing, seq + 1);
+    }
+    close(ts);
+    for (int i = 0; i < 5 && ing.stats.closed == 0; i++) {
+        cstruct_ingest_poll(&ing, 20);
+    }
+
+    printf("received=%d/%d datagrams=%llu accepted=%llu closed=%llu unknown=%llu truncated=%llu undecoded=%llu\n",
+           received, UDP_FRAMES + TCP_FRAMES, (unsigned long long)ing.stats.datagrams,
+           (unsigned long long)ing.stats.accepted, (unsigned long long)ing.stats.closed,
+           (unsigned long long)ing.stats.unknown, (unsigned long long)ing.stats.truncated,
+           (unsigned long long)ing.stats.undecoded);
+
+    int ok = received == UDP_FRAMES + TCP_FRAMES && errors == 0 && ing.stats.datagrams == UDP_FRAMES &&
+             ing.stats.accepted == 1 && ing.stats.closed == 1 && ing.stats.unknown == 0 && ing.stats.truncated == 0 &&
+             ing.stats.undecoded == 0;
+    cstruct_ingest_close(&ing);
+
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
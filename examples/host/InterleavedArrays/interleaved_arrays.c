@@ -0,0 +1,186 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file interleaved_arrays.c
+ * @brief インターリーブした配列（C*N）の試験
+ *
+ * 乱数で作ったチャネル数・サンプル数・型について、"C*Nt"でのパック・アンパックの結果が
+ * 自前でインターリーブした配列を"(C*N)t"でパック・アンパックした結果と一致することを確認します。
+ * また、構造体・列を扱う関数がインターリーブした配列を含むプランに対して
+ * 何も書き込まずにエラーを返すことを確認します。
+ *
+ * ビルドはREADMEの「Host Examples」を参照してください。
+ * 成功すると"OK"を表示して0を、失敗すると理由を表示して1を返します。
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cstruct/cstruct.h"
+
+#define MAX_CHANNELS 8
+#define MAX_FRAMES 64
+#define ITERATIONS 3000
+
+// 型指定子と、1要素を受け渡すC言語上のバイト数
+static const struct {
+    const char *spec;
+    size_t csize;
+} TYPES[] = {
+    {"b", 1}, {"B", 1}, {"h", 2}, {"H", 2}, {"i", 4}, {"I", 4}, {"q", 8}, {"Q", 8},
+    {"E", 2}, {"i:24", 4}, {"Q:48", 8}, {"t", 16},
+};
+
+static int failures;
+
+static void check(int cond, const char *what, const char *fmt)
+{
+    if (!cond) {
+        printf("FAILED: %s (%s)\n", what, fmt);
+        failures++;
+    }
+}
+
+// 乱数で作ったインターリーブした配列を、平坦な配列を使った結果と比べる
+static void check_random(void)
+{
+    static uint8_t chans[MAX_CHANNELS][MAX_FRAMES * 16];
+    static uint8_t got[MAX_CHANNELS][MAX_FRAMES * 16 + 1];
+    static uint8_t flat[MAX_CHANNELS * MAX_FRAMES * 16];
+    static uint8_t wire1[MAX_CHANNELS * MAX_FRAMES * 16], wire2[MAX_CHANNELS * MAX_FRAMES * 16];
+
+    for (int it = 0; it < ITERATIONS; it++) {
+        size_t t = (size_t)rand() % (sizeof(TYPES) / sizeof(TYPES[0]));
+        size_t es = TYPES[t].csize;
+        size_t nch = (size_t)rand() % MAX_CHANNELS + 1;
+        size_t frames = (size_t)rand() % MAX_FRAMES + 1;
+        if (nch * frames == 1) {
+            continue; // 要素数1の平坦な配列は値そのもので受け渡すため比較できない
+        }
+        char order = (rand() & 1) ? '>' : '<';
+        char fmt[32], flat_fmt[32];
+        snprintf(fmt, sizeof(fmt), "%c%zu*%zu%s", order, nch, frames, TYPES[t].spec);
+        snprintf(flat_fmt, sizeof(flat_fmt), "%c%zu%s", order, nch * frames, TYPES[t].spec);
+
+        for (size_t c = 0; c < nch; c++) {
+            for (size_t k = 0; k < frames * es; k++) {
+                chans[c][k] = (uint8_t)rand();
+            }
+        }
+        // 幅を縮めた型はワイヤに収まる値にしておく（往復で一致させるため）
+        if (strcmp(TYPES[t].spec, "i:24") == 0 || strcmp(TYPES[t].spec, "Q:48") == 0) {
+            for (size_t c = 0; c < nch; c++) {
+                for (size_t k = 0; k < frames; k++) {
+                    if (es == 4) {
+                        int32_t v = (int32_t)(rand() % 0x1000000) - 0x800000;
+                        memcpy(chans[c] + 4 * k, &v, 4);
+                    } else {
+                        uint64_t v = ((uint64_t)rand() << 24 ^ (uint64_t)rand()) & 0xFFFFFFFFFFFFull;
+                        memcpy(chans[c] + 8 * k, &v, 8);
+                    }
+                }
+            }
+        }
+
+        // チャネルを1つNULLにする（パックはゼロ、アンパックは読み飛ばし）
+        int skip = (nch > 1 && rand() % 4 == 0) ? rand() % (int)nch : -1;
+        const void *in[MAX_CHANNELS];
+        void *out[MAX_CHANNELS];
+        for (size_t c = 0; c < nch; c++) {
+            in[c] = (int)c == skip ? NULL : chans[c];
+            out[c] = (int)c == skip ? NULL : got[c];
+            for (size_t f = 0; f < frames; f++) {
+                uint8_t *d = flat + (f * nch + c) * es;
+                if ((int)c == skip) {
+                    memset(d, 0, es);
+                } else {
+                    memcpy(d, chans[c] + f * es, es);
+                }
+            }
+        }
+
+        size_t size = cstruct_calcsize(fmt);
+        check(size != 0 && size == cstruct_calcsize(flat_fmt), "calcsize", fmt);
+        uint8_t *e1 = (uint8_t *)cstruct_pack(wire1, sizeof(wire1), fmt, in);
+        uint8_t *e2 = (uint8_t *)cstruct_pack(wire2, sizeof(wire2), flat_fmt, flat);
+        check(e1 == wire1 + size && e2 == wire2 + size && memcmp(wire1, wire2, size) == 0, "pack", fmt);
+
+        memset(got, 0xCC, sizeof(got));
+        check(cstruct_unpack(wire1, size, fmt, out) == wire1 + size, "unpack end", fmt);
+        cstruct_unpack(wire2, size, flat_fmt, flat);
+        for (size_t c = 0; c < nch; c++) {
+            for (size_t f = 0; f < frames; f++) {
+                int ok = (int)c == skip ? got[c][f * es] == 0xCC : memcmp(got[c] + f * es, flat + (f * nch + c) * es, es) == 0;
+                if (!ok) {
+                    check(0, "unpack", fmt);
+                    c = nch;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// 構造体・列を扱う関数は、インターリーブした配列を含むプランを書き込まずに拒否する
+typedef struct {
+    uint16_t id;
+    int16_t samples[8];
+} record_t;
+
+static void check_struct_paths(void)
+{
+    static const char fmt[] = "<H2*4h";
+    cstruct_token_t tokens[4];
+    cstruct_plan_t plan;
+    if (!cstruct_compile(&plan, tokens, 4, fmt)) {
+        check(0, "compile", fmt);
+        return;
+    }
+
+    uint8_t wire[3 * 18];
+    for (size_t i = 0; i < sizeof(wire); i++) {
+        wire[i] = (uint8_t)i;
+    }
+    const size_t offsets[] = {offsetof(record_t, id), offsetof(record_t, samples)};
+    record_t recs[3], poison;
+    memset(recs, 0xA5, sizeof(recs));
+    memset(&poison, 0xA5, sizeof(poison));
+
+    check(cstruct_unpack_struct(wire, sizeof(wire), &plan, &recs[0], offsets) == NULL, "unpack_struct", fmt);
+    check(cstruct_unpack_batch_struct(wire, sizeof(wire), &plan, recs, sizeof(record_t), offsets, 3) == NULL,
+          "unpack_batch_struct", fmt);
+    for (int i = 0; i < 3; i++) {
+        check(memcmp(&recs[i], &poison, sizeof(poison)) == 0, "struct written", fmt);
+    }
+
+    uint16_t ids[3];
+    int16_t samples[3][8];
+    void *columns[] = {ids, samples};
+    memset(ids, 0xA5, sizeof(ids));
+    check(cstruct_unpack_batch(wire, sizeof(wire), &plan, columns, 3) == NULL, "unpack_batch", fmt);
+    check(ids[0] == 0xA5A5 && ids[2] == 0xA5A5, "column written", fmt);
+
+    uint8_t out[sizeof(wire)];
+    memset(out, 0xA5, sizeof(out));
+    check(cstruct_pack_struct(out, sizeof(out), &plan, &recs[0], offsets) == NULL, "pack_struct", fmt);
+    check(out[0] == 0xA5 && out[1] == 0xA5, "output written", fmt);
+
+    cstruct_run_t runs[4];
+    cstruct_binding_t binding;
+    check(cstruct_bind(&binding, runs, 4, &plan, offsets, 0) == NULL, "bind", fmt);
+}
+
+int main(void)
+{
+    srand(1);
+    check_random();
+    check_struct_paths();
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
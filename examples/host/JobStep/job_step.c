@@ -0,0 +1,206 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file job_step.c
+ * @brief 分割して進めるパック・アンパック（cstruct_job）の試験
+ *
+ * 乱数で作ったフォーマット（配列・文字列・パディング・インターリーブした配列を含む）を、
+ * 乱数で決めたバイト数ずつcstruct_job_step()で進め、結果をcstruct_pack_a()・
+ * cstruct_unpack_a()で一度に処理した結果と比べます。あわせて、1回の呼び出しで
+ * 進むバイト数が予算（分けられない単位より小さい場合はその単位）を超えないことと、
+ * 予算0でも必ず進むことを確認します。
+ *
+ * ビルドはREADMEの「Host Examples」を参照してください。
+ * 成功すると"OK"を表示して0を、失敗すると理由を表示して1を返します。
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cstruct/cstruct.h"
+#include "cstruct/cstruct_job.h"
+
+#define MAX_FIELDS 8
+#define MAX_CHANNELS 4
+#define SLOT 1024 // 1フィールド（インターリーブした配列では1チャネル）分の値の領域
+#define ITERATIONS 5000
+
+// フィールドの候補（"x"で始まるものはパディング、"*"を含むものはインターリーブした配列）
+static const char *const FIELDS[] = {
+    "b",  "H",    "i",     "Q",    "e",      "f",    "d",      "t",     "T",       "5s",      "3x",
+    "17h", "40f", "9e", "6i:24", "8H:12", "3*5h", "2*7e", "4*3i:24", "2*3Q:40", "3*2t",
+};
+
+static int failures;
+
+static void check(int cond, const char *what, const char *fmt)
+{
+    if (!cond) {
+        printf("FAILED: %s (%s)\n", what, fmt);
+        failures++;
+    }
+}
+
+// 1回の呼び出しで分けられない最大のバイト数（配列の1要素、インターリーブした配列の1フレーム、文字列・パディング全体）
+static size_t largest_unit(const cstruct_plan_t *plan)
+{
+    size_t unit = 0;
+    for (size_t i = 0; i < plan->count; i++) {
+        const cstruct_token_t *tok = &plan->tokens[i];
+        size_t u = tok->size;
+        if (tok->type == CSTRUCT_TYPE_STRING || tok->type == CSTRUCT_TYPE_PADDING) {
+            u = tok->size * tok->count;
+        } else if (tok->channels != 0) {
+            u = tok->size * tok->channels;
+        }
+        unit = u > unit ? u : unit;
+    }
+    return unit;
+}
+
+// ジョブを乱数で決めた予算ずつ完了まで進め、1回あたりの進み方を確かめる
+static void run_job(cstruct_job_t *job, size_t unit, const char *fmt)
+{
+    size_t prev = job->offset;
+    int more;
+    do {
+        size_t budget = (size_t)rand() % 4 == 0 ? 0 : (size_t)rand() % 64;
+        more = cstruct_job_step(job, budget);
+        size_t step = job->offset - prev;
+        if (step == 0 || step > (budget > unit ? budget : unit)) {
+            check(0, "step size", fmt);
+            return;
+        }
+        prev = job->offset;
+    } while (more);
+    check(cstruct_job_done(job) && job->offset == job->plan->size, "job done", fmt);
+}
+
+static void check_random(void)
+{
+    static uint8_t values[MAX_FIELDS][MAX_CHANNELS][SLOT];
+    static uint8_t want[MAX_FIELDS][MAX_CHANNELS][SLOT], got[MAX_FIELDS][MAX_CHANNELS][SLOT];
+    static uint8_t ref[MAX_FIELDS * 512], out[MAX_FIELDS * 512];
+
+    for (int it = 0; it < ITERATIONS; it++) {
+        // フォーマットを作る（末尾のBで、少なくとも1つはパディング以外のフィールドを含む）
+        size_t npieces = (size_t)rand() % (MAX_FIELDS - 1) + 1;
+        char fmt[128];
+        size_t len = (size_t)snprintf(fmt, sizeof(fmt), "%c", (rand() & 1) ? '>' : '<');
+        for (size_t k = 0; k < npieces; k++) {
+            const char *piece = FIELDS[(size_t)rand() % (sizeof(FIELDS) / sizeof(FIELDS[0]))];
+            len += (size_t)snprintf(fmt + len, sizeof(fmt) - len, "%s", piece);
+        }
+        len += (size_t)snprintf(fmt + len, sizeof(fmt) - len, "B");
+
+        cstruct_token_t tokens[MAX_FIELDS];
+        cstruct_plan_t plan;
+        if (!cstruct_compile(&plan, tokens, MAX_FIELDS, fmt)) {
+            check(0, "compile", fmt);
+            continue;
+        }
+
+        // フィールドごとの値と格納先（インターリーブした配列はチャネルごとのポインタ配列）
+        const void *chan_in[MAX_FIELDS][MAX_CHANNELS];
+        void *chan_want[MAX_FIELDS][MAX_CHANNELS], *chan_got[MAX_FIELDS][MAX_CHANNELS];
+        const void *args[MAX_FIELDS];
+        void *want_args[MAX_FIELDS], *got_args[MAX_FIELDS];
+        for (size_t i = 0; i < sizeof(values); i++) {
+            ((uint8_t *)values)[i] = (uint8_t)rand();
+        }
+        memset(want, 0xCC, sizeof(want));
+        memset(got, 0xCC, sizeof(got));
+        size_t field = 0;
+        for (size_t i = 0; i < plan.count; i++) {
+            const cstruct_token_t *tok = &plan.tokens[i];
+            if (tok->type == CSTRUCT_TYPE_PADDING) {
+                continue;
+            }
+            int skip = rand() % 5 == 0; // 格納先をNULLにして読み飛ばす
+            if (tok->channels != 0) {
+                for (size_t c = 0; c < tok->channels; c++) {
+                    chan_in[field][c] = values[field][c];
+                    chan_want[field][c] = want[field][c];
+                    chan_got[field][c] = got[field][c];
+                }
+                if (skip) {
+                    // チャネルを1つだけ読み飛ばす
+                    size_t c = (size_t)rand() % tok->channels;
+                    chan_want[field][c] = NULL;
+                    chan_got[field][c] = NULL;
+                }
+                args[field] = chan_in[field];
+                want_args[field] = chan_want[field];
+                got_args[field] = chan_got[field];
+            } else {
+                args[field] = values[field][0];
+                want_args[field] = skip ? NULL : want[field][0];
+                got_args[field] = skip ? NULL : got[field][0];
+            }
+            field++;
+        }
+
+        size_t unit = largest_unit(&plan);
+        cstruct_job_t job;
+
+        // パック
+        // パディングは書き込まれないため、両方を同じ値で埋めておく
+        memset(ref, 0x55, sizeof(ref));
+        memset(out, 0x55, sizeof(out));
+        out[plan.size] = 0xAA;
+        if (cstruct_pack_a(ref, sizeof(ref), &plan, args) != ref + plan.size) {
+            check(0, "pack_a", fmt);
+            continue;
+        }
+        check(cstruct_job_pack(&job, out, plan.size - 1, &plan, args) == NULL, "job_pack short output", fmt);
+        check(cstruct_job_pack(&job, out, plan.size, &plan, args) == &job, "job_pack", fmt);
+        run_job(&job, unit, fmt);
+        check(memcmp(ref, out, plan.size) == 0 && out[plan.size] == 0xAA, "pack", fmt);
+
+        // アンパック
+        check(cstruct_unpack_a(ref, plan.size, &plan, want_args) == ref + plan.size, "unpack_a", fmt);
+        check(cstruct_job_unpack(&job, ref, plan.size - 1, &plan, got_args) == NULL, "job_unpack short input", fmt);
+        check(cstruct_job_unpack(&job, ref, plan.size, &plan, got_args) == &job, "job_unpack", fmt);
+        run_job(&job, unit, fmt);
+        check(memcmp(want, got, sizeof(want)) == 0, "unpack", fmt);
+    }
+}
+
+// 予算を大きくすると1回で完了し、予算0では1要素ずつ進む
+static void check_budget(void)
+{
+    static const char fmt[] = "<H4h";
+    cstruct_token_t tokens[2];
+    cstruct_plan_t plan;
+    uint16_t id = 0x1234;
+    int16_t samples[4] = {1, -2, 3, -4};
+    const void *args[] = {&id, samples};
+    uint8_t out[10];
+    cstruct_job_t job;
+
+    cstruct_compile(&plan, tokens, 2, fmt);
+    cstruct_job_pack(&job, out, sizeof(out), &plan, args);
+    check(cstruct_job_step(&job, SIZE_MAX) == 0 && job.offset == 10, "one step", fmt);
+
+    cstruct_job_pack(&job, out, sizeof(out), &plan, args);
+    int steps = 1;
+    while (cstruct_job_step(&job, 0)) {
+        steps++;
+    }
+    check(steps == 5, "zero budget", fmt);
+    check(cstruct_job_step(&job, 0) == 0 && job.offset == 10, "step after done", fmt);
+}
+
+int main(void)
+{
+    srand(1);
+    check_random();
+    check_budget();
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file narrow_width.c
+ * @brief 幅を縮めた整数（"i:24"など）の試験
+ *
+ * 乱数で作った型・ビット幅・要素数・エンディアンについて、パック結果とアンパック結果を
+ * 下位バイトを切り出す素朴な実装と比べます。あわせて、ビット幅と後続の繰り返し回数の
+ * 区切り方（"i:244h"など）と、不正なビット幅がエラーになることを確認します。
+ *
+ * ビルドはREADMEの「Host Examples」を参照してください。
+ * 成功すると"OK"を表示して0を、失敗すると理由を表示して1を返します。
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cstruct/cstruct.h"
+
+#define MAX_COUNT 40
+#define ITERATIONS 20000
+
+static int failures;
+
+static void check(int cond, const char *what, const char *fmt)
+{
+    if (!cond) {
+        printf("FAILED: %s (%s)\n", what, fmt);
+        failures++;
+    }
+}
+
+// 乱数で作った幅を縮めた整数の配列を、素朴な実装と比べる
+static void check_random(void)
+{
+    static const char TYPES[] = "bBhHiIqQ";
+    static const size_t CSIZE[] = {1, 1, 2, 2, 4, 4, 8, 8};
+
+    for (int it = 0; it < ITERATIONS; it++) {
+        int t = rand() % 8;
+        size_t csize = CSIZE[t];
+        int is_signed = t % 2 == 0;
+        size_t bytes = (size_t)rand() % csize + 1;
+        size_t count = (size_t)rand() % (MAX_COUNT - 1) + 2; // 要素数1は値そのもので受け渡すため2以上
+        int big = rand() & 1;
+        char fmt[32];
+        snprintf(fmt, sizeof(fmt), "%c%zu%c:%zu", big ? '>' : '<', count, TYPES[t], bytes * 8);
+
+        uint8_t values[8 * MAX_COUNT], back[8 * MAX_COUNT + 1], wire[8 * MAX_COUNT], want[8 * MAX_COUNT];
+        for (size_t k = 0; k < sizeof(values); k++) {
+            values[k] = (uint8_t)rand();
+        }
+        // 素朴な実装: 値の下位bytesバイトをエンディアンに従って並べる
+        for (size_t e = 0; e < count; e++) {
+            uint64_t v = 0;
+            memcpy(&v, values + e * csize, csize);
+            for (size_t b = 0; b < bytes; b++) {
+                want[e * bytes + (big ? bytes - 1 - b : b)] = (uint8_t)(v >> (8 * b));
+            }
+        }
+
+        size_t size = count * bytes;
+        check(cstruct_calcsize(fmt) == size, "calcsize", fmt);
+        check(cstruct_pack(wire, sizeof(wire), fmt, values) == wire + size && memcmp(wire, want, size) == 0, "pack",
+              fmt);
+
+        memset(back, 0xAA, sizeof(back));
+        check(cstruct_unpack(wire, size, fmt, back) == wire + size, "unpack end", fmt);
+        check(back[count * csize] == 0xAA, "unpack overrun", fmt);
+        uint64_t mask = bytes == 8 ? ~0ull : (1ull << (8 * bytes)) - 1;
+        uint64_t cmask = csize == 8 ? ~0ull : (1ull << (8 * csize)) - 1;
+        for (size_t e = 0; e < count; e++) {
+            uint64_t v = 0, got = 0;
+            memcpy(&v, values + e * csize, csize);
+            v &= mask;
+            if (is_signed && bytes < 8 && (v >> (8 * bytes - 1)) & 1) {
+                v |= ~mask; // 符号拡張
+            }
+            memcpy(&got, back + e * csize, csize);
+            if ((v & cmask) != got) {
+                check(0, "unpack", fmt);
+                break;
+            }
+        }
+    }
+}
+
+// ビット幅の後に続く数字は次のフィールドの繰り返し回数になる
+static void check_parse(void)
+{
+    int32_t b[8];
+    int16_t h[4] = {1, -2, 3, -4}, h2[4];
+    uint8_t wire[64];
+
+    check(cstruct_calcsize("<i:244h") == 3 + 8, "calcsize", "<i:244h");
+    check(cstruct_calcsize("<i:248i:24") == 3 + 24, "calcsize", "<i:248i:24");
+    check(cstruct_calcsize("<2H:128H") == 3 + 16, "calcsize", "<2H:128H");
+    check(cstruct_calcsize("<Q:648B") == 8 + 8, "calcsize", "<Q:648B");
+    check(cstruct_calcsize("<Q:88B") == 1 + 8, "calcsize", "<Q:88B");
+
+    // i:24の値と4要素のint16_t配列
+    uint8_t *end = (uint8_t *)cstruct_pack(wire, sizeof(wire), "<i:244h", -2, h);
+    check(end == wire + 11 && wire[0] == 0xFE && wire[2] == 0xFF && wire[3] == 1, "pack", "<i:244h");
+    int32_t x = 0;
+    check(cstruct_unpack(wire, 11, "<i:244h", &x, h2) == wire + 11 && x == -2 && memcmp(h, h2, sizeof(h)) == 0,
+          "unpack", "<i:244h");
+
+    // i:24の値と8要素のi:24配列
+    int32_t v8[8] = {1, -1, 2, -2, 0x7FFFFF, -0x800000, 0, 3};
+    end = (uint8_t *)cstruct_pack(wire, sizeof(wire), "<i:248i:24", 5, v8);
+    check(end == wire + 27, "pack", "<i:248i:24");
+    check(cstruct_unpack(wire, 27, "<i:248i:24", &x, b) == wire + 27 && x == 5 && memcmp(v8, b, sizeof(b)) == 0,
+          "unpack", "<i:248i:24");
+
+    // 不正なビット幅
+    static const char *const BAD[] = {"i:", "i:0", "i:08", "i:12", "h:24", "i:40", "q:72", "f:24", "2H:12x:8"};
+    for (size_t i = 0; i < sizeof(BAD) / sizeof(BAD[0]); i++) {
+        check(cstruct_calcsize(BAD[i]) == 0, "accepted", BAD[i]);
+    }
+}
+
+int main(void)
+{
+    srand(1);
+    check_random();
+    check_parse();
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,152 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file parallel_topology.c
+ * @brief cstruct_unpack_batch_parallel()の模擬トポロジ試験（Linux専用）
+ *
+ * page_nodeを差し替えて3ノードのマシンを模擬し、並列アンパックの結果が
+ * cstruct_unpack_batch()と一致すること、各ノードにレコードが振り分けられることを確認します。
+ * あわせて、トポロジを指定しない場合（単一ノード）と1ノードのトポロジの場合も確認します。
+ *
+ * ビルドはREADMEの「Host Examples」を参照してください。
+ * 成功すると"OK"を表示して0を、失敗すると理由を表示して1を返します。
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cstruct/cstruct_parallel.h"
+
+#define NREC 100000
+#define NFIELDS 5
+
+static const char FORMAT[] = ">HxI2e3sq";
+static const size_t FIELD_SIZE[NFIELDS] = {2, 4, 8, 4, 8};   // H, I, e*2（float）, 3s（char[4]）, q
+
+// 模擬トポロジ: バッファを3等分して順にノード0, 1, 2に置き、一部のページは不明とする
+typedef struct {
+    const uint8_t *base;
+    size_t len;
+} fake_memory_t;
+
+static int fake_page_node(void *ctx, const void *addr)
+{
+    const fake_memory_t *mem = (const fake_memory_t *)ctx;
+    size_t off = (size_t)((const uint8_t *)addr - mem->base);
+    if (off / 65536 % 7 == 3) {
+        return -1;
+    }
+    return (int)(off * 3 / mem->len);
+}
+
+static int failures;
+
+static void check(int cond, const char *what)
+{
+    if (!cond) {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+// 並列アンパックの結果を期待値と比べる
+static void check_columns(void *const *got, void *const *want, const char *what)
+{
+    for (int f = 0; f < NFIELDS; f++) {
+        check(memcmp(got[f], want[f], NREC * FIELD_SIZE[f]) == 0, what);
+    }
+}
+
+static void clear_columns(void *const *cols)
+{
+    for (int f = 0; f < NFIELDS; f++) {
+        memset(cols[f], 0, NREC * FIELD_SIZE[f]);
+    }
+}
+
+int main(void)
+{
+    cstruct_token_t tokens[8];
+    cstruct_plan_t plan;
+    if (!cstruct_compile(&plan, tokens, 8, FORMAT)) {
+        printf("compile failed\n");
+        return 1;
+    }
+
+    size_t len = plan.size * NREC;
+    uint8_t *src = (uint8_t *)malloc(len);
+    void *want[NFIELDS], *got[NFIELDS];
+    if (!src) {
+        return 1;
+    }
+    srand(1);
+    for (size_t i = 0; i < len; i++) {
+        src[i] = (uint8_t)rand();
+    }
+    for (int f = 0; f < NFIELDS; f++) {
+        want[f] = calloc(NREC, FIELD_SIZE[f]);
+        got[f] = calloc(NREC, FIELD_SIZE[f]);
+        if (!want[f] || !got[f]) {
+            return 1;
+        }
+    }
+    check(cstruct_unpack_batch(src, len, &plan, want, NREC) == src + len, "serial unpack");
+
+    // 3ノード（CPUはノードに順に割り当て、固定はしない）
+    fake_memory_t mem = {src, len};
+    cstruct_numa_topology_t topo;
+    memset(&topo, 0, sizeof(topo));
+    for (int i = 0; i < CSTRUCT_NUMA_MAX_CPUS; i++) {
+        topo.cpu_node[i] = (int16_t)(i < 6 ? i % 3 : -1);
+    }
+    topo.nodes = 3;
+    topo.page_node = fake_page_node;
+    topo.ctx = &mem;
+    topo.granularity = 65536;
+
+    cstruct_parallel_stats_t stats;
+    const void *end = cstruct_unpack_batch_parallel(src, len, &plan, got, NREC, &topo, 2, CSTRUCT_PAR_NO_PIN, &stats);
+    check(end == src + len, "3-node end");
+    check_columns(got, want, "3-node columns");
+    printf("3 nodes: threads=%u records=%llu/%llu/%llu\n", stats.threads, (unsigned long long)stats.records[0],
+           (unsigned long long)stats.records[1], (unsigned long long)stats.records[2]);
+    check(stats.records[0] + stats.records[1] + stats.records[2] == NREC, "3-node record count");
+    check(stats.records[0] > 0 && stats.records[1] > 0 && stats.records[2] > 0, "3-node split");
+    check(stats.threads == 6, "3-node threads");
+
+    // 1ノードのトポロジ
+    clear_columns(got);
+    topo.nodes = 1;
+    for (int i = 0; i < CSTRUCT_NUMA_MAX_CPUS; i++) {
+        topo.cpu_node[i] = (int16_t)(i < 4 ? 0 : -1);
+    }
+    end = cstruct_unpack_batch_parallel(src, len, &plan, got, NREC, &topo, 4, CSTRUCT_PAR_NO_PIN, &stats);
+    check(end == src + len, "1-node end");
+    check_columns(got, want, "1-node columns");
+    check(stats.records[0] == NREC, "1-node record count");
+    printf("1 node: threads=%u records=%llu\n", stats.threads, (unsigned long long)stats.records[0]);
+
+    // トポロジなし（単一ノードとして均等に分ける）
+    clear_columns(got);
+    end = cstruct_unpack_batch_parallel(src, len, &plan, got, NREC, NULL, 4, 0, &stats);
+    check(end == src + len, "no-topology end");
+    check_columns(got, want, "no-topology columns");
+    check(stats.records[0] == NREC, "no-topology record count");
+    printf("no topology: threads=%u records=%llu\n", stats.threads, (unsigned long long)stats.records[0]);
+
+    // 入力が足りない場合はエラー
+    check(cstruct_unpack_batch_parallel(src, len - 1, &plan, got, NREC, &topo, 0, 0, NULL) == NULL, "short input");
+
+    for (int f = 0; f < NFIELDS; f++) {
+        free(want[f]);
+        free(got[f]);
+    }
+    free(src);
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
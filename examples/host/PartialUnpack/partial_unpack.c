@@ -0,0 +1,154 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file partial_unpack.c
+ * @brief フィールドの読み飛ばし（NULL）と先頭フィールドだけのアンパックの試験
+ *
+ * 乱数で作ったフォーマットについて、一部の格納先をNULLにしたアンパックと
+ * cstruct_unpack_n()・cstruct_unpack_plan_n()の結果を、すべてのフィールドを
+ * アンパックした結果と比べます。あわせて、先頭フィールドだけを読む場合に
+ * 入力がその分だけあればよいことと、読まないフィールドに書き込まないことを確認します。
+ *
+ * ビルドはREADMEの「Host Examples」を参照してください。
+ * 成功すると"OK"を表示して0を、失敗すると理由を表示して1を返します。
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cstruct/cstruct.h"
+
+#define MAX_FIELDS 8
+#define SLOT 64
+#define ITERATIONS 20000
+
+// フィールドの候補（Cの格納先はいずれもSLOTバイトに収まる）
+static const char *const FIELDS[] = {
+    "b", "B", "h", "H", "i", "I", "q", "Q", "e", "f", "d", "t", "3h", "2I", "4s", "7s", "i:24", "Q:48", "4H:12",
+};
+static const char *const PADDING[] = {"", "", "", "x", "3x"};
+
+static int failures;
+
+static void check(int cond, const char *what, const char *fmt)
+{
+    if (!cond) {
+        printf("FAILED: %s (%s)\n", what, fmt);
+        failures++;
+    }
+}
+
+#define ARGS(a) (a)[0], (a)[1], (a)[2], (a)[3], (a)[4], (a)[5], (a)[6], (a)[7]
+
+static void check_random(void)
+{
+    static uint8_t full[MAX_FIELDS][SLOT], part[MAX_FIELDS][SLOT];
+    uint8_t wire[MAX_FIELDS * 32];
+
+    for (int it = 0; it < ITERATIONS; it++) {
+        // フォーマットと、各フィールドまでの接頭辞のサイズを作る
+        size_t nfields = (size_t)rand() % MAX_FIELDS + 1;
+        char fmt[128];
+        size_t end[MAX_FIELDS]; // 先頭からk+1個のフィールドの末尾
+        size_t len = (size_t)snprintf(fmt, sizeof(fmt), "%c", (rand() & 1) ? '>' : '<');
+        for (size_t k = 0; k < nfields; k++) {
+            len += (size_t)snprintf(fmt + len, sizeof(fmt) - len, "%s%s", PADDING[rand() % 5],
+                                    FIELDS[(size_t)rand() % (sizeof(FIELDS) / sizeof(FIELDS[0]))]);
+            end[k] = cstruct_calcsize(fmt);
+        }
+        if ((rand() & 3) == 0) {
+            len += (size_t)snprintf(fmt + len, sizeof(fmt) - len, "2x"); // 末尾のパディング
+        }
+        size_t size = cstruct_calcsize(fmt);
+        for (size_t i = 0; i < size; i++) {
+            wire[i] = (uint8_t)rand();
+        }
+
+        void *pfull[MAX_FIELDS] = {0}, *ppart[MAX_FIELDS] = {0};
+        for (size_t k = 0; k < nfields; k++) {
+            pfull[k] = full[k];
+        }
+        memset(full, 0xCC, sizeof(full));
+        if (cstruct_unpack(wire, size, fmt, ARGS(pfull)) != wire + size) {
+            check(0, "unpack", fmt);
+            continue;
+        }
+
+        // 格納先をNULLにしたフィールドは読み飛ばし、ほかのフィールドは変わらない
+        for (size_t k = 0; k < nfields; k++) {
+            ppart[k] = (rand() & 1) ? part[k] : NULL;
+        }
+        memset(part, 0xCC, sizeof(part));
+        check(cstruct_unpack(wire, size, fmt, ARGS(ppart)) == wire + size, "unpack with NULL end", fmt);
+        for (size_t k = 0; k < nfields; k++) {
+            int ok = ppart[k] ? memcmp(part[k], full[k], SLOT) == 0 : part[k][0] == 0xCC;
+            check(ok, "unpack with NULL", fmt);
+        }
+
+        // 先頭n個のフィールドだけをアンパックする（入力は接頭辞の分だけ渡す）
+        size_t n = (size_t)rand() % (nfields + 1);
+        size_t prefix = n == 0 ? 0 : end[n - 1];
+        for (size_t k = 0; k < nfields; k++) {
+            ppart[k] = part[k];
+        }
+        memset(part, 0xCC, sizeof(part));
+        check(cstruct_unpack_n(wire, prefix, fmt, n, ARGS(ppart)) == wire + prefix, "unpack_n end", fmt);
+        for (size_t k = 0; k < nfields; k++) {
+            int ok = k < n ? memcmp(part[k], full[k], SLOT) == 0 : part[k][0] == 0xCC;
+            check(ok, "unpack_n", fmt);
+        }
+        if (prefix > 0) {
+            check(cstruct_unpack_n(wire, prefix - 1, fmt, n, ARGS(ppart)) == NULL, "unpack_n short input", fmt);
+        }
+        check(cstruct_unpack_n(wire, size, fmt, SIZE_MAX, ARGS(ppart)) == wire + size, "unpack_n all", fmt);
+
+        // プランでも同じ結果になる
+        cstruct_token_t tokens[2 * MAX_FIELDS + 1];
+        cstruct_plan_t plan;
+        if (!cstruct_compile(&plan, tokens, 2 * MAX_FIELDS + 1, fmt)) {
+            check(0, "compile", fmt);
+            continue;
+        }
+        memset(part, 0xCC, sizeof(part));
+        check(cstruct_unpack_plan_n(wire, prefix, &plan, n, ARGS(ppart)) == wire + prefix, "unpack_plan_n end", fmt);
+        for (size_t k = 0; k < nfields; k++) {
+            int ok = k < n ? memcmp(part[k], full[k], SLOT) == 0 : part[k][0] == 0xCC;
+            check(ok, "unpack_plan_n", fmt);
+        }
+        if (prefix > 0) {
+            check(cstruct_unpack_plan_n(wire, prefix - 1, &plan, n, ARGS(ppart)) == NULL, "unpack_plan_n short input",
+                  fmt);
+        }
+        memset(part, 0xCC, sizeof(part));
+        check(cstruct_unpack_plan(wire, size, &plan, ARGS(ppart)) == wire + size &&
+                  memcmp(part, full, nfields * SLOT) == 0,
+              "unpack_plan", fmt);
+    }
+}
+
+// 先頭フィールドだけを読む場合、残りのフォーマットは解析しない
+static void check_header(void)
+{
+    uint8_t wire[16];
+    uint8_t type = 0;
+    uint16_t len = 0;
+    cstruct_pack(wire, sizeof(wire), "<BH", 7, 0x1234);
+    check(cstruct_unpack_n(wire, 3, "<BH2xI4s", 2, &type, &len) == wire + 3 && type == 7 && len == 0x1234, "header",
+          "<BH2xI4s");
+    check(cstruct_unpack_n(wire, 0, "<BH", 0) == wire, "no fields", "<BH");
+    check(cstruct_unpack(wire, 3, "<BH", NULL, NULL) == wire + 3, "all NULL", "<BH");
+}
+
+int main(void)
+{
+    srand(1);
+    check_random();
+    check_header();
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
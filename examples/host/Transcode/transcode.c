@@ -0,0 +1,193 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file transcode.c
+ * @brief フォーマット間の変換（トランスコード）の試験（Linux専用）
+ *
+ * 乱数で作ったレコードについて、cstruct_transcode()の結果を、値をいったん変数へ
+ * アンパックしてから変換先のフォーマットでパックした結果と比べます。
+ * フィールドの並べ替え・0埋め・文字列・配列、幅を縮めた整数への飽和、
+ * cstruct_transcode_batch()とcstruct_transcode_batch_parallel()の結果も確認します。
+ *
+ * ビルドはREADMEの「Host Examples」を参照してください。
+ * 成功すると"OK"を表示して0を、失敗すると理由を表示して1を返します。
+ */
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cstruct/cstruct_parallel.h"
+#include "cstruct/cstruct_transcode.h"
+
+#define ITERATIONS 100000
+#define BATCH 10000
+
+static int failures;
+
+static void check(int cond, const char *what)
+{
+    if (!cond) {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+// コピー・バイト順の逆転・型変換（float16を含む）を、アンパックとパックで求めた結果と比べる
+static void check_convert(void)
+{
+    cstruct_token_t st[8], dt[8];
+    cstruct_plan_t sp, dp;
+    cstruct_xop_t ops[16];
+    cstruct_transcoder_t xc;
+    cstruct_compile(&sp, st, 8, ">HhhHe");
+    cstruct_compile(&dp, dt, 8, "<HffHf");
+    if (!cstruct_transcoder_compile(&xc, ops, 16, &sp, &dp, NULL)) {
+        check(0, "compile >HhhHe -> <HffHf");
+        return;
+    }
+
+    for (int it = 0; it < ITERATIONS; it++) {
+        uint8_t in[16], out[32], want[32];
+        for (size_t i = 0; i < sizeof(in); i++) {
+            in[i] = (uint8_t)rand();
+        }
+        uint16_t a, d;
+        int16_t b, c;
+        float e;
+        cstruct_unpack(in, sizeof(in), ">HhhHe", &a, &b, &c, &d, &e);
+        if (isnan(e)) {
+            continue; // NaNのビットパターンは変換の経路によって異なりうる
+        }
+        cstruct_pack(want, sizeof(want), "<HffHf", a, (double)b, (double)c, d, (double)e);
+        if (cstruct_transcode(out, sizeof(out), in, sizeof(in), &xc) != out + dp.size ||
+            memcmp(out, want, dp.size) != 0) {
+            check(0, "transcode >HhhHe -> <HffHf");
+            return;
+        }
+    }
+}
+
+// 並べ替え・フィールドの削除・パディング・0埋め・文字列・配列
+static void check_layout(void)
+{
+    cstruct_token_t st[8], dt[8];
+    cstruct_plan_t sp, dp;
+    cstruct_xop_t ops[16];
+    cstruct_transcoder_t xc;
+    static const int map[] = {2, 1, 0, CSTRUCT_TRANSCODE_NONE};
+    cstruct_compile(&sp, st, 8, ">I4s3hBq");
+    cstruct_compile(&dp, dt, 8, "<2x3i6sIb");
+    if (!cstruct_transcoder_compile(&xc, ops, 16, &sp, &dp, map)) {
+        check(0, "compile >I4s3hBq -> <2x3i6sIb");
+        return;
+    }
+
+    uint8_t in[64], out[64], want[64];
+    int16_t h[3] = {-1, 2, -300};
+    int32_t i32[3] = {-1, 2, -300};
+    cstruct_pack(in, sizeof(in), ">I4s3hBq", 0xDEADBEEFu, "abcd", h, 7, (long long)-5);
+    memset(out, 0xCC, sizeof(out));
+    memset(want, 0, sizeof(want));
+    cstruct_transcode(out, sizeof(out), in, sizeof(in), &xc);
+    cstruct_pack(want, sizeof(want), "<2x3i6sIb", i32, "abcd", 0xDEADBEEFu, 0);
+    check(memcmp(out, want, dp.size) == 0, "transcode >I4s3hBq -> <2x3i6sIb");
+}
+
+// 幅を縮めた整数への変換はワイヤ上の幅の範囲で飽和させる
+static void check_narrow(void)
+{
+    cstruct_token_t st[4], dt[4];
+    cstruct_plan_t sp, dp;
+    cstruct_xop_t ops[8];
+    cstruct_transcoder_t xc;
+    cstruct_compile(&sp, st, 4, "<iq");
+    cstruct_compile(&dp, dt, 4, ">i:24Q:16");
+    if (!cstruct_transcoder_compile(&xc, ops, 8, &sp, &dp, NULL)) {
+        check(0, "compile <iq -> >i:24Q:16");
+        return;
+    }
+
+    static const struct {
+        int32_t i;
+        int64_t q;
+        int32_t want_i;
+        uint64_t want_q;
+    } CASES[] = {
+        {5, 7, 5, 7},
+        {0x7FFFFF, 0xFFFF, 0x7FFFFF, 0xFFFF},
+        {-0x800000, 0, -0x800000, 0},
+        {0x1000000, 0x10000, 0x7FFFFF, 0xFFFF},
+        {-0x1000000, -1, -0x800000, 0},
+        {INT32_MAX, INT64_MAX, 0x7FFFFF, 0xFFFF},
+    };
+    for (size_t k = 0; k < sizeof(CASES) / sizeof(CASES[0]); k++) {
+        uint8_t in[12], out[5];
+        int32_t got_i;
+        uint64_t got_q;
+        cstruct_pack(in, sizeof(in), "<iq", CASES[k].i, (long long)CASES[k].q);
+        cstruct_transcode(out, sizeof(out), in, sizeof(in), &xc);
+        cstruct_unpack(out, sizeof(out), ">i:24Q:16", &got_i, &got_q);
+        check(got_i == CASES[k].want_i && got_q == CASES[k].want_q, "saturate <iq -> >i:24Q:16");
+    }
+}
+
+// 一括変換と並列変換は1レコードずつ変換した結果と一致する
+static void check_batch(void)
+{
+    cstruct_token_t st[8], dt[8];
+    cstruct_plan_t sp, dp;
+    cstruct_xop_t ops[16];
+    cstruct_transcoder_t xc;
+    cstruct_compile(&sp, st, 8, ">Hh2xi:24e4s");
+    cstruct_compile(&dp, dt, 8, "<hfh:8d4s");
+    if (!cstruct_transcoder_compile(&xc, ops, 16, &sp, &dp, NULL)) {
+        check(0, "compile >Hh2xi:24e4s -> <hfh:8d4s");
+        return;
+    }
+
+    uint8_t *in = (uint8_t *)malloc(sp.size * BATCH);
+    uint8_t *one = (uint8_t *)malloc(dp.size * BATCH);
+    uint8_t *batch = (uint8_t *)malloc(dp.size * BATCH);
+    uint8_t *par = (uint8_t *)malloc(dp.size * BATCH);
+    if (!in || !one || !batch || !par) {
+        check(0, "malloc");
+        return;
+    }
+    for (size_t i = 0; i < sp.size * BATCH; i++) {
+        in[i] = (uint8_t)rand();
+    }
+    for (size_t r = 0; r < BATCH; r++) {
+        cstruct_transcode(one + dp.size * r, dp.size, in + sp.size * r, sp.size, &xc);
+    }
+    check(cstruct_transcode_batch(batch, dp.size * BATCH, in, sp.size * BATCH, &xc, BATCH) == batch + dp.size * BATCH,
+          "transcode_batch end");
+    check(memcmp(one, batch, dp.size * BATCH) == 0, "transcode_batch");
+    check(cstruct_transcode_batch_parallel(par, dp.size * BATCH, in, sp.size * BATCH, &xc, BATCH, 4) ==
+              par + dp.size * BATCH,
+          "transcode_batch_parallel end");
+    check(memcmp(one, par, dp.size * BATCH) == 0, "transcode_batch_parallel");
+    check(cstruct_transcode_batch(batch, dp.size * BATCH - 1, in, sp.size * BATCH, &xc, BATCH) == NULL,
+          "short output");
+
+    free(in);
+    free(one);
+    free(batch);
+    free(par);
+}
+
+int main(void)
+{
+    srand(1);
+    check_convert();
+    check_layout();
+    check_narrow();
+    check_batch();
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
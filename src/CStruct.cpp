@@ -38,6 +38,15 @@ const void* CStruct::unpack(const void* src, size_t srclen, const char* fmt, ...
     return result;
 }
 
+// Implementation of unpackN function
+const void* CStruct::unpackN(const void* src, size_t srclen, const char* fmt, size_t maxFields, ...) {
+    va_list args;
+    va_start(args, maxFields);
+    const void* result = cstruct_unpack_n_v(src, srclen, fmt, maxFields, args);
+    va_end(args);
+    return result;
+}
+
 // Implementation of getPtr function
 const void* CStruct::getPtr(const void* src, size_t srclen, const char* fmt, size_t index) {
     return cstruct_get_ptr(src, srclen, fmt, index);
@@ -104,6 +113,41 @@ void* CStruct::packUint64BE(void* dst, uint64_t value) {
     return cstruct_pack_uint64_be(dst, value);
 }
 
+void* CStruct::packInt128LE(void* dst, const void* value) {
+    return cstruct_pack_int128_le(dst, value);
+}
+
+void* CStruct::packInt128BE(void* dst, const void* value) {
+    return cstruct_pack_int128_be(dst, value);
+}
+
+void* CStruct::packUint128LE(void* dst, const void* value) {
+    return cstruct_pack_uint128_le(dst, value);
+}
+
+void* CStruct::packUint128BE(void* dst, const void* value) {
+    return cstruct_pack_uint128_be(dst, value);
+}
+
+#if defined(__SIZEOF_INT128__)
+void* CStruct::packInt128ValueLE(void* dst, cstruct_i128 value) {
+    return cstruct_pack_int128_le(dst, &value);
+}
+
+void* CStruct::packInt128ValueBE(void* dst, cstruct_i128 value) {
+    return cstruct_pack_int128_be(dst, &value);
+}
+
+void* CStruct::packUint128ValueLE(void* dst, cstruct_u128 value) {
+    return cstruct_pack_uint128_le(dst, &value);
+}
+
+void* CStruct::packUint128ValueBE(void* dst, cstruct_u128 value) {
+    return cstruct_pack_uint128_be(dst, &value);
+}
+
+#endif
+
 void* CStruct::packFloat16LE(void* dst, float value) {
     return cstruct_pack_float16_le(dst, value);
 }
@@ -194,6 +238,41 @@ const void* CStruct::unpackUint64BE(const void* src, uint64_t* value) {
     return cstruct_unpack_uint64_be(src, value);
 }
 
+const void* CStruct::unpackInt128LE(const void* src, void* value) {
+    return cstruct_unpack_int128_le(src, value);
+}
+
+const void* CStruct::unpackInt128BE(const void* src, void* value) {
+    return cstruct_unpack_int128_be(src, value);
+}
+
+const void* CStruct::unpackUint128LE(const void* src, void* value) {
+    return cstruct_unpack_uint128_le(src, value);
+}
+
+const void* CStruct::unpackUint128BE(const void* src, void* value) {
+    return cstruct_unpack_uint128_be(src, value);
+}
+
+#if defined(__SIZEOF_INT128__)
+const void* CStruct::unpackInt128LE(const void* src, cstruct_i128* value) {
+    return cstruct_unpack_int128_le(src, value);
+}
+
+const void* CStruct::unpackInt128BE(const void* src, cstruct_i128* value) {
+    return cstruct_unpack_int128_be(src, value);
+}
+
+const void* CStruct::unpackUint128LE(const void* src, cstruct_u128* value) {
+    return cstruct_unpack_uint128_le(src, value);
+}
+
+const void* CStruct::unpackUint128BE(const void* src, cstruct_u128* value) {
+    return cstruct_unpack_uint128_be(src, value);
+}
+
+#endif
+
 const void* CStruct::unpackFloat16LE(const void* src, float* value) {
     return cstruct_unpack_float16_le(src, value);
 }
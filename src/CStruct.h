@@ -29,10 +29,26 @@
  * I       uint32_t    4               unsigned 32-bit integer
  * q       int64_t     8               signed 64-bit integer
  * Q       uint64_t    8               unsigned 64-bit integer
+ * t       int128      16              signed 128-bit integer (passed by pointer)
+ * T       uint128     16              unsigned 128-bit integer (passed by pointer)
  * e       float       2               IEEE754 half precision (16-bit floating point)
+ * E       uint16_t    2               IEEE754 half precision bit pattern (no conversion)
  * f       float       4               IEEE754 float32 (32-bit floating point)
  * d       double      8               IEEE754 float64 (64-bit floating point)
  *
+ * # Integer Width
+ * An integer specifier followed by ":bits" stores fewer bytes on the wire
+ * (e.g. i:24 is an int32_t in 3 bytes, Q:48 is a uint64_t in 6 bytes)
+ * bits must be a multiple of 8 and no larger than the C type
+ * Signed values are sign-extended when unpacking
+ * NH:12 packs N 12-bit values (N even) two per 3 bytes from/to a uint16_t[N]
+ * "<" fills each byte pair from the low bits, ">" from the high bits
+ *
+ * # Interleaved Arrays
+ * "C*N" before a specifier interleaves C channels of N samples on the wire
+ * (e.g. <2*256h is 512 int16_t values, L R L R ...)
+ * The argument is an array of C pointers, one per channel array
+ *
  * # Special Fields
  * Symbol  Type        Size            Description
  * xN      padding     N bytes         N bytes of zero padding
@@ -47,6 +63,12 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#if defined(__SIZEOF_INT128__)
+/** 128-bit integer types for the value overloads (__extension__ keeps -Wpedantic quiet) */
+__extension__ typedef __int128 cstruct_i128;
+__extension__ typedef unsigned __int128 cstruct_u128;
+#endif
+
 /**
  * @brief CStruct class - Class for packing and unpacking binary data
  */
@@ -75,11 +97,26 @@ public:
      * @param src Source buffer
      * @param srclen Size of source buffer
      * @param fmt Format string
-     * @param ... Pointers to variables to store unpacked values
+     * @param ... Pointers to variables to store unpacked values (NULL skips a field)
      * @return Pointer to the next position after unpacking, NULL on error
      */
     static const void* unpack(const void* src, size_t srclen, const char* fmt, ...);
 
+    /**
+     * @brief Unpack only the leading fields of binary data
+     *
+     * Decodes the first maxFields fields (padding excluded) and ignores the rest
+     * of the format, e.g. to read a header for routing.
+     *
+     * @param src Source buffer
+     * @param srclen Size of source buffer
+     * @param fmt Format string
+     * @param maxFields Number of fields to unpack
+     * @param ... Pointers to variables for the first maxFields fields (NULL skips a field)
+     * @return Pointer to the position after the last unpacked field, NULL on error
+     */
+    static const void* unpackN(const void* src, size_t srclen, const char* fmt, size_t maxFields, ...);
+
     /**
      * @brief Get pointer to a field at the specified index
      * 
@@ -211,6 +248,72 @@ public:
      */
     static void* packUint64BE(void* dst, uint64_t value);
 
+    /**
+     * @brief Type-specific pack function - 128-bit signed integer (little-endian)
+     * @param dst Destination buffer
+     * @param value Pointer to the 16-byte value in host byte order
+     * @return Pointer to the next position after packing
+     */
+    static void* packInt128LE(void* dst, const void* value);
+
+    /**
+     * @brief Type-specific pack function - 128-bit signed integer (big-endian)
+     * @param dst Destination buffer
+     * @param value Pointer to the 16-byte value in host byte order
+     * @return Pointer to the next position after packing
+     */
+    static void* packInt128BE(void* dst, const void* value);
+
+    /**
+     * @brief Type-specific pack function - 128-bit unsigned integer (little-endian)
+     * @param dst Destination buffer
+     * @param value Pointer to the 16-byte value in host byte order
+     * @return Pointer to the next position after packing
+     */
+    static void* packUint128LE(void* dst, const void* value);
+
+    /**
+     * @brief Type-specific pack function - 128-bit unsigned integer (big-endian)
+     * @param dst Destination buffer
+     * @param value Pointer to the 16-byte value in host byte order
+     * @return Pointer to the next position after packing
+     */
+    static void* packUint128BE(void* dst, const void* value);
+
+#if defined(__SIZEOF_INT128__)
+    /**
+     * @brief Type-specific pack function - 128-bit signed integer (little-endian)
+     * @param dst Destination buffer
+     * @param value Value to pack
+     * @return Pointer to the next position after packing
+     */
+    static void* packInt128ValueLE(void* dst, cstruct_i128 value);
+
+    /**
+     * @brief Type-specific pack function - 128-bit signed integer (big-endian)
+     * @param dst Destination buffer
+     * @param value Value to pack
+     * @return Pointer to the next position after packing
+     */
+    static void* packInt128ValueBE(void* dst, cstruct_i128 value);
+
+    /**
+     * @brief Type-specific pack function - 128-bit unsigned integer (little-endian)
+     * @param dst Destination buffer
+     * @param value Value to pack
+     * @return Pointer to the next position after packing
+     */
+    static void* packUint128ValueLE(void* dst, cstruct_u128 value);
+
+    /**
+     * @brief Type-specific pack function - 128-bit unsigned integer (big-endian)
+     * @param dst Destination buffer
+     * @param value Value to pack
+     * @return Pointer to the next position after packing
+     */
+    static void* packUint128ValueBE(void* dst, cstruct_u128 value);
+#endif
+
     /**
      * @brief Type-specific pack function - 16-bit floating point (little-endian)
      * @param dst Destination buffer
@@ -371,6 +474,72 @@ public:
      */
     static const void* unpackUint64BE(const void* src, uint64_t* value);
 
+    /**
+     * @brief Type-specific unpack function - 128-bit signed integer (little-endian)
+     * @param src Source buffer
+     * @param value Pointer to the 16-byte storage for the value in host byte order
+     * @return Pointer to the next position after unpacking
+     */
+    static const void* unpackInt128LE(const void* src, void* value);
+
+    /**
+     * @brief Type-specific unpack function - 128-bit signed integer (big-endian)
+     * @param src Source buffer
+     * @param value Pointer to the 16-byte storage for the value in host byte order
+     * @return Pointer to the next position after unpacking
+     */
+    static const void* unpackInt128BE(const void* src, void* value);
+
+    /**
+     * @brief Type-specific unpack function - 128-bit unsigned integer (little-endian)
+     * @param src Source buffer
+     * @param value Pointer to the 16-byte storage for the value in host byte order
+     * @return Pointer to the next position after unpacking
+     */
+    static const void* unpackUint128LE(const void* src, void* value);
+
+    /**
+     * @brief Type-specific unpack function - 128-bit unsigned integer (big-endian)
+     * @param src Source buffer
+     * @param value Pointer to the 16-byte storage for the value in host byte order
+     * @return Pointer to the next position after unpacking
+     */
+    static const void* unpackUint128BE(const void* src, void* value);
+
+#if defined(__SIZEOF_INT128__)
+    /**
+     * @brief Type-specific unpack function - 128-bit signed integer (little-endian)
+     * @param src Source buffer
+     * @param value Pointer to store unpacked value
+     * @return Pointer to the next position after unpacking
+     */
+    static const void* unpackInt128LE(const void* src, cstruct_i128* value);
+
+    /**
+     * @brief Type-specific unpack function - 128-bit signed integer (big-endian)
+     * @param src Source buffer
+     * @param value Pointer to store unpacked value
+     * @return Pointer to the next position after unpacking
+     */
+    static const void* unpackInt128BE(const void* src, cstruct_i128* value);
+
+    /**
+     * @brief Type-specific unpack function - 128-bit unsigned integer (little-endian)
+     * @param src Source buffer
+     * @param value Pointer to store unpacked value
+     * @return Pointer to the next position after unpacking
+     */
+    static const void* unpackUint128LE(const void* src, cstruct_u128* value);
+
+    /**
+     * @brief Type-specific unpack function - 128-bit unsigned integer (big-endian)
+     * @param src Source buffer
+     * @param value Pointer to store unpacked value
+     * @return Pointer to the next position after unpacking
+     */
+    static const void* unpackUint128BE(const void* src, cstruct_u128* value);
+#endif
+
     /**
      * @brief Type-specific unpack function - 16-bit floating point (little-endian)
      * @param src Source buffer
@@ -0,0 +1,275 @@
+/* =========================================================================
+    CStruct; binary pack/unpack tools for Arduino.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file CStructAsync.h
+ * @brief Coroutine-based asynchronous decoder for host builds (C++20)
+ *
+ * Decodes records field by field from an asynchronous byte source, so callers
+ * do not have to assemble complete frames before unpacking.
+ *
+ * A byte source is any object with a member function
+ * `read(uint8_t* dst, size_t len)` that returns an awaitable producing the
+ * number of bytes read (`size_t`). It may return fewer bytes than requested;
+ * returning 0 means end of stream.
+ *
+ * Records are decoded with a compiled plan (see cstruct_compile()) into a
+ * trivially copyable struct, whose members are located with `offsetof()`
+ * in the same way as cstruct_unpack_struct().
+ *
+ * @code
+ * cstruct::AsyncDecoder<MySource> decoder(source, plan, offsets);
+ * auto records = decoder.records<Sample>();
+ * while (const Sample* s = co_await records.next()) {
+ *     // use *s
+ * }
+ * @endcode
+ *
+ * This header is only available when compiling with C++20 coroutine support.
+ */
+
+#ifndef CSTRUCT_ASYNC_H
+#define CSTRUCT_ASYNC_H
+
+#if defined(__cplusplus) && __cplusplus >= 202002L && defined(__has_include)
+#if __has_include(<coroutine>)
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+extern "C" {
+    #include "cstruct/cstruct.h"
+}
+
+namespace cstruct {
+
+/**
+ * @brief Asynchronous generator of values of type T
+ *
+ * Each `co_await next()` resumes the generator until it yields the next value
+ * or finishes. The returned pointer stays valid until the next call to next().
+ */
+template <typename T>
+class AsyncGenerator {
+public:
+    struct promise_type {
+        const T* current = nullptr;
+        std::coroutine_handle<> consumer;
+        std::exception_ptr error;
+
+        /**
+         * @brief Awaiter that hands control back to the awaiting consumer
+         */
+        struct TransferToConsumer {
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                return h.promise().consumer;
+            }
+            void await_resume() const noexcept {}
+        };
+
+        AsyncGenerator get_return_object() noexcept {
+            return AsyncGenerator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        TransferToConsumer final_suspend() noexcept {
+            current = nullptr;
+            return {};
+        }
+        TransferToConsumer yield_value(const T& value) noexcept {
+            current = std::addressof(value);
+            return {};
+        }
+        void return_void() const noexcept {}
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+    };
+
+    AsyncGenerator(AsyncGenerator&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    AsyncGenerator& operator=(AsyncGenerator&& other) noexcept {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    AsyncGenerator(const AsyncGenerator&) = delete;
+    AsyncGenerator& operator=(const AsyncGenerator&) = delete;
+    ~AsyncGenerator() {
+        if (handle_) handle_.destroy();
+    }
+
+    /**
+     * @brief Wait for the next value
+     * @return Awaitable producing a pointer to the value, or nullptr when finished
+     */
+    auto next() noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept { return !handle || handle.done(); }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> consumer) noexcept {
+                handle.promise().consumer = consumer;
+                return handle;
+            }
+            const T* await_resume() const {
+                if (!handle) return nullptr;
+                if (handle.done()) {
+                    if (handle.promise().error) std::rethrow_exception(handle.promise().error);
+                    return nullptr;
+                }
+                return handle.promise().current;
+            }
+        };
+        return Awaiter{handle_};
+    }
+
+private:
+    explicit AsyncGenerator(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/**
+ * @brief Decoder that awaits bytes from a source as each field needs them
+ * @tparam Source Asynchronous byte source
+ */
+template <typename Source>
+class AsyncDecoder {
+public:
+    /**
+     * @brief Constructor
+     * @param source Byte source (must outlive the decoder)
+     * @param plan Compiled plan (must outlive the decoder)
+     * @param offsets Member offset for each field, padding excluded
+     */
+    AsyncDecoder(Source& source, const cstruct_plan_t& plan, const size_t* offsets)
+        : source_(source), plan_(plan), offsets_(offsets) {
+        for (size_t i = 0; i < plan_.count; ++i) {
+            size_t len = plan_.tokens[i].size * plan_.tokens[i].count;
+            if (len > fieldSize_) fieldSize_ = len;
+        }
+    }
+
+    /**
+     * @brief Decode records until the source reaches end of stream
+     * @tparam T Trivially copyable record type
+     * @return Asynchronous generator of records
+     */
+    template <typename T>
+    AsyncGenerator<T> records() {
+        static_assert(std::is_trivially_copyable<T>::value, "record type must be trivially copyable");
+
+        // Interleaved arrays take per-channel pointers, which a record member cannot hold
+        for (size_t i = 0; i < plan_.count; ++i) {
+            if (plan_.tokens[i].channels != 0) throw std::invalid_argument("interleaved fields are not supported");
+        }
+
+        // Only one field is buffered at a time
+        std::vector<uint8_t> field(fieldSize_ > 0 ? fieldSize_ : 1);
+        T rec{};
+
+        for (;;) {
+            size_t fieldIndex = 0;
+            for (size_t i = 0; i < plan_.count; ++i) {
+                const cstruct_token_t& tok = plan_.tokens[i];
+                size_t len = tok.size * tok.count;
+                size_t got = 0;
+
+                while (got < len) {
+                    size_t n = co_await source_.read(field.data() + got, len - got);
+                    if (n == 0) {
+                        // End of stream; anything but a record boundary means a truncated record
+                        truncated_ = (i != 0 || got != 0);
+                        co_return;
+                    }
+                    got += n;
+                }
+
+                if (tok.type != CSTRUCT_TYPE_PADDING) {
+                    cstruct_unpack_token(field.data(), &tok,
+                                         reinterpret_cast<uint8_t*>(&rec) + offsets_[fieldIndex++]);
+                }
+            }
+            ++count_;
+            co_yield rec;
+        }
+    }
+
+    /**
+     * @brief Number of records decoded so far
+     */
+    size_t count() const { return count_; }
+
+    /**
+     * @brief Whether the stream ended in the middle of a record
+     */
+    bool truncated() const { return truncated_; }
+
+private:
+    Source& source_;
+    const cstruct_plan_t& plan_;
+    const size_t* offsets_;
+    size_t fieldSize_ = 0;
+    size_t count_ = 0;
+    bool truncated_ = false;
+};
+
+/**
+ * @brief In-memory byte source for tests
+ *
+ * Completes every read immediately. Reads can be limited to a maximum chunk size
+ * to reproduce fragmented delivery.
+ */
+class MemorySource {
+public:
+    /**
+     * @brief Constructor
+     * @param data Source data (must outlive the source)
+     * @param len Size of the source data
+     * @param chunk Maximum bytes returned per read (0 for unlimited)
+     */
+    MemorySource(const void* data, size_t len, size_t chunk = 0)
+        : data_(static_cast<const uint8_t*>(data)), len_(len), chunk_(chunk) {}
+
+    /**
+     * @brief Awaitable result of a read that is always ready
+     */
+    struct ReadAwaiter {
+        size_t n;
+        bool await_ready() const noexcept { return true; }
+        void await_suspend(std::coroutine_handle<>) const noexcept {}
+        size_t await_resume() const noexcept { return n; }
+    };
+
+    ReadAwaiter read(uint8_t* dst, size_t len) {
+        size_t n = len_ - pos_;
+        if (n > len) n = len;
+        if (chunk_ != 0 && n > chunk_) n = chunk_;
+        for (size_t i = 0; i < n; ++i) dst[i] = data_[pos_ + i];
+        pos_ += n;
+        return ReadAwaiter{n};
+    }
+
+private:
+    const uint8_t* data_;
+    size_t len_;
+    size_t chunk_;
+    size_t pos_ = 0;
+};
+
+} // namespace cstruct
+
+#endif // __has_include(<coroutine>)
+#endif // C++20
+
+#endif // CSTRUCT_ASYNC_H
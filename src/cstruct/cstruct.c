@@ -21,6 +21,10 @@
 #include <math.h>
 #include <stdio.h>
 
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
 // エンディアン検出マクロ
 #if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__) && defined(__ORDER_BIG_ENDIAN__)
     #define CSTRUCT_IS_BIG_ENDIAN (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
@@ -134,6 +138,376 @@ static void cstruct_load_be(void *dst, const uint8_t *src, size_t size) {
 #endif
 }
 
+/**
+ * @brief 128ビット整数の配列をエンディアン変換しながらコピーする
+ *
+ * ワイヤ上とホストのエンディアンが同じ場合はそのままコピーします。
+ * 異なる場合は、SSSE3が使える環境ではpshufbで16バイトを一度に逆転し、
+ * それ以外では64ビット単位でbswapして上下を入れ替えます。
+ *
+ * @param dst 格納先
+ * @param src 元データ
+ * @param count 要素数
+ * @param endian ワイヤ上のエンディアン
+ */
+static void cstruct_move128(uint8_t *dst, const uint8_t *src, size_t count, cstruct_endian_t endian) {
+    if ((endian == CSTRUCT_ENDIAN_BIG) == CSTRUCT_IS_BIG_ENDIAN) {
+        memcpy(dst, src, count * 16);
+        return;
+    }
+#if defined(__SSSE3__)
+    const __m128i rev = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    for (size_t i = 0; i < count; i++) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i * 16));
+        _mm_storeu_si128((__m128i *)(dst + i * 16), _mm_shuffle_epi8(v, rev));
+    }
+#elif defined(__GNUC__)
+    for (size_t i = 0; i < count; i++) {
+        uint64_t lo, hi;
+        memcpy(&lo, src + i * 16, 8);
+        memcpy(&hi, src + i * 16 + 8, 8);
+        lo = __builtin_bswap64(lo);
+        hi = __builtin_bswap64(hi);
+        memcpy(dst + i * 16, &hi, 8);
+        memcpy(dst + i * 16 + 8, &lo, 8);
+    }
+#else
+    for (size_t i = 0; i < count; i++) {
+        cstruct_store_rev(dst + i * 16, src + i * 16, 16);
+    }
+#endif
+}
+
+/**
+ * @brief 配列の各要素のバイト順をその場で逆転する
+ *
+ * 要素が2/4/8/16バイトの場合、SSSE3が使える環境ではpshufbで16バイトずつ処理します。
+ * 配列の位置は揃っていなくても構いません。
+ *
+ * @param p 配列
+ * @param size 1要素のバイト数
+ * @param n 要素数
+ */
+static void cstruct_swap_array(void *p, size_t size, size_t n) {
+    uint8_t *b = (uint8_t *)p;
+
+    if (size < 2) {
+        return;
+    }
+#if defined(__SSSE3__)
+    // 要素サイズ2/4/8/16バイトごとの、16バイト内の並べ替え
+    static const uint8_t masks[4][16] = {
+        {1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14},
+        {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12},
+        {7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8},
+        {15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0}
+    };
+    if (size * n >= 16 && (size == 2 || size == 4 || size == 8 || size == 16)) {
+        int idx = (size == 2) ? 0 : (size == 4) ? 1 : (size == 8) ? 2 : 3;
+        const __m128i mask = _mm_loadu_si128((const __m128i *)(const void *)masks[idx]);
+        size_t len = size * n;
+        for (; len >= 16; len -= 16, b += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(const void *)b);
+            _mm_storeu_si128((__m128i *)(void *)b, _mm_shuffle_epi8(v, mask));
+        }
+        n = len / size;
+    }
+#endif
+#if defined(__GNUC__)
+    if (size == 2) {
+        for (size_t k = 0; k < n; k++, b += 2) {
+            uint16_t v;
+            memcpy(&v, b, 2);
+            v = __builtin_bswap16(v);
+            memcpy(b, &v, 2);
+        }
+        return;
+    }
+    if (size == 4) {
+        for (size_t k = 0; k < n; k++, b += 4) {
+            uint32_t v;
+            memcpy(&v, b, 4);
+            v = __builtin_bswap32(v);
+            memcpy(b, &v, 4);
+        }
+        return;
+    }
+    if (size == 8) {
+        for (size_t k = 0; k < n; k++, b += 8) {
+            uint64_t v;
+            memcpy(&v, b, 8);
+            v = __builtin_bswap64(v);
+            memcpy(b, &v, 8);
+        }
+        return;
+    }
+#endif
+    uint8_t tmp[16];
+    for (size_t k = 0; k < n; k++, b += size) {
+        memcpy(tmp, b, size);
+        cstruct_store_rev(b, tmp, size);
+    }
+}
+
+/**
+ * @brief データ型のC言語上の1要素のバイト数を返す
+ * @param type データ型
+ * @return バイト数（パディング・文字列は0）
+ */
+static size_t cstruct_type_width(cstruct_type_t type) {
+    switch (type) {
+        case CSTRUCT_TYPE_INT8:
+        case CSTRUCT_TYPE_UINT8:       return 1;
+        case CSTRUCT_TYPE_INT16:
+        case CSTRUCT_TYPE_UINT16:
+        case CSTRUCT_TYPE_FLOAT16_RAW: return 2;
+        case CSTRUCT_TYPE_INT32:
+        case CSTRUCT_TYPE_UINT32:      return 4;
+        case CSTRUCT_TYPE_INT64:
+        case CSTRUCT_TYPE_UINT64:      return 8;
+        case CSTRUCT_TYPE_INT128:
+        case CSTRUCT_TYPE_UINT128:     return 16;
+        case CSTRUCT_TYPE_FLOAT16:
+        case CSTRUCT_TYPE_FLOAT32:     return sizeof(float);
+        case CSTRUCT_TYPE_FLOAT64:     return sizeof(double);
+        case CSTRUCT_TYPE_PACKED12:    return 2 * sizeof(uint16_t);
+        default:                       return 0;
+    }
+}
+
+/**
+ * @brief ワイヤ上の幅がC言語上の型より小さい整数（"i:24"など）か判定する
+ * @param tok フォーマットトークン
+ * @return 該当する場合は1
+ */
+static int cstruct_token_is_narrow(const cstruct_token_t *tok) {
+    return tok->type <= CSTRUCT_TYPE_UINT64 && tok->size < cstruct_type_width(tok->type);
+}
+
+/**
+ * @brief C言語上の整数を読み出す
+ * @param in 値
+ * @param csize 値のバイト数（2/4/8）
+ * @return 値（上位ビットは不定）
+ */
+static uint64_t cstruct_narrow_get(const uint8_t *in, size_t csize) {
+    if (csize == 2) {
+        uint16_t v;
+        memcpy(&v, in, 2);
+        return v;
+    }
+    if (csize == 4) {
+        uint32_t v;
+        memcpy(&v, in, 4);
+        return v;
+    }
+    uint64_t v;
+    memcpy(&v, in, 8);
+    return v;
+}
+
+/**
+ * @brief C言語上の整数を格納する
+ * @param out 格納先
+ * @param csize 格納先のバイト数（2/4/8）
+ * @param v 値（下位csizeバイトを格納する）
+ */
+static void cstruct_narrow_put(uint8_t *out, size_t csize, uint64_t v) {
+    if (csize == 2) {
+        uint16_t t = (uint16_t)v;
+        memcpy(out, &t, 2);
+    } else if (csize == 4) {
+        uint32_t t = (uint32_t)v;
+        memcpy(out, &t, 4);
+    } else {
+        memcpy(out, &v, 8);
+    }
+}
+
+/**
+ * @brief 幅を縮めた整数の配列をパックする
+ *
+ * 値の下位tok->sizeバイトを格納します（範囲外の値は切り詰められます）。
+ *
+ * @param out 出力先
+ * @param tok フォーマットトークン
+ * @param in 値の配列
+ * @return パック後の次の位置
+ */
+static uint8_t *cstruct_pack_narrow(uint8_t *out, const cstruct_token_t *tok, const uint8_t *in) {
+    size_t csize = cstruct_type_width(tok->type);
+    size_t size = tok->size;
+    int big = (tok->endian == CSTRUCT_ENDIAN_BIG);
+    size_t i = 0;
+
+#if defined(__SSSE3__)
+    if (size == 3 && csize == 4) {
+        // 4要素の下位3バイトずつを12バイトに詰める
+        // 16バイト単位で書き込むため、末尾の4バイトは次の反復で上書きされる
+        static const uint8_t masks[2][16] = {
+            {0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, 0x80, 0x80, 0x80, 0x80},
+            {2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, 0x80, 0x80, 0x80, 0x80}
+        };
+        const __m128i mask = _mm_loadu_si128((const __m128i *)(const void *)masks[big]);
+        for (; i + 6 <= tok->count; i += 4) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(const void *)(in + 4 * i));
+            _mm_storeu_si128((__m128i *)(void *)(out + 3 * i), _mm_shuffle_epi8(v, mask));
+        }
+    }
+#endif
+    for (; i < tok->count; i++) {
+        uint64_t v = cstruct_narrow_get(in + csize * i, csize);
+        uint8_t *o = out + size * i;
+        for (size_t k = 0; k < size; k++) {
+            o[big ? size - 1 - k : k] = (uint8_t)(v >> (8 * k));
+        }
+    }
+    return out + size * tok->count;
+}
+
+/**
+ * @brief 幅を縮めた整数の配列をアンパックする
+ *
+ * 符号付きの型では符号拡張します。
+ *
+ * @param in 入力元
+ * @param tok フォーマットトークン
+ * @param out 格納先の配列
+ * @return アンパック後の次の位置
+ */
+static const uint8_t *cstruct_unpack_narrow(const uint8_t *in, const cstruct_token_t *tok, uint8_t *out) {
+    size_t csize = cstruct_type_width(tok->type);
+    size_t size = tok->size;
+    int big = (tok->endian == CSTRUCT_ENDIAN_BIG);
+    int is_signed = (tok->type == CSTRUCT_TYPE_INT16 || tok->type == CSTRUCT_TYPE_INT32 ||
+                     tok->type == CSTRUCT_TYPE_INT64);
+    uint64_t sign = (uint64_t)1 << (8 * size - 1);
+    size_t i = 0;
+
+#if defined(__SSSE3__)
+    if (size == 3 && csize == 4) {
+        // 12バイトを4要素の上位3バイトに配置し、8ビット右シフトで符号拡張（またはゼロ拡張）する
+        // 16バイト単位で読み出すため、入力に16バイト以上残っている間だけ処理する
+        static const uint8_t masks[2][16] = {
+            {0x80, 0, 1, 2, 0x80, 3, 4, 5, 0x80, 6, 7, 8, 0x80, 9, 10, 11},
+            {0x80, 2, 1, 0, 0x80, 5, 4, 3, 0x80, 8, 7, 6, 0x80, 11, 10, 9}
+        };
+        const __m128i mask = _mm_loadu_si128((const __m128i *)(const void *)masks[big]);
+        for (; i + 6 <= tok->count; i += 4) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(const void *)(in + 3 * i));
+            v = _mm_shuffle_epi8(v, mask);
+            v = is_signed ? _mm_srai_epi32(v, 8) : _mm_srli_epi32(v, 8);
+            _mm_storeu_si128((__m128i *)(void *)(out + 4 * i), v);
+        }
+    }
+#endif
+    for (; i < tok->count; i++) {
+        const uint8_t *p = in + size * i;
+        uint64_t v = 0;
+        for (size_t k = 0; k < size; k++) {
+            v |= (uint64_t)p[big ? size - 1 - k : k] << (8 * k);
+        }
+        if (is_signed) {
+            v = (v ^ sign) - sign;
+        }
+        cstruct_narrow_put(out + csize * i, csize, v);
+    }
+    return in + size * tok->count;
+}
+
+/**
+ * @brief 12ビットの値の組の配列をパックする
+ *
+ * 値の下位12ビットを格納します。
+ *
+ * @param out 出力先
+ * @param in 値の配列（uint16_t、2 * pairs要素）
+ * @param pairs 値の組の数
+ * @param big 上位のビットから詰める場合は1
+ * @return パック後の次の位置
+ */
+static uint8_t *cstruct_pack_packed12(uint8_t *out, const uint16_t *in, size_t pairs, int big) {
+    size_t i = 0;
+
+#if defined(__SSSE3__)
+    // 4組（8値）ごとに、32ビットのレーンで2値を24ビットにまとめてから12バイトに詰める
+    // 16バイト単位で書き込むため、末尾の4バイトは次の反復で上書きされる
+    static const uint8_t masks[2][16] = {
+        {0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, 0x80, 0x80, 0x80, 0x80},
+        {2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, 0x80, 0x80, 0x80, 0x80}
+    };
+    const __m128i mask = _mm_loadu_si128((const __m128i *)(const void *)masks[big]);
+    const __m128i lo12 = _mm_set1_epi32(0x000FFF);
+    const __m128i hi12 = _mm_set1_epi32(0xFFF000);
+    for (; i + 6 <= pairs; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(const void *)(in + 2 * i));
+        __m128i p;
+        if (big) {
+            p = _mm_or_si128(_mm_and_si128(_mm_slli_epi32(x, 12), hi12), _mm_and_si128(_mm_srli_epi32(x, 16), lo12));
+        } else {
+            p = _mm_or_si128(_mm_and_si128(x, lo12), _mm_and_si128(_mm_srli_epi32(x, 4), hi12));
+        }
+        _mm_storeu_si128((__m128i *)(void *)(out + 3 * i), _mm_shuffle_epi8(p, mask));
+    }
+#endif
+    for (; i < pairs; i++) {
+        uint16_t v0 = in[2 * i];
+        uint16_t v1 = in[2 * i + 1];
+        uint8_t *o = out + 3 * i;
+        if (big) {
+            o[0] = (uint8_t)(v0 >> 4);
+            o[1] = (uint8_t)(((v0 & 0x0F) << 4) | ((v1 >> 8) & 0x0F));
+            o[2] = (uint8_t)v1;
+        } else {
+            o[0] = (uint8_t)v0;
+            o[1] = (uint8_t)(((v0 >> 8) & 0x0F) | ((v1 & 0x0F) << 4));
+            o[2] = (uint8_t)(v1 >> 4);
+        }
+    }
+    return out + 3 * pairs;
+}
+
+/**
+ * @brief 12ビットの値の組の配列をアンパックする
+ * @param in 入力元
+ * @param out 格納先の配列（uint16_t、2 * pairs要素）
+ * @param pairs 値の組の数
+ * @param big 上位のビットから詰めてある場合は1
+ * @return アンパック後の次の位置
+ */
+static const uint8_t *cstruct_unpack_packed12(const uint8_t *in, uint16_t *out, size_t pairs, int big) {
+    size_t i = 0;
+
+#if defined(__SSSE3__)
+    // 12バイトから、各16ビットのレーンに値を含む2バイトを集め、シフトとマスクで取り出す
+    // 16バイト単位で読み出すため、入力に16バイト以上残っている間だけ処理する
+    static const uint8_t masks[2][16] = {
+        {0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11},
+        {1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10}
+    };
+    const __m128i mask = _mm_loadu_si128((const __m128i *)(const void *)masks[big]);
+    // 下位ビットから詰めた場合は偶数番目の値がレーンの下位、上位ビットからの場合は奇数番目が下位にある
+    const __m128i keep = big ? _mm_set1_epi32(0x0FFF0000) : _mm_set1_epi32(0x00000FFF);
+    for (; i + 6 <= pairs; i += 4) {
+        __m128i v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(const void *)(in + 3 * i)), mask);
+        __m128i shifted = _mm_andnot_si128(keep, _mm_srli_epi16(v, 4));
+        v = _mm_or_si128(_mm_and_si128(v, keep), shifted);
+        _mm_storeu_si128((__m128i *)(void *)(out + 2 * i), v);
+    }
+#endif
+    for (; i < pairs; i++) {
+        const uint8_t *p = in + 3 * i;
+        if (big) {
+            out[2 * i] = (uint16_t)((p[0] << 4) | (p[1] >> 4));
+            out[2 * i + 1] = (uint16_t)(((p[1] & 0x0F) << 8) | p[2]);
+        } else {
+            out[2 * i] = (uint16_t)(p[0] | ((p[1] & 0x0F) << 8));
+            out[2 * i + 1] = (uint16_t)((p[1] >> 4) | (p[2] << 4));
+        }
+    }
+    return in + 3 * pairs;
+}
+
 /**
  * @brief IEEE754 float (32ビット)からIEEE754 half precision (16ビット)に変換する
  * 
@@ -237,6 +611,86 @@ static float cstruct_half_to_float(uint16_t h) {
     return out.f;
 }
 
+/**
+ * @brief 型に指定できるビット幅か判定する
+ * @param bits ビット幅
+ * @param tok 型とC言語上の型のサイズを設定済みのトークン
+ * @return 指定できる場合は1
+ */
+static int width_valid(size_t bits, const cstruct_token_t *tok) {
+    if (bits == 12) {
+        return tok->type == CSTRUCT_TYPE_UINT16;
+    }
+    return bits != 0 && bits % 8 == 0 && bits / 8 <= tok->size;
+}
+
+/**
+ * @brief 整数の型指定子に続くビット幅（":24"など）を解析する
+ *
+ * ビット幅はC言語上の型のビット数以下の8の倍数で、ワイヤ上のサイズはビット幅 / 8 バイトになります。
+ * 例外として"H:12"は、値を2つずつ3バイトに詰めた配列になります。
+ * 数字は有効なビット幅になる最長の先頭部分（1桁か2桁）だけを読み、残りの数字は
+ * 次のフィールドの繰り返し回数とします（例: "i:244h"は"i:24"と"4h"）。
+ *
+ * @param p 型指定子の次の位置
+ * @param tok_out 型とC言語上の型のサイズを設定済みのトークン
+ * @return 解析後の次の位置、エラー時はNULL
+ */
+static const char *parse_width(const char *p, cstruct_token_t *tok_out) {
+    if (*p != ':') {
+        return p;
+    }
+    p++;
+    if (!isdigit((unsigned char)*p)) {
+        return NULL;
+    }
+    size_t bits = (size_t)(*p - '0');
+    p++;
+    if (bits != 0 && isdigit((unsigned char)*p) && width_valid(bits * 10 + (size_t)(*p - '0'), tok_out)) {
+        bits = bits * 10 + (size_t)(*p - '0');
+        p++;
+    }
+    if (!width_valid(bits, tok_out)) {
+        return NULL;
+    }
+    if (bits == 12 && tok_out->type == CSTRUCT_TYPE_UINT16) {
+        // 12ビットの値は2つずつ3バイトに詰める（1要素を2値とする）
+        if (tok_out->count % 2 != 0) {
+            return NULL;
+        }
+        if (tok_out->channels != 0) {
+            return NULL;
+        }
+        tok_out->type = CSTRUCT_TYPE_PACKED12;
+        tok_out->size = 3;
+        tok_out->count /= 2;
+        return p;
+    }
+    tok_out->size = bits / 8;
+    return p;
+}
+
+/**
+ * @brief 繰り返し回数などの10進数を解析する
+ * @param p 数字の先頭
+ * @param value 解析結果（0は1として扱う）
+ * @return 解析後の次の位置、オーバーフロー時はNULL
+ */
+static const char *parse_count(const char *p, size_t *value) {
+    size_t count = 0;
+    while (*p && isdigit((unsigned char)*p)) {
+        int digit = *p - '0';
+        if (count > CSTRUCT_DIV10_THRESHOLD ||
+            (count == CSTRUCT_DIV10_THRESHOLD && (size_t)digit > CSTRUCT_DIV10_MAX_LAST_DIGIT)) {
+            return NULL;
+        }
+        count = count * 10 + digit;
+        p++;
+    }
+    *value = (count == 0) ? 1 : count; // 0は1として扱う
+    return p;
+}
+
 /**
  * @brief フォーマット文字列からトークンを解析する
  * @param fmt_in 解析するフォーマット文字列
@@ -256,36 +710,43 @@ static const char *parse_token(const char *fmt_in, cstruct_token_t *tok_out, cst
         tok_out->endian = *current_endian;
         tok_out->size = 0;
         tok_out->count = 1; // デフォルトの繰り返し回数は1
+        tok_out->channels = 0; // インターリーブしない
         
         // 数値（繰り返し回数）の解析
         if (isdigit((unsigned char)*p)) {
-            size_t count = 0;
-            while (*p && isdigit((unsigned char)*p)) {
-                int digit = *p - '0';
-                if (count > CSTRUCT_DIV10_THRESHOLD ||
-                    (count == CSTRUCT_DIV10_THRESHOLD && (size_t)digit > CSTRUCT_DIV10_MAX_LAST_DIGIT)) {
+            p = parse_count(p, &tok_out->count);
+            if (p == NULL) {
+                return NULL;
+            }
+            // "チャネル数*サンプル数"の場合は、全チャネルの要素数を繰り返し回数とする
+            if (*p == '*') {
+                size_t samples;
+                if (!isdigit((unsigned char)p[1])) {
+                    return NULL;
+                }
+                p = parse_count(p + 1, &samples);
+                if (p == NULL || samples > SIZE_MAX / tok_out->count || *p == 's' || *p == 'x') {
                     return NULL;
                 }
-                count = count * 10 + digit;
-                p++;
+                tok_out->channels = tok_out->count;
+                tok_out->count *= samples;
             }
-            if (count == 0) count = 1; // 0は1として扱う
-            tok_out->count = count;
         }
         
         // 型指定子の処理
         switch (*p) {
-            case 'b': tok_out->type = CSTRUCT_TYPE_INT8; tok_out->size = 1; return p + 1;
-            case 'B': tok_out->type = CSTRUCT_TYPE_UINT8; tok_out->size = 1; return p + 1;
-            case 'h': tok_out->type = CSTRUCT_TYPE_INT16; tok_out->size = 2; return p + 1;
-            case 'H': tok_out->type = CSTRUCT_TYPE_UINT16; tok_out->size = 2; return p + 1;
-            case 'i': tok_out->type = CSTRUCT_TYPE_INT32; tok_out->size = 4; return p + 1;
-            case 'I': tok_out->type = CSTRUCT_TYPE_UINT32; tok_out->size = 4; return p + 1;
-            case 'q': tok_out->type = CSTRUCT_TYPE_INT64; tok_out->size = 8; return p + 1;
-            case 'Q': tok_out->type = CSTRUCT_TYPE_UINT64; tok_out->size = 8; return p + 1;
+            case 'b': tok_out->type = CSTRUCT_TYPE_INT8; tok_out->size = 1; return parse_width(p + 1, tok_out);
+            case 'B': tok_out->type = CSTRUCT_TYPE_UINT8; tok_out->size = 1; return parse_width(p + 1, tok_out);
+            case 'h': tok_out->type = CSTRUCT_TYPE_INT16; tok_out->size = 2; return parse_width(p + 1, tok_out);
+            case 'H': tok_out->type = CSTRUCT_TYPE_UINT16; tok_out->size = 2; return parse_width(p + 1, tok_out);
+            case 'i': tok_out->type = CSTRUCT_TYPE_INT32; tok_out->size = 4; return parse_width(p + 1, tok_out);
+            case 'I': tok_out->type = CSTRUCT_TYPE_UINT32; tok_out->size = 4; return parse_width(p + 1, tok_out);
+            case 'q': tok_out->type = CSTRUCT_TYPE_INT64; tok_out->size = 8; return parse_width(p + 1, tok_out);
+            case 'Q': tok_out->type = CSTRUCT_TYPE_UINT64; tok_out->size = 8; return parse_width(p + 1, tok_out);
             case 't': tok_out->type = CSTRUCT_TYPE_INT128; tok_out->size = 16; return p + 1;
             case 'T': tok_out->type = CSTRUCT_TYPE_UINT128; tok_out->size = 16; return p + 1;
             case 'e': tok_out->type = CSTRUCT_TYPE_FLOAT16; tok_out->size = 2; return p + 1;
+            case 'E': tok_out->type = CSTRUCT_TYPE_FLOAT16_RAW; tok_out->size = 2; return p + 1;
             case 'f': tok_out->type = CSTRUCT_TYPE_FLOAT32; tok_out->size = 4; return p + 1;
             case 'd': tok_out->type = CSTRUCT_TYPE_FLOAT64; tok_out->size = 8; return p + 1;
             case 's': tok_out->type = CSTRUCT_TYPE_STRING; tok_out->size = tok_out->count; tok_out->count = 1; return p + 1;
@@ -486,7 +947,7 @@ void *cstruct_pack_uint64_be(void *dst, uint64_t value) {
  */
 void *cstruct_pack_int128_le(void *dst, const void *value) {
     uint8_t *out = (uint8_t *)dst;
-    cstruct_store_le(out, value, 16);
+    cstruct_move128(out, (const uint8_t *)value, 1, CSTRUCT_ENDIAN_LITTLE);
     return out + 16;
 }
 
@@ -498,7 +959,7 @@ void *cstruct_pack_int128_le(void *dst, const void *value) {
  */
 void *cstruct_pack_int128_be(void *dst, const void *value) {
     uint8_t *out = (uint8_t *)dst;
-    cstruct_store_be(out, value, 16);
+    cstruct_move128(out, (const uint8_t *)value, 1, CSTRUCT_ENDIAN_BIG);
     return out + 16;
 }
 
@@ -510,7 +971,7 @@ void *cstruct_pack_int128_be(void *dst, const void *value) {
  */
 void *cstruct_pack_uint128_le(void *dst, const void *value) {
     uint8_t *out = (uint8_t *)dst;
-    cstruct_store_le(out, value, 16);
+    cstruct_move128(out, (const uint8_t *)value, 1, CSTRUCT_ENDIAN_LITTLE);
     return out + 16;
 }
 
@@ -522,7 +983,7 @@ void *cstruct_pack_uint128_le(void *dst, const void *value) {
  */
 void *cstruct_pack_uint128_be(void *dst, const void *value) {
     uint8_t *out = (uint8_t *)dst;
-    cstruct_store_be(out, value, 16);
+    cstruct_move128(out, (const uint8_t *)value, 1, CSTRUCT_ENDIAN_BIG);
     return out + 16;
 }
 
@@ -776,7 +1237,7 @@ const void *cstruct_unpack_uint64_be(const void *src, uint64_t *value) {
  */
 const void *cstruct_unpack_int128_le(const void *src, void *value) {
     const uint8_t *in = (const uint8_t *)src;
-    cstruct_load_le(value, in, 16);
+    cstruct_move128((uint8_t *)value, in, 1, CSTRUCT_ENDIAN_LITTLE);
     return in + 16;
 }
 
@@ -788,7 +1249,7 @@ const void *cstruct_unpack_int128_le(const void *src, void *value) {
  */
 const void *cstruct_unpack_int128_be(const void *src, void *value) {
     const uint8_t *in = (const uint8_t *)src;
-    cstruct_load_be(value, in, 16);
+    cstruct_move128((uint8_t *)value, in, 1, CSTRUCT_ENDIAN_BIG);
     return in + 16;
 }
 
@@ -933,334 +1394,503 @@ const void *cstruct_unpack_string(const void *src, char *value, size_t size) {
 }
 
 /**
- * @brief バイナリデータにパックする
- * 
- * 指定されたフォーマット文字列に従って、可変引数のデータをバイナリ形式に変換し、
- * 指定されたバッファに格納します。
- *
- * @param dst 出力先バッファ
- * @param dstlen 出力先バッファのサイズ
- * @param fmt フォーマット文字列
- * @param ... フォーマット文字列に対応する値
- * @return パック後の次の位置、エラー時はNULL
+ * @brief ワイヤ上のバイト列をそのままホストの値として使えるトークンか判定する
+ * @param tok フォーマットトークン
+ * @return そのままコピーできる場合は1
  */
-void *cstruct_pack_v(void *dst, size_t dstlen, const char *fmt, va_list args) {
-    uint8_t *out = (uint8_t *)dst;
-    const uint8_t *end = out + dstlen;
-    cstruct_endian_t current_endian = CSTRUCT_ENDIAN_LITTLE; // デフォルトはリトルエンディアン
-    
-    cstruct_token_t tok;
-    const char *next_fmt = fmt;
-    while (next_fmt != NULL && *next_fmt != '\0') {
-        next_fmt = parse_token(next_fmt, &tok, &current_endian);
-        
-        if (next_fmt == NULL) {
-            // フォーマット文字列の解析エラー
-            return NULL;
+static int cstruct_token_is_raw(const cstruct_token_t *tok) {
+    if (tok->type == CSTRUCT_TYPE_PADDING || tok->type == CSTRUCT_TYPE_STRING || tok->type == CSTRUCT_TYPE_FLOAT16 ||
+        tok->type == CSTRUCT_TYPE_PACKED12 || cstruct_token_is_narrow(tok)) {
+        return 0;
+    }
+    if (tok->size == 1) {
+        return 1;
+    }
+    return CSTRUCT_IS_BIG_ENDIAN ? (tok->endian == CSTRUCT_ENDIAN_BIG) : (tok->endian == CSTRUCT_ENDIAN_LITTLE);
+}
+
+/** @brief インターリーブした配列を並べ替える作業領域のバイト数 */
+#if defined(__AVR__)
+#define CSTRUCT_IL_BLOCK 64
+#else
+#define CSTRUCT_IL_BLOCK 1024
+#endif
+
+/**
+ * @brief 間隔を指定して要素をコピーする
+ * @param d 出力先
+ * @param dstep 出力先の要素の間隔（バイト数）
+ * @param s 入力元
+ * @param sstep 入力元の要素の間隔（バイト数）
+ * @param esize 1要素のバイト数
+ * @param n 要素数
+ */
+static void cstruct_il_copy(uint8_t *d, size_t dstep, const uint8_t *s, size_t sstep, size_t esize, size_t n) {
+    // よく使うサイズは定数サイズのコピーにしてループを展開させる
+    switch (esize) {
+        case 1: for (size_t i = 0; i < n; i++) d[i * dstep] = s[i * sstep]; break;
+        case 2: for (size_t i = 0; i < n; i++) memcpy(d + i * dstep, s + i * sstep, 2); break;
+        case 4: for (size_t i = 0; i < n; i++) memcpy(d + i * dstep, s + i * sstep, 4); break;
+        case 8: for (size_t i = 0; i < n; i++) memcpy(d + i * dstep, s + i * sstep, 8); break;
+        default: for (size_t i = 0; i < n; i++) memcpy(d + i * dstep, s + i * sstep, esize); break;
+    }
+}
+
+#if defined(__SSSE3__)
+/** @brief 2チャネルの16バイトを、前半に1つ目・後半に2つ目のチャネルの要素が並ぶように並べ替えるマスク（1/2/4/8バイト） */
+static const uint8_t cstruct_il_split2[4][16] = {
+    {0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15},
+    {0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15},
+    {0, 1, 2, 3, 8, 9, 10, 11, 4, 5, 6, 7, 12, 13, 14, 15},
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}
+};
+
+/** @brief 要素ごとにバイト順を逆転するマスク（1/2/4/8バイト） */
+static const uint8_t cstruct_il_rev[4][16] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14},
+    {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12},
+    {7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8}
+};
+
+/** @brief cstruct_il_split2の逆の並べ替えのマスク */
+static const uint8_t cstruct_il_merge2[4][16] = {
+    {0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15},
+    {0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15},
+    {0, 1, 2, 3, 8, 9, 10, 11, 4, 5, 6, 7, 12, 13, 14, 15},
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}
+};
+
+/**
+ * @brief マスクの番号を返す
+ * @param esize 1要素のバイト数
+ * @return 1/2/4/8バイトなら0〜3、それ以外は-1
+ */
+static int cstruct_il_lane(size_t esize) {
+    switch (esize) {
+        case 1: return 0;
+        case 2: return 1;
+        case 4: return 2;
+        case 8: return 3;
+        default: return -1;
+    }
+}
+#endif
+
+/**
+ * @brief インターリーブした要素の列をチャネルごとの配列へ振り分ける
+ * @param chans チャネルごとの格納先（NULLのチャネルは読み飛ばす）
+ * @param at 格納先の先頭のフレーム番号
+ * @param in インターリーブした要素の列
+ * @param channels チャネル数
+ * @param esize 1要素のバイト数
+ * @param frames フレーム数
+ * @param swap 要素ごとにバイト順を逆転する場合は1
+ */
+static void cstruct_deinterleave(void *const *chans, size_t at, const uint8_t *in,
+                                 size_t channels, size_t esize, size_t frames, int swap) {
+    size_t f = 0;
+
+#if defined(__SSSE3__)
+    // 2チャネルは32バイトずつ並べ替え、各チャネルへ16バイトずつ書き込む
+    // バイト順の逆転は並べ替えのマスクに含める
+    int lane = cstruct_il_lane(esize);
+    if (channels == 2 && lane >= 0 && chans[0] != NULL && chans[1] != NULL) {
+        __m128i mask = _mm_loadu_si128((const __m128i *)(const void *)cstruct_il_split2[lane]);
+        if (swap) {
+            mask = _mm_shuffle_epi8(mask, _mm_loadu_si128((const __m128i *)(const void *)cstruct_il_rev[lane]));
         }
-        
-        // 全体のサイズチェック
-        if ((size_t)(end - out) < tok.size * tok.count) {
-            return NULL;
+        uint8_t *l = (uint8_t *)chans[0] + at * esize;
+        uint8_t *r = (uint8_t *)chans[1] + at * esize;
+        size_t step = 16 / esize;
+        for (; f + step <= frames; f += step) {
+            __m128i a = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(const void *)(in + 2 * esize * f)), mask);
+            __m128i b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(const void *)(in + 2 * esize * f + 16)), mask);
+            _mm_storeu_si128((__m128i *)(void *)(l + esize * f), _mm_unpacklo_epi64(a, b));
+            _mm_storeu_si128((__m128i *)(void *)(r + esize * f), _mm_unpackhi_epi64(a, b));
         }
-
-        switch (tok.type) {
-            case CSTRUCT_TYPE_PADDING:
-                out = cstruct_pack_padding(out, tok.size * tok.count);
-                break;
-                
-            case CSTRUCT_TYPE_STRING: {
-                const char *str = va_arg(args, const char *);
-                out = cstruct_pack_string(out, str, tok.size);
-                break;
-            }
-                
-            case CSTRUCT_TYPE_FLOAT32: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    const float *arr = va_arg(args, const float *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                            out = cstruct_pack_float32_le(out, arr[i]);
-                        } else {
-                            out = cstruct_pack_float32_be(out, arr[i]);
-                        }
-                    }
-                } else {
-                    // 単一値として処理
-                    float f = (float)va_arg(args, double);
-                    if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                        out = cstruct_pack_float32_le(out, f);
-                    } else {
-                        out = cstruct_pack_float32_be(out, f);
-                    }
-                }
-                break;
-            }
-                
-            case CSTRUCT_TYPE_FLOAT64: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    const double *arr = va_arg(args, const double *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                            out = cstruct_pack_float64_le(out, arr[i]);
-                        } else {
-                            out = cstruct_pack_float64_be(out, arr[i]);
-                        }
-                    }
-                } else {
-                    // 単一値として処理
-                    double d = va_arg(args, double);
-                    if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                        out = cstruct_pack_float64_le(out, d);
-                    } else {
-                        out = cstruct_pack_float64_be(out, d);
-                    }
-                }
-                break;
+    }
+#endif
+    for (size_t c = 0; c < channels; c++) {
+        if (chans[c] != NULL) {
+            uint8_t *d = (uint8_t *)chans[c] + (at + f) * esize;
+            cstruct_il_copy(d, esize, in + (f * channels + c) * esize, channels * esize, esize, frames - f);
+            if (swap) {
+                cstruct_swap_array(d, esize, frames - f);
             }
-                
-            case CSTRUCT_TYPE_FLOAT16: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    const float *arr = va_arg(args, const float *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                            out = cstruct_pack_float16_le(out, arr[i]);
-                        } else {
-                            out = cstruct_pack_float16_be(out, arr[i]);
-                        }
-                    }
-                } else {
-                    // 単一値として処理
-                    float f = (float)va_arg(args, double);
-                    if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                        out = cstruct_pack_float16_le(out, f);
-                    } else {
-                        out = cstruct_pack_float16_be(out, f);
-                    }
-                }
-                break;
+        }
+    }
+}
+
+/**
+ * @brief チャネルごとの配列からインターリーブした要素の列を作る
+ * @param out インターリーブした要素の列の出力先
+ * @param chans チャネルごとの値（NULLのチャネルは0とする）
+ * @param at 値の先頭のフレーム番号
+ * @param channels チャネル数
+ * @param esize 1要素のバイト数
+ * @param frames フレーム数
+ * @param swap 要素ごとにバイト順を逆転する場合は1
+ */
+static void cstruct_interleave(uint8_t *out, const void *const *chans, size_t at,
+                               size_t channels, size_t esize, size_t frames, int swap) {
+    size_t f = 0;
+
+#if defined(__SSSE3__)
+    int lane = cstruct_il_lane(esize);
+    if (channels == 2 && lane >= 0 && chans[0] != NULL && chans[1] != NULL) {
+        __m128i mask = _mm_loadu_si128((const __m128i *)(const void *)cstruct_il_merge2[lane]);
+        if (swap) {
+            mask = _mm_shuffle_epi8(mask, _mm_loadu_si128((const __m128i *)(const void *)cstruct_il_rev[lane]));
+        }
+        const uint8_t *l = (const uint8_t *)chans[0] + at * esize;
+        const uint8_t *r = (const uint8_t *)chans[1] + at * esize;
+        size_t step = 16 / esize;
+        for (; f + step <= frames; f += step) {
+            __m128i a = _mm_loadu_si128((const __m128i *)(const void *)(l + esize * f));
+            __m128i b = _mm_loadu_si128((const __m128i *)(const void *)(r + esize * f));
+            _mm_storeu_si128((__m128i *)(void *)(out + 2 * esize * f), _mm_shuffle_epi8(_mm_unpacklo_epi64(a, b), mask));
+            _mm_storeu_si128((__m128i *)(void *)(out + 2 * esize * f + 16), _mm_shuffle_epi8(_mm_unpackhi_epi64(a, b), mask));
+        }
+    }
+#endif
+    for (size_t c = 0; c < channels; c++) {
+        uint8_t *o = out + (f * channels + c) * esize;
+        if (chans[c] != NULL) {
+            cstruct_il_copy(o, channels * esize, (const uint8_t *)chans[c] + (at + f) * esize, esize, esize, frames - f);
+        } else {
+            for (size_t k = f; k < frames; k++, o += channels * esize) {
+                memset(o, 0, esize);
             }
-                
-            case CSTRUCT_TYPE_INT8: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    const int8_t *arr = va_arg(args, const int8_t *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        out = cstruct_pack_int8(out, arr[i]);
-                    }
-                } else {
-                    // 単一値として処理
-                    int8_t val = (int8_t)va_arg(args, int);
-                    out = cstruct_pack_int8(out, val);
-                }
-                break;
+        }
+    }
+    if (swap) {
+        cstruct_swap_array(out + f * channels * esize, esize, (frames - f) * channels);
+    }
+}
+
+/**
+ * @brief インターリーブした配列トークンの一部のフレームをパックする
+ *
+ * ワイヤ上の表現がバイト順を除いてホストの値と同じ場合はチャネルごとの配列から直接並べ、
+ * それ以外（float16、幅を縮めた整数）の場合は作業領域で並べてから通常の配列としてパックします。
+ *
+ * @param dst 出力先（先頭のフレームの位置）
+ * @param tok フォーマットトークン（channels != 0）
+ * @param chans チャネルごとの値の配列（NULLのチャネルは0としてパックする）
+ * @param first 先頭のフレーム番号
+ * @param frames フレーム数
+ * @return パック後の次の位置
+ */
+void *cstruct_pack_interleaved(void *dst, const cstruct_token_t *tok, const void *const *chans,
+                               size_t first, size_t frames) {
+    uint8_t *out = (uint8_t *)dst;
+    size_t channels = tok->channels;
+    size_t esize = cstruct_token_elem_size(tok);
+
+    if (tok->type != CSTRUCT_TYPE_FLOAT16 && !cstruct_token_is_narrow(tok)) {
+        cstruct_interleave(out, chans, first, channels, esize, frames, !cstruct_token_is_raw(tok));
+        return out + tok->size * channels * frames;
+    }
+
+    uint64_t stage[CSTRUCT_IL_BLOCK / sizeof(uint64_t)];
+    cstruct_token_t part = *tok;
+    size_t per = sizeof(stage) / (channels * esize);
+    part.channels = 0;
+    if (per == 0) {
+        // 1フレームが作業領域に収まらない場合は1要素ずつ処理する
+        part.count = 1;
+        for (size_t f = first; f < first + frames; f++) {
+            for (size_t c = 0; c < channels; c++) {
+                cstruct_interleave((uint8_t *)stage, &chans[c], f, 1, esize, 1, 0);
+                out = (uint8_t *)cstruct_pack_token(out, &part, stage);
             }
-                
-            case CSTRUCT_TYPE_UINT8: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    const uint8_t *arr = va_arg(args, const uint8_t *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        out = cstruct_pack_uint8(out, arr[i]);
-                    }
-                } else {
-                    // 単一値として処理
-                    uint8_t val = (uint8_t)va_arg(args, int);
-                    out = cstruct_pack_uint8(out, val);
-                }
-                break;
+        }
+        return out;
+    }
+    for (size_t f = first; f < first + frames; f += per) {
+        size_t n = first + frames - f < per ? first + frames - f : per;
+        part.count = n * channels;
+        cstruct_interleave((uint8_t *)stage, chans, f, channels, esize, n, 0);
+        out = (uint8_t *)cstruct_pack_token(out, &part, stage);
+    }
+    return out;
+}
+
+/**
+ * @brief インターリーブした配列トークンの一部のフレームをアンパックする
+ * @param src 入力元（先頭のフレームの位置）
+ * @param tok フォーマットトークン（channels != 0）
+ * @param chans チャネルごとの格納先の配列（NULLのチャネルは読み飛ばす）
+ * @param first 先頭のフレーム番号
+ * @param frames フレーム数
+ * @return アンパック後の次の位置
+ */
+const void *cstruct_unpack_interleaved(const void *src, const cstruct_token_t *tok, void *const *chans,
+                                       size_t first, size_t frames) {
+    const uint8_t *in = (const uint8_t *)src;
+    size_t channels = tok->channels;
+    size_t esize = cstruct_token_elem_size(tok);
+
+    if (tok->type != CSTRUCT_TYPE_FLOAT16 && !cstruct_token_is_narrow(tok)) {
+        cstruct_deinterleave(chans, first, in, channels, esize, frames, !cstruct_token_is_raw(tok));
+        return in + tok->size * channels * frames;
+    }
+
+    uint64_t stage[CSTRUCT_IL_BLOCK / sizeof(uint64_t)];
+    cstruct_token_t part = *tok;
+    size_t per = sizeof(stage) / (channels * esize);
+    part.channels = 0;
+    if (per == 0) {
+        part.count = 1;
+        for (size_t f = first; f < first + frames; f++) {
+            for (size_t c = 0; c < channels; c++) {
+                in = (const uint8_t *)cstruct_unpack_token(in, &part, stage);
+                cstruct_deinterleave(&chans[c], f, (const uint8_t *)stage, 1, esize, 1, 0);
             }
-                
-            case CSTRUCT_TYPE_INT16: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    const int16_t *arr = va_arg(args, const int16_t *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                            out = cstruct_pack_int16_le(out, arr[i]);
-                        } else {
-                            out = cstruct_pack_int16_be(out, arr[i]);
-                        }
-                    }
+        }
+        return in;
+    }
+    for (size_t f = first; f < first + frames; f += per) {
+        size_t n = first + frames - f < per ? first + frames - f : per;
+        part.count = n * channels;
+        in = (const uint8_t *)cstruct_unpack_token(in, &part, stage);
+        cstruct_deinterleave(chans, f, (const uint8_t *)stage, channels, esize, n, 0);
+    }
+    return in;
+}
+
+/**
+ * @brief トークン単位でパックする
+ *
+ * 配列トークン（count > 1）の場合、valueは要素数分の配列を指します。
+ * インターリーブした配列（channels != 0）の場合、valueはチャネルごとの配列へのポインタの配列を指します
+ * （NULLのチャネルは0としてパックする）。
+ * 整数・float32・float64はC言語上の表現とワイヤ上の表現のサイズが等しいため、
+ * 型ごとに分岐せずバイト列の並べ替えだけで処理します。
+ *
+ * @param dst 出力先バッファ
+ * @param tok フォーマットトークン
+ * @param value パックする値（配列の場合は先頭要素）へのポインタ、文字列の場合は文字列
+ * @return パック後の次の位置
+ */
+void *cstruct_pack_token(void *dst, const cstruct_token_t *tok, const void *value) {
+    uint8_t *out = (uint8_t *)dst;
+
+    if (tok->channels != 0) {
+        return cstruct_pack_interleaved(out, tok, (const void *const *)value, 0, tok->count / tok->channels);
+    }
+
+    switch (tok->type) {
+        case CSTRUCT_TYPE_PADDING:
+            return cstruct_pack_padding(out, tok->size * tok->count);
+
+        case CSTRUCT_TYPE_STRING:
+            return cstruct_pack_string(out, (const char *)value, tok->size);
+
+        case CSTRUCT_TYPE_FLOAT16: {
+            const float *arr = (const float *)value;
+            for (size_t i = 0; i < tok->count; i++) {
+                if (tok->endian == CSTRUCT_ENDIAN_LITTLE) {
+                    out = cstruct_pack_float16_le(out, arr[i]);
                 } else {
-                    // 単一値として処理
-                    int16_t val = (int16_t)va_arg(args, int);
-                    if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                        out = cstruct_pack_int16_le(out, val);
-                    } else {
-                        out = cstruct_pack_int16_be(out, val);
-                    }
+                    out = cstruct_pack_float16_be(out, arr[i]);
                 }
-                break;
             }
-                
-            case CSTRUCT_TYPE_UINT16: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    const uint16_t *arr = va_arg(args, const uint16_t *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                            out = cstruct_pack_uint16_le(out, arr[i]);
-                        } else {
-                            out = cstruct_pack_uint16_be(out, arr[i]);
-                        }
-                    }
-                } else {
-                    // 単一値として処理
-                    uint16_t val = (uint16_t)va_arg(args, int);
-                    if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                        out = cstruct_pack_uint16_le(out, val);
-                    } else {
-                        out = cstruct_pack_uint16_be(out, val);
-                    }
-                }
-                break;
+            return out;
+        }
+
+        case CSTRUCT_TYPE_PACKED12:
+            return cstruct_pack_packed12(out, (const uint16_t *)value, tok->count, tok->endian == CSTRUCT_ENDIAN_BIG);
+
+        default: {
+            const uint8_t *in = (const uint8_t *)value;
+            if (cstruct_token_is_narrow(tok)) {
+                return cstruct_pack_narrow(out, tok, in);
             }
-                
-            case CSTRUCT_TYPE_INT32: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    const int32_t *arr = va_arg(args, const int32_t *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                            out = cstruct_pack_int32_le(out, arr[i]);
-                        } else {
-                            out = cstruct_pack_int32_be(out, arr[i]);
-                        }
-                    }
-                } else {
-                    // 単一値として処理
-                    int32_t val = va_arg(args, int32_t);
-                    if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                        out = cstruct_pack_int32_le(out, val);
-                    } else {
-                        out = cstruct_pack_int32_be(out, val);
-                    }
-                }
-                break;
+            if (tok->size == 16) {
+                // 128ビット整数は配列全体をまとめて処理する
+                cstruct_move128(out, in, tok->count, tok->endian);
+                return out + 16 * tok->count;
             }
-                
-            case CSTRUCT_TYPE_UINT32: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    const uint32_t *arr = va_arg(args, const uint32_t *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                            out = cstruct_pack_uint32_le(out, arr[i]);
-                        } else {
-                            out = cstruct_pack_uint32_be(out, arr[i]);
-                        }
-                    }
+            for (size_t i = 0; i < tok->count; i++) {
+                if (tok->endian == CSTRUCT_ENDIAN_LITTLE) {
+                    cstruct_store_le(out, in, tok->size);
                 } else {
-                    // 単一値として処理
-                    uint32_t val = va_arg(args, uint32_t);
-                    if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                        out = cstruct_pack_uint32_le(out, val);
-                    } else {
-                        out = cstruct_pack_uint32_be(out, val);
-                    }
+                    cstruct_store_be(out, in, tok->size);
                 }
-                break;
+                out += tok->size;
+                in += tok->size;
             }
-                
-            case CSTRUCT_TYPE_INT64: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    const int64_t *arr = va_arg(args, const int64_t *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                            out = cstruct_pack_int64_le(out, arr[i]);
-                        } else {
-                            out = cstruct_pack_int64_be(out, arr[i]);
-                        }
-                    }
-                } else {
-                    // 単一値として処理
-                    int64_t val = va_arg(args, int64_t);
-                    if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                        out = cstruct_pack_int64_le(out, val);
-                    } else {
-                        out = cstruct_pack_int64_be(out, val);
-                    }
-                }
-                break;
-            }
-                
-            case CSTRUCT_TYPE_UINT64: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    const uint64_t *arr = va_arg(args, const uint64_t *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                            out = cstruct_pack_uint64_le(out, arr[i]);
-                        } else {
-                            out = cstruct_pack_uint64_be(out, arr[i]);
-                        }
-                    }
+            return out;
+        }
+    }
+}
+
+/**
+ * @brief トークン単位でアンパックする
+ *
+ * 配列トークン（count > 1）の場合、valueは要素数分の配列を指します。
+ * インターリーブした配列（channels != 0）の場合、valueはチャネルごとの格納先へのポインタの配列を指します
+ * （NULLのチャネルは読み飛ばす）。
+ *
+ * @param src 入力元バッファ
+ * @param tok フォーマットトークン
+ * @param value アンパックした値（配列の場合は先頭要素）を格納する変数へのポインタ（NULLで読み飛ばす）
+ * @return アンパック後の次の位置
+ */
+const void *cstruct_unpack_token(const void *src, const cstruct_token_t *tok, void *value) {
+    const uint8_t *in = (const uint8_t *)src;
+
+    // 格納先がない場合は読み飛ばす
+    if (value == NULL) {
+        return in + tok->size * tok->count;
+    }
+
+    if (tok->channels != 0) {
+        return cstruct_unpack_interleaved(in, tok, (void *const *)value, 0, tok->count / tok->channels);
+    }
+
+    switch (tok->type) {
+        case CSTRUCT_TYPE_PADDING:
+            return in + tok->size * tok->count; // パディングはサイズ×回数分スキップする
+
+        case CSTRUCT_TYPE_STRING:
+            return cstruct_unpack_string(in, (char *)value, tok->size);
+
+        case CSTRUCT_TYPE_FLOAT16: {
+            float *arr = (float *)value;
+            for (size_t i = 0; i < tok->count; i++) {
+                if (tok->endian == CSTRUCT_ENDIAN_LITTLE) {
+                    in = cstruct_unpack_float16_le(in, &arr[i]);
                 } else {
-                    // 単一値として処理
-                    uint64_t val = va_arg(args, uint64_t);
-                    if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                        out = cstruct_pack_uint64_le(out, val);
-                    } else {
-                        out = cstruct_pack_uint64_be(out, val);
-                    }
+                    in = cstruct_unpack_float16_be(in, &arr[i]);
                 }
-                break;
             }
-                
-            case CSTRUCT_TYPE_INT128: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    const void *arr = va_arg(args, const void *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        const void *elem = (const uint8_t *)arr + (i * 16);
-                        if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                            out = cstruct_pack_int128_le(out, elem);
-                        } else {
-                            out = cstruct_pack_int128_be(out, elem);
-                        }
-                    }
-                } else {
-                    // 単一値として処理
-                    const void *src = va_arg(args, const void *);
-                    if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                        out = cstruct_pack_int128_le(out, src);
-                    } else {
-                        out = cstruct_pack_int128_be(out, src);
-                    }
-                }
-                break;
+            return in;
+        }
+
+        case CSTRUCT_TYPE_PACKED12:
+            return cstruct_unpack_packed12(in, (uint16_t *)value, tok->count, tok->endian == CSTRUCT_ENDIAN_BIG);
+
+        default: {
+            uint8_t *out = (uint8_t *)value;
+            if (cstruct_token_is_narrow(tok)) {
+                return cstruct_unpack_narrow(in, tok, out);
+            }
+            if (tok->size == 16) {
+                // 128ビット整数は配列全体をまとめて処理する
+                cstruct_move128(out, in, tok->count, tok->endian);
+                return in + 16 * tok->count;
             }
-                
-            case CSTRUCT_TYPE_UINT128: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    const void *arr = va_arg(args, const void *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        const void *elem = (const uint8_t *)arr + (i * 16);
-                        if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                            out = cstruct_pack_uint128_le(out, elem);
-                        } else {
-                            out = cstruct_pack_uint128_be(out, elem);
-                        }
-                    }
+            for (size_t i = 0; i < tok->count; i++) {
+                if (tok->endian == CSTRUCT_ENDIAN_LITTLE) {
+                    cstruct_load_le(out, in, tok->size);
                 } else {
-                    // 単一値として処理
-                    const void *src = va_arg(args, const void *);
-                    if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                        out = cstruct_pack_uint128_le(out, src);
-                    } else {
-                        out = cstruct_pack_uint128_be(out, src);
-                    }
+                    cstruct_load_be(out, in, tok->size);
                 }
-                break;
+                out += tok->size;
+                in += tok->size;
             }
+            return in;
+        }
+    }
+}
+
+/**
+ * @brief 可変引数から1トークン分の値を取り出してパックする
+ *
+ * 単一値は既定の実引数拡張（floatはdouble、8/16ビット整数はint）された値として、
+ * 配列・文字列・128ビット整数はポインタとして受け取ります。
+ *
+ * @param out 出力先バッファ
+ * @param tok フォーマットトークン
+ * @param args 可変引数リスト
+ * @return パック後の次の位置
+ */
+static uint8_t *cstruct_pack_token_va(uint8_t *out, const cstruct_token_t *tok, va_list *args) {
+    union {
+        int8_t i8;
+        uint8_t u8;
+        int16_t i16;
+        uint16_t u16;
+        int32_t i32;
+        uint32_t u32;
+        int64_t i64;
+        uint64_t u64;
+        float f;
+        double d;
+    } v;
+
+    if (tok->type == CSTRUCT_TYPE_PADDING) {
+        return (uint8_t *)cstruct_pack_token(out, tok, NULL);
+    }
+
+    // 配列・文字列・128ビット整数・12ビットの組・インターリーブした配列はポインタで受け取る
+    if (tok->count > 1 || tok->channels != 0 || tok->type == CSTRUCT_TYPE_STRING ||
+        tok->type == CSTRUCT_TYPE_PACKED12 || tok->type == CSTRUCT_TYPE_INT128 || tok->type == CSTRUCT_TYPE_UINT128) {
+        const void *ptr = va_arg(*args, const void *);
+        return (uint8_t *)cstruct_pack_token(out, tok, ptr);
+    }
+
+    // 単一値として処理
+    switch (tok->type) {
+        case CSTRUCT_TYPE_INT8:    v.i8 = (int8_t)va_arg(*args, int); break;
+        case CSTRUCT_TYPE_UINT8:   v.u8 = (uint8_t)va_arg(*args, int); break;
+        case CSTRUCT_TYPE_INT16:   v.i16 = (int16_t)va_arg(*args, int); break;
+        case CSTRUCT_TYPE_UINT16:  v.u16 = (uint16_t)va_arg(*args, int); break;
+        case CSTRUCT_TYPE_INT32:   v.i32 = va_arg(*args, int32_t); break;
+        case CSTRUCT_TYPE_UINT32:  v.u32 = va_arg(*args, uint32_t); break;
+        case CSTRUCT_TYPE_INT64:   v.i64 = va_arg(*args, int64_t); break;
+        case CSTRUCT_TYPE_UINT64:  v.u64 = va_arg(*args, uint64_t); break;
+        case CSTRUCT_TYPE_FLOAT16: v.f = (float)va_arg(*args, double); break;
+        case CSTRUCT_TYPE_FLOAT16_RAW: v.u16 = (uint16_t)va_arg(*args, int); break;
+        case CSTRUCT_TYPE_FLOAT32: v.f = (float)va_arg(*args, double); break;
+        case CSTRUCT_TYPE_FLOAT64: v.d = va_arg(*args, double); break;
+        default: return NULL;
+    }
+    return (uint8_t *)cstruct_pack_token(out, tok, &v);
+}
+
+/**
+ * @brief バイナリデータにパックする（va_list版）
+ * 
+ * 指定されたフォーマット文字列に従って、可変引数のデータをバイナリ形式に変換し、
+ * 指定されたバッファに格納します。
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param fmt フォーマット文字列
+ * @param args 可変引数リスト
+ * @return パック後の次の位置、エラー時はNULL
+ */
+void *cstruct_pack_v(void *dst, size_t dstlen, const char *fmt, va_list args) {
+    uint8_t *out = (uint8_t *)dst;
+    const uint8_t *end = out + dstlen;
+    cstruct_endian_t current_endian = CSTRUCT_ENDIAN_LITTLE; // デフォルトはリトルエンディアン
+    va_list ap;
+
+    cstruct_token_t tok;
+    const char *next_fmt = fmt;
+    va_copy(ap, args);
+    while (next_fmt != NULL && *next_fmt != '\0') {
+        next_fmt = parse_token(next_fmt, &tok, &current_endian);
+        
+        if (next_fmt == NULL) {
+            // フォーマット文字列の解析エラー
+            out = NULL;
+            break;
+        }
+        
+        // 全体のサイズチェック
+        if ((size_t)(end - out) < tok.size * tok.count) {
+            out = NULL;
+            break;
         }
+
+        out = cstruct_pack_token_va(out, &tok, &ap);
     }
+    va_end(ap);
 
     return out; // 正常終了時は現在の出力位置を返す
 }
@@ -1275,343 +1905,99 @@ void *cstruct_pack(void *dst, size_t dstlen, const char *fmt, ...) {
 }
 
 /**
- * @brief バイナリデータからアンパックする（va_list版）
- * 
- * 指定されたフォーマット文字列に従って、バイナリデータを可変引数で指定された
- * 変数にアンパックします。
+ * @brief バイナリデータから先頭のフィールドだけをアンパックする（va_list版）
+ *
+ * フォーマット文字列の先頭からmax_fields個のフィールド（パディングを除く）をアンパックし、
+ * 残りのフィールドは解析もサイズの確認も行いません。
+ * 格納先のポインタにNULLを指定したフィールドは読み飛ばします。
  *
  * @param src 入力元バッファ
  * @param srclen 入力元バッファのサイズ
  * @param fmt フォーマット文字列
+ * @param max_fields アンパックするフィールド数
  * @param args 可変引数リスト
- * @return アンパック後の次の位置、エラー時はNULL
+ * @return 最後にアンパックしたフィールドの次の位置、エラー時はNULL
  */
-const void *cstruct_unpack_v(const void *src, size_t srclen, const char *fmt, va_list args) {
+const void *cstruct_unpack_n_v(const void *src, size_t srclen, const char *fmt, size_t max_fields, va_list args) {
     const uint8_t *in = (const uint8_t *)src;
     const uint8_t *end = in + srclen;
     cstruct_endian_t current_endian = CSTRUCT_ENDIAN_LITTLE; // デフォルトはリトルエンディアン
+    va_list ap;
 
     cstruct_token_t tok;
     const char *next_fmt = fmt;
-    while (next_fmt != NULL && *next_fmt != '\0') {
+    size_t fields = 0;
+    va_copy(ap, args);
+    while (fields < max_fields && next_fmt != NULL && *next_fmt != '\0') {
         next_fmt = parse_token(next_fmt, &tok, &current_endian);
         
         if (next_fmt == NULL) {
             // フォーマット文字列の解析エラー
-            return NULL;
+            in = NULL;
+            break;
         }
         
         // 全体のサイズチェック
         if ((size_t)(end - in) < tok.size * tok.count) {
-            return NULL;
+            in = NULL;
+            break;
         }
 
-        switch (tok.type) {
-            case CSTRUCT_TYPE_PADDING:
-                in += tok.size * tok.count; // パディングはサイズ×回数分スキップする
-                break;
-                
-            case CSTRUCT_TYPE_STRING: {
-                char *str = va_arg(args, char *);
-                in = cstruct_unpack_string(in, str, tok.size);
-                break;
-            }
-                
-            case CSTRUCT_TYPE_FLOAT32: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    float *arr = va_arg(args, float *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                            in = cstruct_unpack_float32_le(in, &arr[i]);
-                        } else {
-                            in = cstruct_unpack_float32_be(in, &arr[i]);
-                        }
-                    }
-                } else {
-                    // 単一値として処理
-                    float *f = va_arg(args, float *);
-                    if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                        in = cstruct_unpack_float32_le(in, f);
-                    } else {
-                        in = cstruct_unpack_float32_be(in, f);
-                    }
-                }
-                break;
-            }
-                
-            case CSTRUCT_TYPE_FLOAT64: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    double *arr = va_arg(args, double *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                            in = cstruct_unpack_float64_le(in, &arr[i]);
-                        } else {
-                            in = cstruct_unpack_float64_be(in, &arr[i]);
-                        }
-                    }
-                } else {
-                    // 単一値として処理
-                    double *d = va_arg(args, double *);
-                    if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                        in = cstruct_unpack_float64_le(in, d);
-                    } else {
-                        in = cstruct_unpack_float64_be(in, d);
-                    }
-                }
-                break;
-            }
-                
-            case CSTRUCT_TYPE_FLOAT16: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    float *arr = va_arg(args, float *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                            in = cstruct_unpack_float16_le(in, &arr[i]);
-                        } else {
-                            in = cstruct_unpack_float16_be(in, &arr[i]);
-                        }
-                    }
-                } else {
-                    // 単一値として処理
-                    float *f = va_arg(args, float *);
-                    if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                        in = cstruct_unpack_float16_le(in, f);
-                    } else {
-                        in = cstruct_unpack_float16_be(in, f);
-                    }
-                }
-                break;
-            }
-                
-            case CSTRUCT_TYPE_INT8: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    int8_t *arr = va_arg(args, int8_t *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        in = cstruct_unpack_int8(in, &arr[i]);
-                    }
-                } else {
-                    // 単一値として処理
-                    int8_t *val = va_arg(args, int8_t *);
-                    in = cstruct_unpack_int8(in, val);
-                }
-                break;
-            }
-                
-            case CSTRUCT_TYPE_UINT8: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    uint8_t *arr = va_arg(args, uint8_t *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        in = cstruct_unpack_uint8(in, &arr[i]);
-                    }
-                } else {
-                    // 単一値として処理
-                    uint8_t *val = va_arg(args, uint8_t *);
-                    in = cstruct_unpack_uint8(in, val);
-                }
-                break;
-            }
-                
-            case CSTRUCT_TYPE_INT16: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    int16_t *arr = va_arg(args, int16_t *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                            in = cstruct_unpack_int16_le(in, &arr[i]);
-                        } else {
-                            in = cstruct_unpack_int16_be(in, &arr[i]);
-                        }
-                    }
-                } else {
-                    // 単一値として処理
-                    int16_t *val = va_arg(args, int16_t *);
-                    if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                        in = cstruct_unpack_int16_le(in, val);
-                    } else {
-                        in = cstruct_unpack_int16_be(in, val);
-                    }
-                }
-                break;
-            }
-                
-            case CSTRUCT_TYPE_UINT16: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    uint16_t *arr = va_arg(args, uint16_t *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                            in = cstruct_unpack_uint16_le(in, &arr[i]);
-                        } else {
-                            in = cstruct_unpack_uint16_be(in, &arr[i]);
-                        }
-                    }
-                } else {
-                    // 単一値として処理
-                    uint16_t *val = va_arg(args, uint16_t *);
-                    if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                        in = cstruct_unpack_uint16_le(in, val);
-                    } else {
-                        in = cstruct_unpack_uint16_be(in, val);
-                    }
-                }
-                break;
-            }
-                
-            case CSTRUCT_TYPE_INT32: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    int32_t *arr = va_arg(args, int32_t *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                            in = cstruct_unpack_int32_le(in, &arr[i]);
-                        } else {
-                            in = cstruct_unpack_int32_be(in, &arr[i]);
-                        }
-                    }
-                } else {
-                    // 単一値として処理
-                    int32_t *val = va_arg(args, int32_t *);
-                    if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                        in = cstruct_unpack_int32_le(in, val);
-                    } else {
-                        in = cstruct_unpack_int32_be(in, val);
-                    }
-                }
-                break;
-            }
-                
-            case CSTRUCT_TYPE_UINT32: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    uint32_t *arr = va_arg(args, uint32_t *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                            in = cstruct_unpack_uint32_le(in, &arr[i]);
-                        } else {
-                            in = cstruct_unpack_uint32_be(in, &arr[i]);
-                        }
-                    }
-                } else {
-                    // 単一値として処理
-                    uint32_t *val = va_arg(args, uint32_t *);
-                    if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                        in = cstruct_unpack_uint32_le(in, val);
-                    } else {
-                        in = cstruct_unpack_uint32_be(in, val);
-                    }
-                }
-                break;
-            }
-                
-            case CSTRUCT_TYPE_INT64: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    int64_t *arr = va_arg(args, int64_t *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                            in = cstruct_unpack_int64_le(in, &arr[i]);
-                        } else {
-                            in = cstruct_unpack_int64_be(in, &arr[i]);
-                        }
-                    }
-                } else {
-                    // 単一値として処理
-                    int64_t *val = va_arg(args, int64_t *);
-                    if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                        in = cstruct_unpack_int64_le(in, val);
-                    } else {
-                        in = cstruct_unpack_int64_be(in, val);
-                    }
-                }
-                break;
-            }
-                
-            case CSTRUCT_TYPE_UINT64: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    uint64_t *arr = va_arg(args, uint64_t *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                            in = cstruct_unpack_uint64_le(in, &arr[i]);
-                        } else {
-                            in = cstruct_unpack_uint64_be(in, &arr[i]);
-                        }
-                    }
-                } else {
-                    // 単一値として処理
-                    uint64_t *val = va_arg(args, uint64_t *);
-                    if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                        in = cstruct_unpack_uint64_le(in, val);
-                    } else {
-                        in = cstruct_unpack_uint64_be(in, val);
-                    }
-                }
-                break;
-            }
-                
-            case CSTRUCT_TYPE_INT128: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    void *arr = va_arg(args, void *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        void *elem = (uint8_t *)arr + (i * 16);
-                        if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                            in = cstruct_unpack_int128_le(in, elem);
-                        } else {
-                            in = cstruct_unpack_int128_be(in, elem);
-                        }
-                    }
-                } else {
-                    // 単一値として処理
-                    void *val = va_arg(args, void *);
-                    if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                        in = cstruct_unpack_int128_le(in, val);
-                    } else {
-                        in = cstruct_unpack_int128_be(in, val);
-                    }
-                }
-                break;
-            }
-                
-            case CSTRUCT_TYPE_UINT128: {
-                if (tok.count > 1) {
-                    // 配列として処理
-                    void *arr = va_arg(args, void *);
-                    for (size_t i = 0; i < tok.count; i++) {
-                        void *elem = (uint8_t *)arr + (i * 16);
-                        if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                            in = cstruct_unpack_uint128_le(in, elem);
-                        } else {
-                            in = cstruct_unpack_uint128_be(in, elem);
-                        }
-                    }
-                } else {
-                    // 単一値として処理
-                    void *val = va_arg(args, void *);
-                    if (tok.endian == CSTRUCT_ENDIAN_LITTLE) {
-                        in = cstruct_unpack_uint128_le(in, val);
-                    } else {
-                        in = cstruct_unpack_uint128_be(in, val);
-                    }
-                }
-                break;
-            }
+        // パディング以外は格納先のポインタを受け取る
+        void *ptr = NULL;
+        if (tok.type != CSTRUCT_TYPE_PADDING) {
+            ptr = va_arg(ap, void *);
+            fields++;
         }
+        in = (const uint8_t *)cstruct_unpack_token(in, &tok, ptr);
     }
+    va_end(ap);
 
     return in; // 正常終了時は現在の入力位置を返す
 }
 
+/**
+ * @brief バイナリデータから先頭のフィールドだけをアンパックする
+ *
+ * ルーティングなど、ヘッダだけが必要な場合に残りのフィールドの処理を省きます。
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param fmt フォーマット文字列
+ * @param max_fields アンパックするフィールド数
+ * @param ... 先頭max_fields個のフィールドに対応する変数へのポインタ（NULLで読み飛ばす）
+ * @return 最後にアンパックしたフィールドの次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_n(const void *src, size_t srclen, const char *fmt, size_t max_fields, ...) {
+    const void *result;
+    va_list args;
+    va_start(args, max_fields);
+    result = cstruct_unpack_n_v(src, srclen, fmt, max_fields, args);
+    va_end(args);
+    return result;
+}
+
+/**
+ * @brief バイナリデータからアンパックする（va_list版）
+ * 
+ * 指定されたフォーマット文字列に従って、バイナリデータを可変引数で指定された
+ * 変数にアンパックします。格納先のポインタにNULLを指定したフィールドは読み飛ばします。
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param fmt フォーマット文字列
+ * @param args 可変引数リスト
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_v(const void *src, size_t srclen, const char *fmt, va_list args) {
+    return cstruct_unpack_n_v(src, srclen, fmt, SIZE_MAX, args);
+}
+
 /**
  * @brief バイナリデータからアンパックする
  * 
  * 指定されたフォーマット文字列に従って、バイナリデータを可変引数で指定された
- * 変数にアンパックします。
+ * 変数にアンパックします。格納先のポインタにNULLを指定したフィールドは読み飛ばします。
  *
  * @param src 入力元バッファ
  * @param srclen 入力元バッファのサイズ
@@ -1672,3 +2058,1239 @@ const void *cstruct_get_ptr(const void *src, size_t srclen, const char *fmt, siz
     
     return NULL; // 指定されたインデックスのフィールドが見つからなかった
 }
+
+/**
+ * @brief フォーマット文字列が表すバイナリデータのサイズを計算する
+ *
+ * @param fmt フォーマット文字列
+ * @return パック後のバイト数、エラー時は0
+ */
+size_t cstruct_calcsize(const char *fmt) {
+    cstruct_endian_t current_endian = CSTRUCT_ENDIAN_LITTLE;
+    cstruct_token_t tok;
+    const char *next_fmt = fmt;
+    size_t total = 0;
+
+    while (next_fmt != NULL && *next_fmt != '\0') {
+        next_fmt = parse_token(next_fmt, &tok, &current_endian);
+
+        if (next_fmt == NULL) {
+            // フォーマット文字列の解析エラー
+            return 0;
+        }
+
+        // オーバーフロー検出
+        if (tok.count != 0 && tok.size > (SIZE_MAX - total) / tok.count) {
+            return 0;
+        }
+        total += tok.size * tok.count;
+    }
+
+    return total;
+}
+
+/**
+ * @brief フォーマット文字列をプランにコンパイルする
+ *
+ * @param plan 初期化するプラン
+ * @param tokens トークン列の格納先
+ * @param capacity トークン列の格納先の要素数
+ * @param fmt フォーマット文字列
+ * @return 成功時はplan、エラー時（解析エラー、容量不足）はNULL
+ */
+cstruct_plan_t *cstruct_compile(cstruct_plan_t *plan, cstruct_token_t *tokens, size_t capacity, const char *fmt) {
+    cstruct_endian_t current_endian = CSTRUCT_ENDIAN_LITTLE;
+    const char *next_fmt = fmt;
+
+    plan->tokens = tokens;
+    plan->count = 0;
+    plan->size = 0;
+    plan->fields = 0;
+
+    while (next_fmt != NULL && *next_fmt != '\0') {
+        if (plan->count == capacity) {
+            // トークン列の格納先が不足
+            return NULL;
+        }
+
+        cstruct_token_t *tok = &tokens[plan->count];
+        next_fmt = parse_token(next_fmt, tok, &current_endian);
+
+        if (next_fmt == NULL) {
+            // フォーマット文字列の解析エラー
+            return NULL;
+        }
+
+        // オーバーフロー検出
+        if (tok->size > (SIZE_MAX - plan->size) / tok->count) {
+            return NULL;
+        }
+        plan->size += tok->size * tok->count;
+        plan->count++;
+        if (tok->type != CSTRUCT_TYPE_PADDING) {
+            plan->fields++;
+        }
+    }
+
+    return plan;
+}
+
+/**
+ * @brief インターリーブした配列（C*N）を含むか調べる
+ *
+ * 構造体・列を扱う関数は、メンバ1つに対応付けられないこれらのフィールドを扱えません。
+ * 途中まで書き込んでからエラーにならないよう、処理の前に調べます。
+ *
+ * @param plan プラン
+ * @return インターリーブした配列を含む場合は1
+ */
+static int cstruct_plan_has_interleaved(const cstruct_plan_t *plan) {
+    for (size_t i = 0; i < plan->count; i++) {
+        if (plan->tokens[i].channels != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 構造体のメンバからパックする
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param plan プラン
+ * @param rec 構造体へのポインタ
+ * @param offsets フィールドごとのメンバのオフセット
+ * @return パック後の次の位置、エラー時はNULL
+ */
+void *cstruct_pack_struct(void *dst, size_t dstlen, const cstruct_plan_t *plan, const void *rec, const size_t *offsets) {
+    uint8_t *out = (uint8_t *)dst;
+    const uint8_t *base = (const uint8_t *)rec;
+    size_t field = 0;
+
+    // プランのサイズは固定のため、サイズチェックは一度だけ行う
+    if (dstlen < plan->size || cstruct_plan_has_interleaved(plan)) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < plan->count && out != NULL; i++) {
+        const cstruct_token_t *tok = &plan->tokens[i];
+        const void *member = (tok->type == CSTRUCT_TYPE_PADDING) ? NULL : base + offsets[field++];
+        out = (uint8_t *)cstruct_pack_token(out, tok, member);
+    }
+
+    return out;
+}
+
+/**
+ * @brief 構造体のメンバへアンパックする
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param plan プラン
+ * @param rec 構造体へのポインタ
+ * @param offsets フィールドごとのメンバのオフセット
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_struct(const void *src, size_t srclen, const cstruct_plan_t *plan, void *rec, const size_t *offsets) {
+    const uint8_t *in = (const uint8_t *)src;
+    uint8_t *base = (uint8_t *)rec;
+    size_t field = 0;
+
+    // プランのサイズは固定のため、サイズチェックは一度だけ行う
+    if (srclen < plan->size || cstruct_plan_has_interleaved(plan)) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < plan->count && in != NULL; i++) {
+        const cstruct_token_t *tok = &plan->tokens[i];
+        void *member = (tok->type == CSTRUCT_TYPE_PADDING) ? NULL : base + offsets[field++];
+        in = (const uint8_t *)cstruct_unpack_token(in, tok, member);
+    }
+
+    return in;
+}
+
+/**
+ * @brief トークンの1要素を受け渡すC言語上のバイト数を返す
+ *
+ * cstruct_pack_token()・cstruct_unpack_token()で、配列の要素の間隔になるバイト数です。
+ * float16は4（float）、幅を縮めた整数（"i:24"など）はC言語上の型のサイズになります。
+ *
+ * @param tok フォーマットトークン
+ * @return バイト数（文字列はヌル終端文字を含むサイズ、パディングは0）
+ */
+size_t cstruct_token_elem_size(const cstruct_token_t *tok) {
+    switch (tok->type) {
+        case CSTRUCT_TYPE_PADDING: return 0;
+        case CSTRUCT_TYPE_STRING:  return tok->size + 1; // ヌル終端文字を含む
+        default:                   return cstruct_type_width(tok->type);
+    }
+}
+
+/**
+ * @brief トークン1つ分の値がC言語上で占めるバイト数を求める
+ * @param tok フォーマットトークン
+ * @return バイト数（パディングは0）
+ */
+static size_t cstruct_token_csize(const cstruct_token_t *tok) {
+    if (tok->type == CSTRUCT_TYPE_STRING) {
+        return cstruct_token_elem_size(tok);
+    }
+    return cstruct_token_elem_size(tok) * tok->count;
+}
+
+/**
+ * @brief 連続したレコード列を列ごとの配列へアンパックする
+ *
+ * @param src 入力元バッファ（レコードが隙間なく並んだもの）
+ * @param srclen 入力元バッファのサイズ
+ * @param plan プラン
+ * @param columns フィールドごとの格納先配列
+ * @param nrec レコード数
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_batch(const void *src, size_t srclen, const cstruct_plan_t *plan, void *const *columns, size_t nrec) {
+    const uint8_t *in = (const uint8_t *)src;
+
+    // インターリーブした配列は列に格納できない
+    if ((plan->size != 0 && nrec > srclen / plan->size) || cstruct_plan_has_interleaved(plan)) {
+        return NULL;
+    }
+
+    // フィールドごとに全レコードを処理し、同じ型の変換を連続させる
+    size_t offset = 0;
+    size_t field = 0;
+    for (size_t i = 0; i < plan->count; i++) {
+        const cstruct_token_t *tok = &plan->tokens[i];
+        size_t wire = tok->size * tok->count;
+
+        if (tok->type != CSTRUCT_TYPE_PADDING) {
+            size_t csize = cstruct_token_csize(tok);
+            const uint8_t *p = in + offset;
+            uint8_t *out = (uint8_t *)columns[field++];
+            for (size_t n = 0; n < nrec; n++) {
+                cstruct_unpack_token(p, tok, out);
+                p += plan->size;
+                out += csize;
+            }
+        }
+        offset += wire;
+    }
+
+    return in + plan->size * nrec;
+}
+
+/**
+ * @brief 連続したレコード列を構造体の配列へアンパックする
+ *
+ * @param src 入力元バッファ（レコードが隙間なく並んだもの）
+ * @param srclen 入力元バッファのサイズ
+ * @param plan プラン
+ * @param recs 構造体の配列
+ * @param stride 構造体1つ分のバイト数（sizeof）
+ * @param offsets フィールドごとのメンバのオフセット
+ * @param nrec レコード数
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_batch_struct(const void *src, size_t srclen, const cstruct_plan_t *plan,
+                                        void *recs, size_t stride, const size_t *offsets, size_t nrec) {
+    const uint8_t *in = (const uint8_t *)src;
+    uint8_t *rec = (uint8_t *)recs;
+
+    if ((plan->size != 0 && nrec > srclen / plan->size) || cstruct_plan_has_interleaved(plan)) {
+        return NULL;
+    }
+
+    for (size_t n = 0; n < nrec && in != NULL; n++) {
+        in = (const uint8_t *)cstruct_unpack_struct(in, plan->size, plan, rec, offsets);
+        rec += stride;
+    }
+
+    return in;
+}
+
+/**
+ * @brief プランを構造体に対応付け、連続したコピーをまとめる
+ *
+ * @param binding 初期化する対応付け
+ * @param runs 処理単位の格納先
+ * @param capacity runsの要素数（プランのトークン数以上あれば必ず足りる）
+ * @param plan プラン（bindingより長く保持すること）
+ * @param offsets フィールドごとのメンバのオフセット
+ * @param flags CSTRUCT_BIND_PADDINGなどのフラグ
+ * @return 成功時はbinding、エラー時はNULL
+ */
+cstruct_binding_t *cstruct_bind(cstruct_binding_t *binding, cstruct_run_t *runs, size_t capacity,
+                                const cstruct_plan_t *plan, const size_t *offsets, unsigned flags) {
+    cstruct_run_t *open = NULL; // 後続のフィールドを連結できるコピー
+    size_t pending = 0;         // openの直後に続くパディングのバイト数
+    size_t wire = 0;
+    size_t field = 0;
+
+    binding->plan = plan;
+    binding->runs = runs;
+    binding->count = 0;
+
+    if (cstruct_plan_has_interleaved(plan)) {
+        return NULL; // インターリーブした配列はメンバに対応付けられない
+    }
+
+    for (size_t i = 0; i < plan->count; i++) {
+        const cstruct_token_t *tok = &plan->tokens[i];
+        size_t n = tok->size * tok->count;
+
+        if (tok->type == CSTRUCT_TYPE_PADDING) {
+            // 後続のフィールドが構造体上でも同じだけ離れていれば、パディングごと連結する
+            if (flags & CSTRUCT_BIND_PADDING) {
+                pending += n;
+            }
+            wire += n;
+            continue;
+        }
+
+        size_t off = offsets[field++];
+        int raw = cstruct_token_is_raw(tok);
+
+        if (raw && open != NULL && open->wire + open->len + pending == wire &&
+            open->rec + open->len + pending == off) {
+            open->len += pending + n;
+            pending = 0;
+            wire += n;
+            continue;
+        }
+
+        if (binding->count == capacity) {
+            // 処理単位の格納先が不足
+            return NULL;
+        }
+        cstruct_run_t *run = &runs[binding->count++];
+        run->wire = wire;
+        run->rec = off;
+        run->len = n;
+        run->tok = raw ? NULL : tok;
+        open = raw ? run : NULL;
+        pending = 0;
+        wire += n;
+    }
+
+    return binding;
+}
+
+/**
+ * @brief 対応付けに従って構造体のメンバからパックする
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param binding 対応付け
+ * @param rec 構造体へのポインタ
+ * @return パック後の次の位置、エラー時はNULL
+ */
+void *cstruct_pack_bound(void *dst, size_t dstlen, const cstruct_binding_t *binding, const void *rec) {
+    uint8_t *out = (uint8_t *)dst;
+    const uint8_t *base = (const uint8_t *)rec;
+
+    if (dstlen < binding->plan->size) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < binding->count; i++) {
+        const cstruct_run_t *run = &binding->runs[i];
+        if (run->tok == NULL) {
+            memcpy(out + run->wire, base + run->rec, run->len);
+        } else {
+            cstruct_pack_token(out + run->wire, run->tok, base + run->rec);
+        }
+    }
+
+    return out + binding->plan->size;
+}
+
+/**
+ * @brief 対応付けに従って構造体のメンバへアンパックする
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param binding 対応付け
+ * @param rec 構造体へのポインタ
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_bound(const void *src, size_t srclen, const cstruct_binding_t *binding, void *rec) {
+    const uint8_t *in = (const uint8_t *)src;
+    uint8_t *base = (uint8_t *)rec;
+
+    if (srclen < binding->plan->size) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < binding->count; i++) {
+        const cstruct_run_t *run = &binding->runs[i];
+        if (run->tok == NULL) {
+            memcpy(base + run->rec, in + run->wire, run->len);
+        } else {
+            cstruct_unpack_token(in + run->wire, run->tok, base + run->rec);
+        }
+    }
+
+    return in + binding->plan->size;
+}
+
+/**
+ * @brief 対応付けに従って連続したレコード列を構造体の配列へアンパックする
+ *
+ * @param src 入力元バッファ（レコードが隙間なく並んだもの）
+ * @param srclen 入力元バッファのサイズ
+ * @param binding 対応付け
+ * @param recs 構造体の配列
+ * @param stride 構造体1つ分のバイト数（sizeof）
+ * @param nrec レコード数
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_bound_batch(const void *src, size_t srclen, const cstruct_binding_t *binding,
+                                       void *recs, size_t stride, size_t nrec) {
+    const cstruct_plan_t *plan = binding->plan;
+    const uint8_t *in = (const uint8_t *)src;
+    uint8_t *rec = (uint8_t *)recs;
+
+    if (plan->size != 0 && nrec > srclen / plan->size) {
+        return NULL;
+    }
+
+    // ワイヤ上のレコード列と構造体の配列が同じバイト列になる場合
+    if (binding->count == 1 && binding->runs[0].tok == NULL && binding->runs[0].wire == 0 &&
+        binding->runs[0].rec == 0 && binding->runs[0].len == plan->size && stride == plan->size) {
+        memcpy(rec, in, plan->size * nrec);
+        return in + plan->size * nrec;
+    }
+
+    for (size_t n = 0; n < nrec && in != NULL; n++) {
+        in = (const uint8_t *)cstruct_unpack_bound(in, plan->size, binding, rec);
+        rec += stride;
+    }
+
+    return in;
+}
+
+/**
+ * @brief プランに従ってパックする（va_list版）
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param plan プラン
+ * @param args 可変引数リスト
+ * @return パック後の次の位置、エラー時はNULL
+ */
+void *cstruct_pack_plan_v(void *dst, size_t dstlen, const cstruct_plan_t *plan, va_list args) {
+    uint8_t *out = (uint8_t *)dst;
+    va_list ap;
+
+    // プランのサイズは固定のため、サイズチェックは一度だけ行う
+    if (dstlen < plan->size) {
+        return NULL;
+    }
+
+    va_copy(ap, args);
+    for (size_t i = 0; i < plan->count && out != NULL; i++) {
+        out = cstruct_pack_token_va(out, &plan->tokens[i], &ap);
+    }
+    va_end(ap);
+
+    return out;
+}
+
+/**
+ * @brief プランに従ってパックする
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param plan プラン
+ * @param ... フィールドに対応する値
+ * @return パック後の次の位置、エラー時はNULL
+ */
+void *cstruct_pack_plan(void *dst, size_t dstlen, const cstruct_plan_t *plan, ...) {
+    void *result;
+    va_list args;
+    va_start(args, plan);
+    result = cstruct_pack_plan_v(dst, dstlen, plan, args);
+    va_end(args);
+    return result;
+}
+
+/**
+ * @brief プランに従って先頭のフィールドだけをアンパックする（va_list版）
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param plan プラン
+ * @param max_fields アンパックするフィールド数
+ * @param args 可変引数リスト
+ * @return 最後にアンパックしたフィールドの次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_plan_n_v(const void *src, size_t srclen, const cstruct_plan_t *plan,
+                                    size_t max_fields, va_list args) {
+    const uint8_t *in = (const uint8_t *)src;
+    size_t count = plan->count;
+    size_t size = plan->size;
+    va_list ap;
+
+    // 途中で止める場合は、処理するトークンの範囲とそのサイズを求める
+    // （最後のフィールドの後ろのパディングは、cstruct_unpack_n_v()と同じく処理しない）
+    if (max_fields <= plan->fields) {
+        size_t fields = 0;
+        size = 0;
+        for (count = 0; fields < max_fields; count++) {
+            const cstruct_token_t *tok = &plan->tokens[count];
+            fields += (tok->type != CSTRUCT_TYPE_PADDING);
+            size += tok->size * tok->count;
+        }
+    }
+
+    // サイズチェックは一度だけ行う
+    if (srclen < size) {
+        return NULL;
+    }
+
+    va_copy(ap, args);
+    for (size_t i = 0; i < count; i++) {
+        const cstruct_token_t *tok = &plan->tokens[i];
+        // パディング以外は格納先のポインタを受け取る
+        void *ptr = (tok->type == CSTRUCT_TYPE_PADDING) ? NULL : va_arg(ap, void *);
+        in = (const uint8_t *)cstruct_unpack_token(in, tok, ptr);
+    }
+    va_end(ap);
+
+    return in;
+}
+
+/**
+ * @brief プランに従って先頭のフィールドだけをアンパックする
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ（処理するフィールドまでの長さがあればよい）
+ * @param plan プラン
+ * @param max_fields アンパックするフィールド数
+ * @param ... 先頭max_fields個のフィールドに対応する変数へのポインタ（NULLで読み飛ばす）
+ * @return 最後にアンパックしたフィールドの次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_plan_n(const void *src, size_t srclen, const cstruct_plan_t *plan, size_t max_fields, ...) {
+    const void *result;
+    va_list args;
+    va_start(args, max_fields);
+    result = cstruct_unpack_plan_n_v(src, srclen, plan, max_fields, args);
+    va_end(args);
+    return result;
+}
+
+/**
+ * @brief プランに従ってアンパックする（va_list版）
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param plan プラン
+ * @param args 可変引数リスト
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_plan_v(const void *src, size_t srclen, const cstruct_plan_t *plan, va_list args) {
+    return cstruct_unpack_plan_n_v(src, srclen, plan, SIZE_MAX, args);
+}
+
+/**
+ * @brief プランに従ってアンパックする
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param plan プラン
+ * @param ... フィールドに対応する変数へのポインタ
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_plan(const void *src, size_t srclen, const cstruct_plan_t *plan, ...) {
+    const void *result;
+    va_list args;
+    va_start(args, plan);
+    result = cstruct_unpack_plan_v(src, srclen, plan, args);
+    va_end(args);
+    return result;
+}
+
+/**
+ * @brief 値へのポインタ配列からパックする
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param plan プラン
+ * @param args フィールドごとの値へのポインタ
+ * @return パック後の次の位置、エラー時はNULL
+ */
+void *cstruct_pack_a(void *dst, size_t dstlen, const cstruct_plan_t *plan, const void *const *args) {
+    uint8_t *out = (uint8_t *)dst;
+
+    // プランのサイズは固定のため、サイズチェックは一度だけ行う
+    if (dstlen < plan->size) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < plan->count; i++) {
+        const cstruct_token_t *tok = &plan->tokens[i];
+        const void *value = (tok->type == CSTRUCT_TYPE_PADDING) ? NULL : *args++;
+        out = (uint8_t *)cstruct_pack_token(out, tok, value);
+    }
+
+    return out;
+}
+
+/**
+ * @brief 格納先へのポインタ配列へアンパックする
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param plan プラン
+ * @param args フィールドごとの格納先へのポインタ
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_a(const void *src, size_t srclen, const cstruct_plan_t *plan, void *const *args) {
+    const uint8_t *in = (const uint8_t *)src;
+
+    // プランのサイズは固定のため、サイズチェックは一度だけ行う
+    if (srclen < plan->size) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < plan->count; i++) {
+        const cstruct_token_t *tok = &plan->tokens[i];
+        void *value = (tok->type == CSTRUCT_TYPE_PADDING) ? NULL : *args++;
+        in = (const uint8_t *)cstruct_unpack_token(in, tok, value);
+    }
+
+    return in;
+}
+
+/** @brief 型変換で一度に処理する要素数 */
+#if defined(__AVR__)
+#define CSTRUCT_CONV_BLOCK 8
+#else
+#define CSTRUCT_CONV_BLOCK 64
+#endif
+
+/**
+ * @brief 型変換の中間表現
+ */
+typedef enum {
+    CSTRUCT_CONV_INT,  /**< int64_t（符号付き整数どうし） */
+    CSTRUCT_CONV_UINT, /**< uint64_t（符号なし整数から整数） */
+    CSTRUCT_CONV_REAL  /**< double（浮動小数点数を含む場合、またはスケール・オフセットを指定した場合） */
+} cstruct_conv_mode_t;
+
+/**
+ * @brief 型変換の作業領域
+ */
+typedef union {
+    int64_t i[CSTRUCT_CONV_BLOCK];
+    uint64_t u[CSTRUCT_CONV_BLOCK];
+    double d[CSTRUCT_CONV_BLOCK];
+} cstruct_conv_block_t;
+
+/**
+ * @brief ワイヤ上とホストのエンディアンが異なるか調べる
+ * @param endian ワイヤ上のエンディアン
+ * @return 異なる場合は1
+ */
+static int cstruct_conv_swapped(cstruct_endian_t endian) {
+    return (endian == CSTRUCT_ENDIAN_BIG) != CSTRUCT_IS_BIG_ENDIAN;
+}
+
+/**
+ * @brief 型変換に対応するC言語上の型か調べる
+ * @param type データ型
+ * @return 対応する場合は1
+ */
+static int cstruct_conv_ctype_ok(cstruct_type_t type) {
+    return type <= CSTRUCT_TYPE_UINT64 || type == CSTRUCT_TYPE_FLOAT32 || type == CSTRUCT_TYPE_FLOAT64;
+}
+
+/**
+ * @brief 型変換に対応するC言語上の型の1要素のバイト数を返す
+ * @param type データ型
+ * @return バイト数
+ */
+static size_t cstruct_conv_csize(cstruct_type_t type) {
+    switch (type) {
+        case CSTRUCT_TYPE_INT8:
+        case CSTRUCT_TYPE_UINT8:   return 1;
+        case CSTRUCT_TYPE_INT16:
+        case CSTRUCT_TYPE_UINT16:  return 2;
+        case CSTRUCT_TYPE_INT32:
+        case CSTRUCT_TYPE_UINT32:  return 4;
+        case CSTRUCT_TYPE_FLOAT32: return sizeof(float);
+        case CSTRUCT_TYPE_FLOAT64: return sizeof(double);
+        default:                   return 8;
+    }
+}
+
+/**
+ * @brief データ型が符号付き整数か調べる
+ * @param type データ型
+ * @return 符号付き整数の場合は1
+ */
+static int cstruct_conv_signed(cstruct_type_t type) {
+    return type == CSTRUCT_TYPE_INT8 || type == CSTRUCT_TYPE_INT16 ||
+           type == CSTRUCT_TYPE_INT32 || type == CSTRUCT_TYPE_INT64;
+}
+
+/**
+ * @brief 中間表現を決める
+ * @param from 変換元の型
+ * @param to 変換先の型
+ * @param scaled スケール・オフセットを適用する場合は1
+ * @return 中間表現
+ */
+static cstruct_conv_mode_t cstruct_conv_mode(cstruct_type_t from, cstruct_type_t to, int scaled) {
+    if (scaled || from > CSTRUCT_TYPE_UINT64 || to > CSTRUCT_TYPE_UINT64) {
+        return CSTRUCT_CONV_REAL;
+    }
+    return cstruct_conv_signed(from) ? CSTRUCT_CONV_INT : CSTRUCT_CONV_UINT;
+}
+
+/* 作業領域全体を対象にした単純なループにして、ホストではコンパイラの自動ベクトル化に任せる */
+#define CSTRUCT_CONV_WIDEN(T)                                                   \
+    do {                                                                        \
+        const T *s = (const T *)in;                                             \
+        if (mode == CSTRUCT_CONV_REAL) {                                        \
+            for (size_t k = 0; k < CSTRUCT_CONV_BLOCK; k++) b->d[k] = (double)s[k];              \
+        } else if (mode == CSTRUCT_CONV_INT) {                                  \
+            for (size_t k = 0; k < CSTRUCT_CONV_BLOCK; k++) b->i[k] = (int64_t)s[k];             \
+        } else {                                                                \
+            for (size_t k = 0; k < CSTRUCT_CONV_BLOCK; k++) b->u[k] = (uint64_t)s[k];            \
+        }                                                                       \
+    } while (0)
+
+/**
+ * @brief C言語上の型の値のブロックを中間表現へ広げる
+ * @param b 作業領域
+ * @param type 値の型
+ * @param in 値のブロック（CSTRUCT_CONV_BLOCK要素）
+ * @param mode 中間表現
+ */
+static void cstruct_conv_widen(cstruct_conv_block_t *b, cstruct_type_t type, const cstruct_conv_block_t *in,
+                               cstruct_conv_mode_t mode) {
+    switch (type) {
+        case CSTRUCT_TYPE_INT8:    CSTRUCT_CONV_WIDEN(int8_t); break;
+        case CSTRUCT_TYPE_UINT8:   CSTRUCT_CONV_WIDEN(uint8_t); break;
+        case CSTRUCT_TYPE_INT16:   CSTRUCT_CONV_WIDEN(int16_t); break;
+        case CSTRUCT_TYPE_UINT16:  CSTRUCT_CONV_WIDEN(uint16_t); break;
+        case CSTRUCT_TYPE_INT32:   CSTRUCT_CONV_WIDEN(int32_t); break;
+        case CSTRUCT_TYPE_UINT32:  CSTRUCT_CONV_WIDEN(uint32_t); break;
+        case CSTRUCT_TYPE_INT64:   CSTRUCT_CONV_WIDEN(int64_t); break;
+        case CSTRUCT_TYPE_UINT64:  CSTRUCT_CONV_WIDEN(uint64_t); break;
+        case CSTRUCT_TYPE_FLOAT16: // float16はfloatに展開済み
+        case CSTRUCT_TYPE_FLOAT32: CSTRUCT_CONV_WIDEN(float); break;
+        default:                   CSTRUCT_CONV_WIDEN(double); break;
+    }
+}
+
+/* 整数への変換は飽和させる（doubleからは最も近い整数に丸め（0.5は0から遠い方）、NaNは0とする） */
+#define CSTRUCT_CONV_NARROW_INT(T, LO, HI)                                                  \
+    do {                                                                                    \
+        T *o = (T *)out;                                                                    \
+        if (mode == CSTRUCT_CONV_REAL) {                                                    \
+            for (size_t k = 0; k < CSTRUCT_CONV_BLOCK; k++) {                                                \
+                double v = b->d[k];                                                         \
+                T t = (T)0;                                                                 \
+                if (v >= (double)(HI)) {                                                    \
+                    t = (T)(HI);                                                            \
+                } else if (v <= (double)(LO)) {                                             \
+                    t = (T)(LO);                                                            \
+                } else if (v == v) {                                                        \
+                    t = (T)v;                                                               \
+                    double r = v - (double)t; /* 切り捨てた端数（正確に求まる） */          \
+                    t = (T)(t + (r >= 0.5) - (r <= -0.5));                                  \
+                }                                                                           \
+                o[k] = t;                                                                   \
+            }                                                                               \
+        } else if (mode == CSTRUCT_CONV_INT) {                                              \
+            for (size_t k = 0; k < CSTRUCT_CONV_BLOCK; k++) {                                                \
+                int64_t v = b->i[k];                                                        \
+                o[k] = v < (int64_t)(LO) ? (T)(LO)                                          \
+                     : (v > 0 && (uint64_t)v > (uint64_t)(HI)) ? (T)(HI) : (T)v;            \
+            }                                                                               \
+        } else {                                                                            \
+            for (size_t k = 0; k < CSTRUCT_CONV_BLOCK; k++) {                                                \
+                uint64_t v = b->u[k];                                                       \
+                o[k] = v > (uint64_t)(HI) ? (T)(HI) : (T)v;                                 \
+            }                                                                               \
+        }                                                                                   \
+    } while (0)
+
+#define CSTRUCT_CONV_NARROW_REAL(T)                                             \
+    do {                                                                        \
+        T *o = (T *)out;                                                        \
+        for (size_t k = 0; k < CSTRUCT_CONV_BLOCK; k++) o[k] = (T)b->d[k];                       \
+    } while (0)
+
+/**
+ * @brief 中間表現をC言語上の型の値のブロックへ狭める
+ * @param b 作業領域
+ * @param type 値の型
+ * @param out 値のブロック（CSTRUCT_CONV_BLOCK要素）
+ * @param mode 中間表現
+ */
+static void cstruct_conv_narrow(const cstruct_conv_block_t *b, cstruct_type_t type, cstruct_conv_block_t *out,
+                                cstruct_conv_mode_t mode) {
+    switch (type) {
+        case CSTRUCT_TYPE_INT8:    CSTRUCT_CONV_NARROW_INT(int8_t, INT8_MIN, INT8_MAX); break;
+        case CSTRUCT_TYPE_UINT8:   CSTRUCT_CONV_NARROW_INT(uint8_t, 0, UINT8_MAX); break;
+        case CSTRUCT_TYPE_INT16:   CSTRUCT_CONV_NARROW_INT(int16_t, INT16_MIN, INT16_MAX); break;
+        case CSTRUCT_TYPE_UINT16:  CSTRUCT_CONV_NARROW_INT(uint16_t, 0, UINT16_MAX); break;
+        case CSTRUCT_TYPE_INT32:   CSTRUCT_CONV_NARROW_INT(int32_t, INT32_MIN, INT32_MAX); break;
+        case CSTRUCT_TYPE_UINT32:  CSTRUCT_CONV_NARROW_INT(uint32_t, 0, UINT32_MAX); break;
+        case CSTRUCT_TYPE_INT64:   CSTRUCT_CONV_NARROW_INT(int64_t, INT64_MIN, INT64_MAX); break;
+        case CSTRUCT_TYPE_UINT64:  CSTRUCT_CONV_NARROW_INT(uint64_t, 0, UINT64_MAX); break;
+        case CSTRUCT_TYPE_FLOAT16: // float16はfloatからパックする
+        case CSTRUCT_TYPE_FLOAT32: CSTRUCT_CONV_NARROW_REAL(float); break;
+        default:                   CSTRUCT_CONV_NARROW_REAL(double); break;
+    }
+}
+
+/**
+ * @brief 配列トークンを異なるC言語上の型の配列へアンパックする
+ *
+ * ワイヤ上の値をxとして、x * scale + offset を格納先の型に変換します。
+ * 整数への変換は最も近い整数に丸め、範囲外の値は最小値・最大値に飽和させます。
+ * 整数どうしでscale = 1、offset = 0の場合は浮動小数点数を経由しません。
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param tok フォーマットトークン（整数・浮動小数点数。128ビット整数は不可）
+ * @param dst 格納先の配列（要素数はtok->count）
+ * @param dtype 格納先の型（整数・CSTRUCT_TYPE_FLOAT32・CSTRUCT_TYPE_FLOAT64）
+ * @param scale スケール
+ * @param offset オフセット
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_convert(const void *src, size_t srclen, const cstruct_token_t *tok,
+                                   void *dst, cstruct_type_t dtype, double scale, double offset) {
+    const uint8_t *in = (const uint8_t *)src;
+    uint8_t *out = (uint8_t *)dst;
+    cstruct_conv_block_t b;
+    cstruct_conv_block_t raw;
+
+    if (!cstruct_conv_ctype_ok(dtype) || (!cstruct_conv_ctype_ok(tok->type) && tok->type != CSTRUCT_TYPE_FLOAT16) ||
+        tok->channels != 0) {
+        return NULL;
+    }
+    if (tok->count > srclen / tok->size) {
+        return NULL;
+    }
+
+    int scaled = (scale != 1.0 || offset != 0.0);
+    cstruct_conv_mode_t mode = cstruct_conv_mode(tok->type, dtype, scaled);
+    size_t dsize = cstruct_conv_csize(dtype);
+    cstruct_token_t part = *tok;
+
+    // ブロックの末尾の未使用部分も変換されるため、0で初期化しておく
+    memset(&raw, 0, sizeof(raw));
+
+    for (size_t left = tok->count; left > 0; left -= part.count) {
+        part.count = left < CSTRUCT_CONV_BLOCK ? left : CSTRUCT_CONV_BLOCK;
+        if (tok->type == CSTRUCT_TYPE_FLOAT16 || cstruct_token_is_narrow(tok)) {
+            in = (const uint8_t *)cstruct_unpack_token(in, &part, &raw);
+        } else {
+            memcpy(&raw, in, tok->size * part.count);
+            if (cstruct_conv_swapped(tok->endian)) {
+                cstruct_swap_array(&raw, tok->size, CSTRUCT_CONV_BLOCK);
+            }
+            in += tok->size * part.count;
+        }
+        cstruct_conv_widen(&b, tok->type, &raw, mode);
+        if (scaled) {
+            for (size_t k = 0; k < CSTRUCT_CONV_BLOCK; k++) {
+                b.d[k] = b.d[k] * scale + offset;
+            }
+        }
+        cstruct_conv_narrow(&b, dtype, &raw, mode);
+        memcpy(out, &raw, dsize * part.count);
+        out += dsize * part.count;
+    }
+
+    return in;
+}
+
+/**
+ * @brief 異なるC言語上の型の配列から配列トークンをパックする
+ *
+ * cstruct_unpack_convert()の逆変換です。値をvとして、(v - offset) / scale を
+ * ワイヤ上の型に変換します（整数は丸めと飽和を行います）。
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param tok フォーマットトークン（整数・浮動小数点数。128ビット整数は不可）
+ * @param src 値の配列（要素数はtok->count）
+ * @param stype 値の型（整数・CSTRUCT_TYPE_FLOAT32・CSTRUCT_TYPE_FLOAT64）
+ * @param scale スケール（0は不可）
+ * @param offset オフセット
+ * @return パック後の次の位置、エラー時はNULL
+ */
+void *cstruct_pack_convert(void *dst, size_t dstlen, const cstruct_token_t *tok,
+                           const void *src, cstruct_type_t stype, double scale, double offset) {
+    const uint8_t *in = (const uint8_t *)src;
+    uint8_t *out = (uint8_t *)dst;
+    cstruct_conv_block_t b;
+    cstruct_conv_block_t raw;
+
+    if (!cstruct_conv_ctype_ok(stype) || (!cstruct_conv_ctype_ok(tok->type) && tok->type != CSTRUCT_TYPE_FLOAT16) ||
+        tok->channels != 0) {
+        return NULL;
+    }
+    if (scale == 0.0 || tok->count > dstlen / tok->size) {
+        return NULL;
+    }
+
+    int scaled = (scale != 1.0 || offset != 0.0);
+    cstruct_conv_mode_t mode = cstruct_conv_mode(stype, tok->type, scaled);
+    size_t ssize = cstruct_conv_csize(stype);
+    cstruct_token_t part = *tok;
+
+    // ブロックの末尾の未使用部分も変換されるため、0で初期化しておく
+    memset(&raw, 0, sizeof(raw));
+
+    for (size_t left = tok->count; left > 0; left -= part.count) {
+        part.count = left < CSTRUCT_CONV_BLOCK ? left : CSTRUCT_CONV_BLOCK;
+        memcpy(&raw, in, ssize * part.count);
+        cstruct_conv_widen(&b, stype, &raw, mode);
+        if (scaled) {
+            for (size_t k = 0; k < CSTRUCT_CONV_BLOCK; k++) {
+                b.d[k] = (b.d[k] - offset) / scale;
+            }
+        }
+        cstruct_conv_narrow(&b, tok->type, &raw, mode);
+        if (tok->type == CSTRUCT_TYPE_FLOAT16 || cstruct_token_is_narrow(tok)) {
+            out = (uint8_t *)cstruct_pack_token(out, &part, &raw);
+        } else {
+            if (cstruct_conv_swapped(tok->endian)) {
+                cstruct_swap_array(&raw, tok->size, CSTRUCT_CONV_BLOCK);
+            }
+            memcpy(out, &raw, tok->size * part.count);
+            out += tok->size * part.count;
+        }
+        in += ssize * part.count;
+    }
+
+    return out;
+}
+
+/**
+ * @brief バイト順の逆転が必要なトークンか判定する
+ * @param tok フォーマットトークン
+ * @return 逆転が必要な場合は1（パディング・文字列・1バイトの値は0）
+ */
+static int cstruct_token_swappable(const cstruct_token_t *tok) {
+    return tok->type != CSTRUCT_TYPE_PADDING && tok->type != CSTRUCT_TYPE_STRING && tok->size > 1;
+}
+
+/**
+ * @brief バイト順の逆転で変換できないフィールドを含むか調べる
+ * @param plan プラン
+ * @return 12ビットの組（H:12）を含む場合は1
+ */
+static int cstruct_plan_has_packed12(const cstruct_plan_t *plan) {
+    for (size_t i = 0; i < plan->count; i++) {
+        if (plan->tokens[i].type == CSTRUCT_TYPE_PACKED12) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief パック済みのデータのバイト順をその場で逆転する
+ *
+ * 複数バイトのフィールド（配列は要素ごと）のバイト順を逆転し、
+ * リトルエンディアンとビッグエンディアンを相互に変換します。
+ * フォーマット文字列のエンディアン指定子は結果に影響しません。
+ * 12ビットの組（H:12）はバイト順の逆転では詰め方を変換できないため、エラーになります。
+ *
+ * @param buf データ
+ * @param len データのバイト数
+ * @param fmt フォーマット文字列
+ * @return 処理したデータの次の位置、エラー時（12ビットの組を含む場合を含む）はNULL（bufは変更されない）
+ */
+void *cstruct_swap_inplace(void *buf, size_t len, const char *fmt) {
+    cstruct_endian_t endian = CSTRUCT_ENDIAN_LITTLE;
+    cstruct_token_t tok;
+    const char *p = fmt;
+    size_t total = 0;
+
+    // 途中で失敗して一部だけ変換されることがないよう、先に全体を検査する
+    while (*p != '\0') {
+        p = parse_token(p, &tok, &endian);
+        if (p == NULL || tok.type == CSTRUCT_TYPE_PACKED12) {
+            return NULL;
+        }
+        if (tok.count != 0 && tok.size > (len - total) / tok.count) {
+            return NULL;
+        }
+        total += tok.size * tok.count;
+    }
+
+    uint8_t *b = (uint8_t *)buf;
+    p = fmt;
+    while (*p != '\0') {
+        p = parse_token(p, &tok, &endian);
+        if (cstruct_token_swappable(&tok)) {
+            cstruct_swap_array(b, tok.size, tok.count);
+        }
+        b += tok.size * tok.count;
+    }
+
+    return b;
+}
+
+/**
+ * @brief パック済みのデータのバイト順をプランに従ってその場で逆転する
+ *
+ * 同じサイズの値が続くフィールドはまとめて処理します。
+ *
+ * @param buf データ
+ * @param len データのバイト数
+ * @param plan プラン
+ * @return 処理したデータの次の位置、エラー時（12ビットの組を含む場合を含む）はNULL（bufは変更されない）
+ */
+void *cstruct_swap_inplace_plan(void *buf, size_t len, const cstruct_plan_t *plan) {
+    uint8_t *b = (uint8_t *)buf;
+    uint8_t *run = b;
+    size_t run_size = 0;
+    size_t run_count = 0;
+
+    if (len < plan->size || cstruct_plan_has_packed12(plan)) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < plan->count; i++) {
+        const cstruct_token_t *tok = &plan->tokens[i];
+        if (cstruct_token_swappable(tok) && tok->size == run_size) {
+            run_count += tok->count;
+        } else {
+            cstruct_swap_array(run, run_size, run_count);
+            run_size = cstruct_token_swappable(tok) ? tok->size : 0;
+            run_count = tok->count;
+            run = b;
+        }
+        b += tok->size * tok->count;
+    }
+    cstruct_swap_array(run, run_size, run_count);
+
+    return b;
+}
+
+/**
+ * @brief 連続したレコード列のバイト順をその場で逆転する
+ *
+ * すべてのフィールドが同じサイズの値（例: "HhhHe"）の場合は、レコード列全体を
+ * 1つの配列として処理します。
+ *
+ * @param buf レコード列（レコードが隙間なく並んだもの）
+ * @param len レコード列のバイト数
+ * @param plan プラン
+ * @param nrec レコード数
+ * @return 処理したデータの次の位置、エラー時（12ビットの組を含む場合を含む）はNULL（bufは変更されない）
+ */
+void *cstruct_swap_batch(void *buf, size_t len, const cstruct_plan_t *plan, size_t nrec) {
+    uint8_t *b = (uint8_t *)buf;
+    size_t width = 0;
+
+    if ((plan->size != 0 && nrec > len / plan->size) || cstruct_plan_has_packed12(plan)) {
+        return NULL;
+    }
+
+    // すべてのフィールドが同じサイズか調べる
+    for (size_t i = 0; i < plan->count; i++) {
+        const cstruct_token_t *tok = &plan->tokens[i];
+        if (!cstruct_token_swappable(tok) || (width != 0 && tok->size != width)) {
+            width = 0;
+            break;
+        }
+        width = tok->size;
+    }
+
+    if (width != 0) {
+        cstruct_swap_array(b, width, plan->size / width * nrec);
+        return b + plan->size * nrec;
+    }
+
+    for (size_t n = 0; n < nrec; n++) {
+        b = (uint8_t *)cstruct_swap_inplace_plan(b, plan->size, plan);
+    }
+    return b;
+}
+
+/**
+ * @brief 配列トークンを少しずつアンパックしてコールバックに渡す
+ *
+ * 配列全体を格納する領域を用意せずに、作業領域の大きさずつアンパックして
+ * 関数に渡します。必要なRAMは作業領域の分だけです。
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param tok フォーマットトークン（整数・浮動小数点数。文字列・パディングは不可）
+ * @param scratch 作業領域（chunk要素分。要素の型はcstruct_unpack_token()の格納先と同じ）
+ * @param chunk 一度に渡す要素数
+ * @param fn 値を受け取る関数
+ * @param ctx fnに渡すコンテキスト
+ * @return アンパック後の次の位置、エラー時または中断した場合はNULL
+ */
+const void *cstruct_unpack_chunked(const void *src, size_t srclen, const cstruct_token_t *tok,
+                                   void *scratch, size_t chunk, cstruct_chunk_fn fn, void *ctx) {
+    const uint8_t *in = (const uint8_t *)src;
+
+    if (tok->type == CSTRUCT_TYPE_PADDING || tok->type == CSTRUCT_TYPE_STRING || tok->channels != 0 || chunk == 0) {
+        return NULL;
+    }
+    if (tok->count > srclen / tok->size) {
+        return NULL;
+    }
+
+    cstruct_token_t part = *tok;
+    for (size_t left = tok->count; left > 0; left -= part.count) {
+        part.count = left < chunk ? left : chunk;
+        in = (const uint8_t *)cstruct_unpack_token(in, &part, scratch);
+        if (fn(ctx, scratch, part.count) != 0) {
+            return NULL;
+        }
+    }
+
+    return in;
+}
+
+/**
+ * @brief 格納先へのポインタ配列へアンパックし、指定した配列は少しずつコールバックに渡す
+ *
+ * cstruct_unpack_a()と同じくフィールドごとの格納先をargsに指定し、
+ * sinks[i]を指定したフィールドはcstruct_unpack_chunked()と同じく作業領域ずつ関数に渡します
+ * （args[i]は使いません）。ヘッダと大きな配列を含むフレームを、配列全体の領域なしで1回で処理できます。
+ * 文字列・インターリーブした配列にsinkを指定した場合は、何も処理せずにエラーを返します。
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param plan プラン
+ * @param args フィールドごとの格納先へのポインタ（NULLで読み飛ばす）
+ * @param sinks フィールドごとの受け取り先へのポインタ（NULLの場合はargsに格納する）
+ * @return アンパック後の次の位置、エラー時または中断した場合はNULL
+ */
+const void *cstruct_unpack_a_chunked(const void *src, size_t srclen, const cstruct_plan_t *plan,
+                                     void *const *args, const cstruct_chunk_sink_t *const *sinks) {
+    const uint8_t *in = (const uint8_t *)src;
+    size_t field = 0;
+
+    // プランのサイズは固定のため、サイズチェックは一度だけ行う
+    if (srclen < plan->size) {
+        return NULL;
+    }
+
+    // 少しずつ渡せないフィールドへの指定は、格納先に書き込む前に拒否する
+    for (size_t i = 0; i < plan->count; i++) {
+        const cstruct_token_t *tok = &plan->tokens[i];
+        if (tok->type == CSTRUCT_TYPE_PADDING) {
+            continue;
+        }
+        const cstruct_chunk_sink_t *sink = sinks[field++];
+        if (sink != NULL && (tok->type == CSTRUCT_TYPE_STRING || tok->channels != 0 || sink->chunk == 0)) {
+            return NULL;
+        }
+    }
+
+    field = 0;
+    for (size_t i = 0; i < plan->count; i++) {
+        const cstruct_token_t *tok = &plan->tokens[i];
+        if (tok->type == CSTRUCT_TYPE_PADDING) {
+            in = (const uint8_t *)cstruct_unpack_token(in, tok, NULL);
+            continue;
+        }
+        const cstruct_chunk_sink_t *sink = sinks[field];
+        void *value = args[field];
+        field++;
+        if (sink == NULL) {
+            in = (const uint8_t *)cstruct_unpack_token(in, tok, value);
+            continue;
+        }
+        in = (const uint8_t *)cstruct_unpack_chunked(in, tok->size * tok->count, tok, sink->scratch, sink->chunk,
+                                                      sink->fn, sink->ctx);
+        if (in == NULL) {
+            return NULL;
+        }
+    }
+
+    return in;
+}
+
+/**
+ * @brief 関数から少しずつ値を受け取って配列トークンをパックする
+ *
+ * 配列全体の値を用意せずに、作業領域の大きさずつ関数に値を作らせてパックします。
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param tok フォーマットトークン（整数・浮動小数点数。文字列・パディングは不可）
+ * @param scratch 作業領域（chunk要素分。要素の型はcstruct_pack_token()の値と同じ）
+ * @param chunk 一度に受け取る要素数
+ * @param fn 値を作る関数
+ * @param ctx fnに渡すコンテキスト
+ * @return パック後の次の位置、エラー時または中断した場合はNULL
+ */
+void *cstruct_pack_chunked(void *dst, size_t dstlen, const cstruct_token_t *tok,
+                           void *scratch, size_t chunk, cstruct_fill_fn fn, void *ctx) {
+    uint8_t *out = (uint8_t *)dst;
+
+    if (tok->type == CSTRUCT_TYPE_PADDING || tok->type == CSTRUCT_TYPE_STRING || tok->channels != 0 || chunk == 0) {
+        return NULL;
+    }
+    if (tok->count > dstlen / tok->size) {
+        return NULL;
+    }
+
+    cstruct_token_t part = *tok;
+    for (size_t left = tok->count; left > 0; left -= part.count) {
+        part.count = left < chunk ? left : chunk;
+        if (fn(ctx, scratch, part.count) != 0) {
+            return NULL;
+        }
+        out = (uint8_t *)cstruct_pack_token(out, &part, scratch);
+    }
+
+    return out;
+}
+
+/**
+ * @brief 関数から少しずつ値を受け取ってパックし、出力先の関数に渡す
+ *
+ * 出力のバッファも持たずに、パックした結果をchunk要素ずつsinkに渡します。
+ * 必要なRAMは作業領域と出力の作業領域の分だけで、配列の長さによりません。
+ * sinkのvaluesはパック済みのバイト列、nは要素数です（バイト数はn * tok->size）。
+ *
+ * @param tok フォーマットトークン（整数・浮動小数点数。文字列・パディングは不可）
+ * @param scratch 作業領域（chunk要素分）
+ * @param wire 出力の作業領域（chunk * tok->size バイト）
+ * @param chunk 一度に処理する要素数
+ * @param fill 値を作る関数
+ * @param sink パックした結果を受け取る関数
+ * @param ctx fill・sinkに渡すコンテキスト
+ * @return 成功時は0、エラー時または中断した場合は-1
+ */
+int cstruct_pack_chunked_sink(const cstruct_token_t *tok, void *scratch, void *wire, size_t chunk,
+                              cstruct_fill_fn fill, cstruct_chunk_fn sink, void *ctx) {
+    if (tok->type == CSTRUCT_TYPE_PADDING || tok->type == CSTRUCT_TYPE_STRING || tok->channels != 0 || chunk == 0) {
+        return -1;
+    }
+
+    cstruct_token_t part = *tok;
+    for (size_t left = tok->count; left > 0; left -= part.count) {
+        part.count = left < chunk ? left : chunk;
+        if (fill(ctx, scratch, part.count) != 0) {
+            return -1;
+        }
+        cstruct_pack_token(wire, &part, scratch);
+        if (sink(ctx, wire, part.count) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
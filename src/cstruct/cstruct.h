@@ -33,9 +33,29 @@
  * t       int128_t    16                signed 128bit整数
  * T       uint128_t   16                unsigned 128bit整数
  * e       float       2                 IEEE754 half precision (16ビット浮動小数点数)
+ * E       uint16_t    2                 IEEE754 half precision のビットパターン（変換しない）
  * f       float       4                 IEEE754 float32 (32ビット浮動小数点数)
  * d       double      8                 IEEE754 float64 (64ビット浮動小数点数)
  *
+ * # 整数のビット幅指定
+ * 整数の型指定子の後に":ビット数"を付けると、ワイヤ上の幅を縮めた整数になる
+ * （例: i:24 は int32_t を3バイトで、q:48 は int64_t を6バイトで表す）
+ * ビット数はC言語上の型のビット数以下の8の倍数。符号付きの型はアンパック時に符号拡張される
+ * 繰り返し回数は型指定子の前に書く（例: 8i:24）
+ * ビット数は有効な幅になる最長の先頭部分だけを読み、続く数字は次のフィールドの繰り返し回数になる
+ * （例: i:244h は i:24 と 4h、i:248i:24 は i:24 と 8i:24）
+ * H:12 は2つの値を3バイトに詰めた12ビット符号なし整数の配列（値の数は偶数、uint16_tの配列で受け渡す）
+ *   < は下位のビットから詰める順（b0 = v0[7:0], b1 = v1[3:0]:v0[11:8], b2 = v1[11:4]）
+ *   > は上位のビットから詰める順（b0 = v0[11:4], b1 = v0[3:0]:v1[11:8], b2 = v1[7:0]）
+ *
+ * # インターリーブした配列
+ * "チャネル数*サンプル数"を型指定子の前に書くと、チャネルごとの配列と
+ * ワイヤ上のインターリーブした配列（ch0[0], ch1[0], ..., ch0[1], ch1[1], ...）を相互に変換する
+ * （例: <2*256h は256サンプルの2チャネルのint16_tで、ワイヤ上は512要素）
+ * 値はチャネルごとの配列へのポインタの配列で受け渡す。文字列・パディング・H:12には指定できない
+ * 構造体・列を扱う関数（cstruct_pack_struct()、cstruct_unpack_batch()、cstruct_bind()など）は、
+ * これを含むプランに対して何も書き込まずにエラーを返す
+ *
  * # 特別なフィールド
  * 記号    型          サイズ            備考
  * xN      パディング   N bytes          Nバイトのゼロ埋めパディング
@@ -71,7 +91,9 @@ typedef enum {
     CSTRUCT_TYPE_FLOAT32,  /**< 32ビット浮動小数点数 (IEEE754 single precision) */
     CSTRUCT_TYPE_FLOAT64,  /**< 64ビット浮動小数点数 (IEEE754 double precision) */
     CSTRUCT_TYPE_PADDING,  /**< パディング（0埋め） */
-    CSTRUCT_TYPE_STRING    /**< 文字列 */
+    CSTRUCT_TYPE_STRING,   /**< 文字列 */
+    CSTRUCT_TYPE_FLOAT16_RAW, /**< 16ビット浮動小数点数のビットパターン（uint16_tまたは_Float16で受け渡す） */
+    CSTRUCT_TYPE_PACKED12  /**< 12ビット符号なし整数2つを3バイトに詰めたもの（1要素が2値。uint16_tの配列で受け渡す） */
 } cstruct_type_t;
 
 /**
@@ -90,10 +112,51 @@ typedef enum {
 typedef struct {
     cstruct_type_t type;    /**< データ型 */
     cstruct_endian_t endian; /**< エンディアン */
-    size_t size;           /**< サイズ（バイト数） */
+    size_t size;           /**< ワイヤ上の1要素のサイズ（バイト数） */
     size_t count;          /**< 繰り返し回数 */
+    size_t channels;       /**< インターリーブしたチャネル数（0はインターリーブしない） */
 } cstruct_token_t;
 
+/**
+ * @brief コンパイル済みフォーマット（プラン）
+ *
+ * フォーマット文字列を事前にトークン列へ変換したもの。
+ * トークン列の領域は呼び出し側が用意します（動的メモリ確保は行いません）。
+ */
+typedef struct {
+    cstruct_token_t *tokens; /**< トークン列 */
+    size_t count;            /**< トークン数 */
+    size_t size;             /**< パック後のバイト数 */
+    size_t fields;           /**< 値を受け渡すフィールド数（パディングを除く） */
+} cstruct_plan_t;
+
+/**
+ * @brief 構造体に対応付けたプランの処理単位
+ *
+ * ワイヤ上の並びとホストのメモリ上の並びが一致し、構造体上でも隙間なく続くフィールドは、
+ * 1つのコピー（tok == NULL）にまとめられます。
+ */
+typedef struct {
+    size_t wire;                /**< ワイヤ上のオフセット */
+    size_t rec;                 /**< 構造体上のオフセット */
+    size_t len;                 /**< ワイヤ上のバイト数 */
+    const cstruct_token_t *tok; /**< 変換が必要なトークン（単純なコピーの場合はNULL） */
+} cstruct_run_t;
+
+/**
+ * @brief 構造体に対応付けたプラン
+ *
+ * 処理単位の領域は呼び出し側が用意します（動的メモリ確保は行いません）。
+ */
+typedef struct {
+    const cstruct_plan_t *plan; /**< プラン */
+    cstruct_run_t *runs;        /**< 処理単位の列 */
+    size_t count;               /**< 処理単位の数 */
+} cstruct_binding_t;
+
+/** @brief パディングをまたいでコピーをまとめる（構造体側の同じ位置の内容も読み書きされる） */
+#define CSTRUCT_BIND_PADDING 0x01
+
 /**
  * @brief バイナリデータにパックする
  * 
@@ -126,7 +189,7 @@ void *cstruct_pack_v(void *dst, size_t dstlen, const char *fmt, va_list args);
  * @brief バイナリデータからアンパックする
  * 
  * 指定されたフォーマット文字列に従って、バイナリデータを可変引数で指定された
- * 変数にアンパックします。
+ * 変数にアンパックします。格納先のポインタにNULLを指定したフィールドは読み飛ばします。
  *
  * @param src 入力元バッファ
  * @param srclen 入力元バッファのサイズ
@@ -140,7 +203,7 @@ const void *cstruct_unpack(const void *src, size_t srclen, const char *fmt, ...)
  * @brief バイナリデータからアンパックする（va_list版）
  * 
  * 指定されたフォーマット文字列に従って、バイナリデータを可変引数で指定された
- * 変数にアンパックします。
+ * 変数にアンパックします。格納先のポインタにNULLを指定したフィールドは読み飛ばします。
  *
  * @param src 入力元バッファ
  * @param srclen 入力元バッファのサイズ
@@ -150,6 +213,36 @@ const void *cstruct_unpack(const void *src, size_t srclen, const char *fmt, ...)
  */
 const void *cstruct_unpack_v(const void *src, size_t srclen, const char *fmt, va_list args);
 
+/**
+ * @brief バイナリデータから先頭のフィールドだけをアンパックする
+ *
+ * ルーティングなど、ヘッダだけが必要な場合に残りのフィールドの処理を省きます。
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param fmt フォーマット文字列
+ * @param max_fields アンパックするフィールド数
+ * @param ... 先頭max_fields個のフィールドに対応する変数へのポインタ（NULLで読み飛ばす）
+ * @return 最後にアンパックしたフィールドの次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_n(const void *src, size_t srclen, const char *fmt, size_t max_fields, ...);
+
+/**
+ * @brief バイナリデータから先頭のフィールドだけをアンパックする（va_list版）
+ *
+ * フォーマット文字列の先頭からmax_fields個のフィールド（パディングを除く）をアンパックし、
+ * 残りのフィールドは解析もサイズの確認も行いません。
+ * 格納先のポインタにNULLを指定したフィールドは読み飛ばします。
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param fmt フォーマット文字列
+ * @param max_fields アンパックするフィールド数
+ * @param args 可変引数リスト
+ * @return 最後にアンパックしたフィールドの次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_n_v(const void *src, size_t srclen, const char *fmt, size_t max_fields, va_list args);
+
 /**
  * @brief 指定されたインデックスのフィールドの位置を取得する
  * 
@@ -161,6 +254,495 @@ const void *cstruct_unpack_v(const void *src, size_t srclen, const char *fmt, va
  */
 const void *cstruct_get_ptr(const void *src, size_t srclen, const char *fmt, size_t index);
 
+/**
+ * @brief フォーマット文字列が表すバイナリデータのサイズを計算する
+ *
+ * @param fmt フォーマット文字列
+ * @return パック後のバイト数、エラー時は0
+ */
+size_t cstruct_calcsize(const char *fmt);
+
+/**
+ * @brief フォーマット文字列をプランにコンパイルする
+ *
+ * @param plan 初期化するプラン
+ * @param tokens トークン列の格納先
+ * @param capacity トークン列の格納先の要素数
+ * @param fmt フォーマット文字列
+ * @return 成功時はplan、エラー時（解析エラー、容量不足）はNULL
+ */
+cstruct_plan_t *cstruct_compile(cstruct_plan_t *plan, cstruct_token_t *tokens, size_t capacity, const char *fmt);
+
+/**
+ * @brief トークン単位でパックする
+ *
+ * 配列トークン（count > 1）の場合、valueは要素数分の配列を指します。
+ * インターリーブした配列（channels != 0）の場合、valueはチャネルごとの配列へのポインタの配列を指します
+ * （NULLのチャネルは0としてパックする）。
+ * 出力先バッファのサイズは呼び出し側で確認してください。
+ *
+ * @param dst 出力先バッファ
+ * @param tok フォーマットトークン
+ * @param value パックする値（配列の場合は先頭要素）へのポインタ、文字列の場合は文字列
+ * @return パック後の次の位置
+ */
+void *cstruct_pack_token(void *dst, const cstruct_token_t *tok, const void *value);
+
+/**
+ * @brief トークン単位でアンパックする
+ *
+ * 配列トークン（count > 1）の場合、valueは要素数分の配列を指します。
+ * インターリーブした配列（channels != 0）の場合、valueはチャネルごとの格納先へのポインタの配列を指します
+ * （NULLのチャネルは読み飛ばす）。
+ * 入力元バッファのサイズは呼び出し側で確認してください。
+ *
+ * @param src 入力元バッファ
+ * @param tok フォーマットトークン
+ * @param value アンパックした値（配列の場合は先頭要素）を格納する変数へのポインタ（NULLで読み飛ばす）
+ * @return アンパック後の次の位置
+ */
+const void *cstruct_unpack_token(const void *src, const cstruct_token_t *tok, void *value);
+
+/**
+ * @brief インターリーブした配列トークンの一部のフレームをパックする
+ *
+ * フレームはチャネルごとに1要素ずつの組です。cstruct_pack_token()は全フレームをパックします。
+ *
+ * @param dst 出力先（先頭のフレームの位置）
+ * @param tok フォーマットトークン（channels != 0）
+ * @param chans チャネルごとの値の配列（NULLのチャネルは0としてパックする）
+ * @param first 先頭のフレーム番号
+ * @param frames フレーム数
+ * @return パック後の次の位置
+ */
+void *cstruct_pack_interleaved(void *dst, const cstruct_token_t *tok, const void *const *chans,
+                               size_t first, size_t frames);
+
+/**
+ * @brief インターリーブした配列トークンの一部のフレームをアンパックする
+ *
+ * @param src 入力元（先頭のフレームの位置）
+ * @param tok フォーマットトークン（channels != 0）
+ * @param chans チャネルごとの格納先の配列（NULLのチャネルは読み飛ばす）
+ * @param first 先頭のフレーム番号
+ * @param frames フレーム数
+ * @return アンパック後の次の位置
+ */
+const void *cstruct_unpack_interleaved(const void *src, const cstruct_token_t *tok, void *const *chans,
+                                       size_t first, size_t frames);
+
+/**
+ * @brief トークンの1要素を受け渡すC言語上のバイト数を返す
+ *
+ * cstruct_pack_token()・cstruct_unpack_token()で、配列の要素の間隔になるバイト数です。
+ * float16は4（float）、幅を縮めた整数（"i:24"など）はC言語上の型のサイズになります。
+ *
+ * @param tok フォーマットトークン
+ * @return バイト数（文字列はヌル終端文字を含むサイズ、パディングは0）
+ */
+size_t cstruct_token_elem_size(const cstruct_token_t *tok);
+
+/**
+ * @brief プランに従ってパックする
+ *
+ * 引数の渡し方はcstruct_pack()と同じです。プランのサイズは固定のため、
+ * バッファサイズの確認は最初に一度だけ行い、トークンごとには確認しません。
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param plan プラン
+ * @param ... フィールドに対応する値
+ * @return パック後の次の位置、エラー時はNULL
+ */
+void *cstruct_pack_plan(void *dst, size_t dstlen, const cstruct_plan_t *plan, ...);
+
+/**
+ * @brief プランに従ってパックする（va_list版）
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param plan プラン
+ * @param args 可変引数リスト
+ * @return パック後の次の位置、エラー時はNULL
+ */
+void *cstruct_pack_plan_v(void *dst, size_t dstlen, const cstruct_plan_t *plan, va_list args);
+
+/**
+ * @brief プランに従ってアンパックする
+ *
+ * 引数の渡し方はcstruct_unpack()と同じです。プランのサイズは固定のため、
+ * バッファサイズの確認は最初に一度だけ行い、トークンごとには確認しません。
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param plan プラン
+ * @param ... フィールドに対応する変数へのポインタ
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_plan(const void *src, size_t srclen, const cstruct_plan_t *plan, ...);
+
+/**
+ * @brief プランに従ってアンパックする（va_list版）
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param plan プラン
+ * @param args 可変引数リスト
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_plan_v(const void *src, size_t srclen, const cstruct_plan_t *plan, va_list args);
+
+/**
+ * @brief プランに従って先頭のフィールドだけをアンパックする
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ（処理するフィールドまでの長さがあればよい）
+ * @param plan プラン
+ * @param max_fields アンパックするフィールド数
+ * @param ... 先頭max_fields個のフィールドに対応する変数へのポインタ（NULLで読み飛ばす）
+ * @return 最後にアンパックしたフィールドの次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_plan_n(const void *src, size_t srclen, const cstruct_plan_t *plan, size_t max_fields, ...);
+
+/**
+ * @brief プランに従って先頭のフィールドだけをアンパックする（va_list版）
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param plan プラン
+ * @param max_fields アンパックするフィールド数
+ * @param args 可変引数リスト
+ * @return 最後にアンパックしたフィールドの次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_plan_n_v(const void *src, size_t srclen, const cstruct_plan_t *plan,
+                                    size_t max_fields, va_list args);
+
+/**
+ * @brief 値へのポインタ配列からパックする
+ *
+ * フィールド（パディングを除く）ごとに、C言語上の型の値へのポインタをargs[i]に指定します
+ * （float16とfloat32はfloat、配列は先頭要素、文字列は文字列そのもの）。
+ * 可変引数を使わないため、引数表を一度作って繰り返し使えます。
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param plan プラン
+ * @param args フィールドごとの値へのポインタ
+ * @return パック後の次の位置、エラー時はNULL
+ */
+void *cstruct_pack_a(void *dst, size_t dstlen, const cstruct_plan_t *plan, const void *const *args);
+
+/**
+ * @brief 格納先へのポインタ配列へアンパックする
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param plan プラン
+ * @param args フィールドごとの格納先へのポインタ
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_a(const void *src, size_t srclen, const cstruct_plan_t *plan, void *const *args);
+
+/**
+ * @brief 構造体のメンバからパックする
+ *
+ * プランのフィールド（パディングを除く）を順に、構造体先頭からoffsets[i]バイトの
+ * 位置にあるメンバと対応付けます（offsetof()で求めた値を指定します）。
+ * 文字列フィールドはchar配列のメンバと対応付けます。
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param plan プラン
+ * @param rec 構造体へのポインタ
+ * @param offsets フィールドごとのメンバのオフセット
+ * @return パック後の次の位置、エラー時はNULL
+ */
+void *cstruct_pack_struct(void *dst, size_t dstlen, const cstruct_plan_t *plan, const void *rec, const size_t *offsets);
+
+/**
+ * @brief 構造体のメンバへアンパックする
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param plan プラン
+ * @param rec 構造体へのポインタ
+ * @param offsets フィールドごとのメンバのオフセット
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_struct(const void *src, size_t srclen, const cstruct_plan_t *plan, void *rec, const size_t *offsets);
+
+/**
+ * @brief 連続したレコード列を列ごとの配列へアンパックする
+ *
+ * フィールド（パディングを除く）ごとに1つの配列を用意し、columns[i]に指定します。
+ * n番目のレコードの値は、各配列のn番目の要素に格納されます。
+ * 配列フィールドの場合、1レコード分の要素数を1単位として並びます。
+ *
+ * @param src 入力元バッファ（レコードが隙間なく並んだもの）
+ * @param srclen 入力元バッファのサイズ
+ * @param plan プラン
+ * @param columns フィールドごとの格納先配列
+ * @param nrec レコード数
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_batch(const void *src, size_t srclen, const cstruct_plan_t *plan, void *const *columns, size_t nrec);
+
+/**
+ * @brief 連続したレコード列を構造体の配列へアンパックする
+ *
+ * @param src 入力元バッファ（レコードが隙間なく並んだもの）
+ * @param srclen 入力元バッファのサイズ
+ * @param plan プラン
+ * @param recs 構造体の配列
+ * @param stride 構造体1つ分のバイト数（sizeof）
+ * @param offsets フィールドごとのメンバのオフセット
+ * @param nrec レコード数
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_batch_struct(const void *src, size_t srclen, const cstruct_plan_t *plan,
+                                        void *recs, size_t stride, const size_t *offsets, size_t nrec);
+
+/**
+ * @brief プランを構造体に対応付け、連続したコピーをまとめる
+ *
+ * 次の条件を満たす隣り合うフィールドを1つのコピーにまとめます。
+ * - ワイヤ上のバイト列をそのままホストの値として使える（1バイトの値、またはホストと同じエンディアンの
+ *   整数・float32・float64、およびそれらの配列）
+ * - 構造体上でも前のフィールドの直後に配置されている
+ *
+ * CSTRUCT_BIND_PADDINGを指定すると、前後のフィールドが構造体上でパディングの分だけ離れて
+ * 配置されている場合に、パディングも含めて1つのコピーにまとめます。このとき、アンパックでは
+ * 構造体側の対応する位置にワイヤ上のパディングの内容が書き込まれ、パックでは構造体側の
+ * 対応する位置の内容がパディングとして書き込まれます。
+ *
+ * @param binding 初期化する対応付け
+ * @param runs 処理単位の格納先
+ * @param capacity runsの要素数（プランのトークン数以上あれば必ず足りる）
+ * @param plan プラン（bindingより長く保持すること）
+ * @param offsets フィールドごとのメンバのオフセット
+ * @param flags CSTRUCT_BIND_PADDINGなどのフラグ
+ * @return 成功時はbinding、エラー時はNULL
+ */
+cstruct_binding_t *cstruct_bind(cstruct_binding_t *binding, cstruct_run_t *runs, size_t capacity,
+                                const cstruct_plan_t *plan, const size_t *offsets, unsigned flags);
+
+/**
+ * @brief 対応付けに従って構造体のメンバからパックする
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param binding 対応付け
+ * @param rec 構造体へのポインタ
+ * @return パック後の次の位置、エラー時はNULL
+ */
+void *cstruct_pack_bound(void *dst, size_t dstlen, const cstruct_binding_t *binding, const void *rec);
+
+/**
+ * @brief 対応付けに従って構造体のメンバへアンパックする
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param binding 対応付け
+ * @param rec 構造体へのポインタ
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_bound(const void *src, size_t srclen, const cstruct_binding_t *binding, void *rec);
+
+/**
+ * @brief 対応付けに従って連続したレコード列を構造体の配列へアンパックする
+ *
+ * レコード全体が1つのコピーにまとまり、構造体のサイズとレコードのサイズが等しい場合は、
+ * レコード列全体を1回でコピーします。
+ *
+ * @param src 入力元バッファ（レコードが隙間なく並んだもの）
+ * @param srclen 入力元バッファのサイズ
+ * @param binding 対応付け
+ * @param recs 構造体の配列
+ * @param stride 構造体1つ分のバイト数（sizeof）
+ * @param nrec レコード数
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_bound_batch(const void *src, size_t srclen, const cstruct_binding_t *binding,
+                                       void *recs, size_t stride, size_t nrec);
+
+/**
+ * @brief 配列トークンを異なるC言語上の型の配列へアンパックする
+ *
+ * ワイヤ上の値をxとして、x * scale + offset を格納先の型に変換します。
+ * 整数への変換は最も近い整数に丸め、範囲外の値は最小値・最大値に飽和させます。
+ * 整数どうしでscale = 1、offset = 0の場合は浮動小数点数を経由しません。
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param tok フォーマットトークン（整数・浮動小数点数。128ビット整数は不可）
+ * @param dst 格納先の配列（要素数はtok->count）
+ * @param dtype 格納先の型（整数・CSTRUCT_TYPE_FLOAT32・CSTRUCT_TYPE_FLOAT64）
+ * @param scale スケール
+ * @param offset オフセット
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_convert(const void *src, size_t srclen, const cstruct_token_t *tok,
+                                   void *dst, cstruct_type_t dtype, double scale, double offset);
+
+/**
+ * @brief 異なるC言語上の型の配列から配列トークンをパックする
+ *
+ * cstruct_unpack_convert()の逆変換です。値をvとして、(v - offset) / scale を
+ * ワイヤ上の型に変換します（整数は丸めと飽和を行います）。
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param tok フォーマットトークン（整数・浮動小数点数。128ビット整数は不可）
+ * @param src 値の配列（要素数はtok->count）
+ * @param stype 値の型（整数・CSTRUCT_TYPE_FLOAT32・CSTRUCT_TYPE_FLOAT64）
+ * @param scale スケール（0は不可）
+ * @param offset オフセット
+ * @return パック後の次の位置、エラー時はNULL
+ */
+void *cstruct_pack_convert(void *dst, size_t dstlen, const cstruct_token_t *tok,
+                           const void *src, cstruct_type_t stype, double scale, double offset);
+
+/**
+ * @brief パック済みのデータのバイト順をその場で逆転する
+ *
+ * 複数バイトのフィールド（配列は要素ごと）のバイト順を逆転し、
+ * リトルエンディアンとビッグエンディアンを相互に変換します。
+ * フォーマット文字列のエンディアン指定子は結果に影響しません。
+ * 12ビットの組（H:12）はバイト順の逆転では詰め方を変換できないため、エラーになります。
+ *
+ * @param buf データ
+ * @param len データのバイト数
+ * @param fmt フォーマット文字列
+ * @return 処理したデータの次の位置、エラー時（12ビットの組を含む場合を含む）はNULL（bufは変更されない）
+ */
+void *cstruct_swap_inplace(void *buf, size_t len, const char *fmt);
+
+/**
+ * @brief パック済みのデータのバイト順をプランに従ってその場で逆転する
+ *
+ * 同じサイズの値が続くフィールドはまとめて処理します。
+ *
+ * @param buf データ
+ * @param len データのバイト数
+ * @param plan プラン
+ * @return 処理したデータの次の位置、エラー時（12ビットの組を含む場合を含む）はNULL（bufは変更されない）
+ */
+void *cstruct_swap_inplace_plan(void *buf, size_t len, const cstruct_plan_t *plan);
+
+/**
+ * @brief 連続したレコード列のバイト順をその場で逆転する
+ *
+ * すべてのフィールドが同じサイズの値（例: "HhhHe"）の場合は、レコード列全体を
+ * 1つの配列として処理します。
+ *
+ * @param buf レコード列（レコードが隙間なく並んだもの）
+ * @param len レコード列のバイト数
+ * @param plan プラン
+ * @param nrec レコード数
+ * @return 処理したデータの次の位置、エラー時（12ビットの組を含む場合を含む）はNULL（bufは変更されない）
+ */
+void *cstruct_swap_batch(void *buf, size_t len, const cstruct_plan_t *plan, size_t nrec);
+
+/**
+ * @brief 配列の一部を受け取る関数
+ * @param ctx cstruct_unpack_chunked()・cstruct_pack_chunked_sink()に渡したコンテキスト
+ * @param values アンパックした値（作業領域の先頭）
+ * @param n 値の要素数
+ * @return 続行する場合は0、中断する場合は0以外
+ */
+typedef int (*cstruct_chunk_fn)(void *ctx, const void *values, size_t n);
+
+/**
+ * @brief 配列トークンを少しずつアンパックしてコールバックに渡す
+ *
+ * 配列全体を格納する領域を用意せずに、作業領域の大きさずつアンパックして
+ * 関数に渡します。必要なRAMは作業領域の分だけです。
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param tok フォーマットトークン（整数・浮動小数点数。文字列・パディングは不可）
+ * @param scratch 作業領域（chunk要素分。要素の型はcstruct_unpack_token()の格納先と同じ）
+ * @param chunk 一度に渡す要素数
+ * @param fn 値を受け取る関数
+ * @param ctx fnに渡すコンテキスト
+ * @return アンパック後の次の位置、エラー時または中断した場合はNULL
+ */
+const void *cstruct_unpack_chunked(const void *src, size_t srclen, const cstruct_token_t *tok,
+                                   void *scratch, size_t chunk, cstruct_chunk_fn fn, void *ctx);
+
+/**
+ * @brief 配列を少しずつ受け取る先（cstruct_unpack_a_chunked()用）
+ */
+typedef struct {
+    void *scratch;       /**< 作業領域（chunk要素分） */
+    size_t chunk;        /**< 一度に渡す要素数 */
+    cstruct_chunk_fn fn; /**< 値を受け取る関数 */
+    void *ctx;           /**< fnに渡すコンテキスト */
+} cstruct_chunk_sink_t;
+
+/**
+ * @brief 格納先へのポインタ配列へアンパックし、指定した配列は少しずつコールバックに渡す
+ *
+ * cstruct_unpack_a()と同じくフィールドごとの格納先をargsに指定し、
+ * sinks[i]を指定したフィールドはcstruct_unpack_chunked()と同じく作業領域ずつ関数に渡します
+ * （args[i]は使いません）。ヘッダと大きな配列を含むフレームを、配列全体の領域なしで1回で処理できます。
+ * 文字列・インターリーブした配列にsinkを指定した場合は、何も処理せずにエラーを返します。
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param plan プラン
+ * @param args フィールドごとの格納先へのポインタ（NULLで読み飛ばす）
+ * @param sinks フィールドごとの受け取り先へのポインタ（NULLの場合はargsに格納する）
+ * @return アンパック後の次の位置、エラー時または中断した場合はNULL
+ */
+const void *cstruct_unpack_a_chunked(const void *src, size_t srclen, const cstruct_plan_t *plan,
+                                     void *const *args, const cstruct_chunk_sink_t *const *sinks);
+
+/**
+ * @brief 配列の一部を作る関数
+ * @param ctx cstruct_pack_chunked()に渡したコンテキスト
+ * @param values 値の格納先（作業領域の先頭）
+ * @param n 格納する要素数
+ * @return 続行する場合は0、中断する場合は0以外
+ */
+typedef int (*cstruct_fill_fn)(void *ctx, void *values, size_t n);
+
+/**
+ * @brief 関数から少しずつ値を受け取って配列トークンをパックする
+ *
+ * 配列全体の値を用意せずに、作業領域の大きさずつ関数に値を作らせてパックします。
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param tok フォーマットトークン（整数・浮動小数点数。文字列・パディングは不可）
+ * @param scratch 作業領域（chunk要素分。要素の型はcstruct_pack_token()の値と同じ）
+ * @param chunk 一度に受け取る要素数
+ * @param fn 値を作る関数
+ * @param ctx fnに渡すコンテキスト
+ * @return パック後の次の位置、エラー時または中断した場合はNULL
+ */
+void *cstruct_pack_chunked(void *dst, size_t dstlen, const cstruct_token_t *tok,
+                           void *scratch, size_t chunk, cstruct_fill_fn fn, void *ctx);
+
+/**
+ * @brief 関数から少しずつ値を受け取ってパックし、出力先の関数に渡す
+ *
+ * 出力のバッファも持たずに、パックした結果をchunk要素ずつsinkに渡します。
+ * 必要なRAMは作業領域と出力の作業領域の分だけで、配列の長さによりません。
+ * sinkのvaluesはパック済みのバイト列、nは要素数です（バイト数はn * tok->size）。
+ *
+ * @param tok フォーマットトークン（整数・浮動小数点数。文字列・パディングは不可）
+ * @param scratch 作業領域（chunk要素分）
+ * @param wire 出力の作業領域（chunk * tok->size バイト）
+ * @param chunk 一度に処理する要素数
+ * @param fill 値を作る関数
+ * @param sink パックした結果を受け取る関数
+ * @param ctx fill・sinkに渡すコンテキスト
+ * @return 成功時は0、エラー時または中断した場合は-1
+ */
+int cstruct_pack_chunked_sink(const cstruct_token_t *tok, void *scratch, void *wire, size_t chunk,
+                              cstruct_fill_fn fill, cstruct_chunk_fn sink, void *ctx);
+
 /**
  * @brief 型別パック関数 - パディング
  * @param dst 出力先バッファ
@@ -0,0 +1,297 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file cstruct_hugepage.c
+ * @brief ヒュージページを使うバッファ確保の実装（Linux専用）
+ */
+#if defined(__linux__)
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "cstruct_hugepage.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+/** @brief ヒュージページのサイズが分からない場合の値 */
+#define CSTRUCT_HUGE_DEFAULT_SIZE (2u * 1024u * 1024u)
+
+/**
+ * @brief 透過的ヒュージページのサイズを返す
+ * @return バイト数
+ */
+static size_t cstruct_huge_thp_size(void) {
+    size_t size = CSTRUCT_HUGE_DEFAULT_SIZE;
+    FILE *fp = fopen("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r");
+    if (fp != NULL) {
+        unsigned long v;
+        if (fscanf(fp, "%lu", &v) == 1 && v != 0) {
+            size = (size_t)v;
+        }
+        fclose(fp);
+    }
+    return size;
+}
+
+/**
+ * @brief 透過的ヒュージページがカーネルの設定で有効か調べる
+ * @return 有効（always・madvise）は1、無効（never）は0、分からない場合は-1
+ */
+static int cstruct_huge_thp_enabled(void) {
+    char line[128];
+    int enabled = -1;
+    FILE *fp = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+    if (fp != NULL) {
+        if (fgets(line, sizeof(line), fp) != NULL) {
+            // 選択中の値が[]で囲まれている（例: "always [madvise] never"）
+            if (strstr(line, "[always]") != NULL || strstr(line, "[madvise]") != NULL) {
+                enabled = 1;
+            } else if (strstr(line, "[never]") != NULL) {
+                enabled = 0;
+            }
+        }
+        fclose(fp);
+    }
+    return enabled;
+}
+
+/**
+ * @brief マッピングのうちヒュージページで割り当て済みのバイト数を返す
+ * @param addr マッピング内のアドレス
+ * @param key /proc/self/smapsの項目名（"FilePmdMapped:"など）
+ * @return バイト数、分からない場合は0
+ */
+static size_t cstruct_huge_smaps_bytes(const void *addr, const char *key) {
+    char line[512];
+    size_t keylen = strlen(key);
+    size_t bytes = 0;
+    int found = 0;
+    FILE *fp = fopen("/proc/self/smaps", "r");
+    if (fp == NULL) {
+        return 0;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        unsigned long start, end, kb;
+        // 範囲の行（"start-end perms ..."）から次の範囲の行までが1つのマッピング
+        if (sscanf(line, "%lx-%lx ", &start, &end) == 2) {
+            if (found) {
+                break;
+            }
+            found = (uintptr_t)addr >= start && (uintptr_t)addr < end;
+        } else if (found && strncmp(line, key, keylen) == 0 && sscanf(line + keylen, "%lu", &kb) == 1) {
+            bytes = (size_t)kb * 1024;
+            break;
+        }
+    }
+    fclose(fp);
+    return bytes;
+}
+
+/**
+ * @brief 既定の明示的なヒュージページのサイズを返す
+ * @return バイト数
+ */
+static size_t cstruct_huge_default_size(void) {
+    size_t size = CSTRUCT_HUGE_DEFAULT_SIZE;
+    char line[128];
+    FILE *fp = fopen("/proc/meminfo", "r");
+    if (fp != NULL) {
+        while (fgets(line, sizeof(line), fp) != NULL) {
+            unsigned long kb;
+            if (sscanf(line, "Hugepagesize: %lu kB", &kb) == 1 && kb != 0) {
+                size = (size_t)kb * 1024;
+                break;
+            }
+        }
+        fclose(fp);
+    }
+    return size;
+}
+
+/**
+ * @brief 通常のページのサイズを返す
+ * @return バイト数
+ */
+static size_t cstruct_huge_base_size(void) {
+    long size = sysconf(_SC_PAGESIZE);
+    return size > 0 ? (size_t)size : 4096;
+}
+
+/**
+ * @brief ヒュージページでバッファを確保する
+ *
+ * ヒュージページを使えない場合は通常のページで確保します。
+ * 確保した領域は0で初期化されています。
+ *
+ * @param buf 確保結果の格納先
+ * @param len バイト数
+ * @param flags CSTRUCT_HUGE_NO_EXPLICITなどのフラグ
+ * @return 成功時はbuf、エラー時はNULL
+ */
+cstruct_hugebuf_t *cstruct_huge_alloc(cstruct_hugebuf_t *buf, size_t len, unsigned flags) {
+    int populate = (flags & CSTRUCT_HUGE_POPULATE) ? MAP_POPULATE : 0;
+
+    memset(buf, 0, sizeof(*buf));
+    if (len == 0) {
+        return NULL;
+    }
+
+#if defined(MAP_HUGETLB)
+    // 明示的なヒュージページ（予約済みのプールから割り当てる）
+    if (!(flags & CSTRUCT_HUGE_NO_EXPLICIT)) {
+        size_t page = (flags & CSTRUCT_HUGE_1GB) ? (size_t)1 << 30 : cstruct_huge_default_size();
+        size_t maplen = (len + page - 1) & ~(page - 1);
+        int sizeflag = (flags & CSTRUCT_HUGE_1GB) ? (30 << MAP_HUGE_SHIFT) : 0;
+        void *p = mmap(NULL, maplen, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | sizeflag | populate, -1, 0);
+        if (p != MAP_FAILED) {
+            buf->addr = buf->map = p;
+            buf->len = len;
+            buf->map_len = maplen;
+            buf->page_size = page;
+            buf->kind = CSTRUCT_HUGE_EXPLICIT;
+            return buf;
+        }
+    }
+#endif
+
+    // 透過的ヒュージページはページ境界に揃えた領域に要求する
+    size_t page = cstruct_huge_base_size();
+    size_t align = (flags & CSTRUCT_HUGE_NO_TRANSPARENT) ? page : cstruct_huge_thp_size();
+    size_t body = (len + page - 1) & ~(page - 1);
+    size_t maplen = body + (align > page ? align : 0);
+    uint8_t *p = (uint8_t *)mmap(NULL, maplen, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if ((void *)p == MAP_FAILED) {
+        return NULL;
+    }
+
+    // 揃えた位置の前後の余りを返却する
+    uint8_t *start = (uint8_t *)(((uintptr_t)p + align - 1) & ~(uintptr_t)(align - 1));
+    if (start > p) {
+        munmap(p, (size_t)(start - p));
+    }
+    if (p + maplen > start + body) {
+        munmap(start + body, (size_t)(p + maplen - (start + body)));
+    }
+
+    buf->addr = buf->map = start;
+    buf->len = len;
+    buf->map_len = body;
+    buf->page_size = page;
+    buf->kind = CSTRUCT_HUGE_NONE;
+
+#if defined(MADV_HUGEPAGE)
+    // 無名メモリは設定が有効なら揃えた領域にヒュージページが割り当てられる
+    if (!(flags & CSTRUCT_HUGE_NO_TRANSPARENT) && body >= align && madvise(start, body, MADV_HUGEPAGE) == 0) {
+        int enabled = cstruct_huge_thp_enabled();
+        if (enabled == 1) {
+            buf->page_size = align;
+            buf->kind = CSTRUCT_HUGE_TRANSPARENT;
+        } else if (enabled < 0) {
+            buf->kind = CSTRUCT_HUGE_REQUESTED;
+        }
+    }
+#endif
+#if defined(MADV_POPULATE_WRITE)
+    if (populate) {
+        (void)madvise(start, body, MADV_POPULATE_WRITE);
+    }
+#endif
+
+    return buf;
+}
+
+/**
+ * @brief ファイルを読み取り専用でマッピングする
+ *
+ * 透過的ヒュージページと順次読み出し（MADV_SEQUENTIAL）を要求します。
+ * CSTRUCT_HUGE_NO_EXPLICIT・CSTRUCT_HUGE_1GBは無視されます。
+ *
+ * @param buf マッピング結果の格納先（lenはファイルサイズ）
+ * @param path ファイルパス
+ * @param flags CSTRUCT_HUGE_POPULATEなどのフラグ
+ * @return 成功時はbuf、エラー時（空のファイルを含む）はNULL
+ */
+cstruct_hugebuf_t *cstruct_huge_map_file(cstruct_hugebuf_t *buf, const char *path, unsigned flags) {
+    struct stat st;
+
+    memset(buf, 0, sizeof(*buf));
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t len = (size_t)st.st_size;
+    int populate = (flags & CSTRUCT_HUGE_POPULATE) ? MAP_POPULATE : 0;
+#if defined(MADV_HUGEPAGE) && defined(MADV_POPULATE_READ)
+    // 通常のページで割り当てないよう、ページの割り当ては要求を出した後に行う
+    int populate_later = populate && !(flags & CSTRUCT_HUGE_NO_TRANSPARENT);
+    if (populate_later) {
+        populate = 0;
+    }
+#endif
+    void *p = mmap(NULL, len, PROT_READ, MAP_PRIVATE | populate, fd, 0);
+    close(fd); // マッピングはファイル記述子を閉じても残る
+    if (p == MAP_FAILED) {
+        return NULL;
+    }
+
+    buf->addr = buf->map = p;
+    buf->len = buf->map_len = len;
+    buf->page_size = cstruct_huge_base_size();
+    buf->kind = CSTRUCT_HUGE_NONE;
+
+#if defined(MADV_HUGEPAGE)
+    int requested = !(flags & CSTRUCT_HUGE_NO_TRANSPARENT) && cstruct_huge_thp_enabled() != 0 &&
+                    madvise(p, len, MADV_HUGEPAGE) == 0;
+#if defined(MADV_POPULATE_READ)
+    if (populate_later) {
+        (void)madvise(p, len, MADV_POPULATE_READ);
+    }
+#endif
+    // ファイルのページはファイルシステムとカーネルの構成によってはヒュージページにならないため、
+    // 割り当て済みのヒュージページを確認できた場合だけ透過的ヒュージページとする
+    if (requested) {
+        if (cstruct_huge_smaps_bytes(p, "FilePmdMapped:") > 0) {
+            buf->page_size = cstruct_huge_thp_size();
+            buf->kind = CSTRUCT_HUGE_TRANSPARENT;
+        } else {
+            buf->kind = CSTRUCT_HUGE_REQUESTED;
+        }
+    }
+#endif
+    (void)madvise(p, len, MADV_SEQUENTIAL);
+
+    return buf;
+}
+
+/**
+ * @brief 確保・マッピングした領域を解放する
+ * @param buf 確保結果
+ */
+void cstruct_huge_free(cstruct_hugebuf_t *buf) {
+    if (buf->map != NULL) {
+        munmap(buf->map, buf->map_len);
+    }
+    memset(buf, 0, sizeof(*buf));
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,106 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file cstruct_hugepage.h
+ * @brief ヒュージページを使うバッファ確保のヘッダファイル（Linux専用）
+ *
+ * 数GB規模のレコード列の入力や出力の列を、ヒュージページで確保・マッピングします。
+ * TLBミスを減らし、一括アンパックやcstruct_scan_file()の処理を速くするためのものです。
+ *
+ * - 確保は MAP_HUGETLB（明示的なヒュージページ）→ madvise(MADV_HUGEPAGE)
+ *   （透過的ヒュージページ）→ 通常のページ の順に試す
+ * - 得られたページの種類とサイズは cstruct_hugebuf_t に格納する
+ * - ファイルのマッピングは読み取り専用で、madvise(MADV_HUGEPAGE)が使える場合のみ
+ *   ヒュージページになる（ファイルシステムとカーネルの設定による）
+ * - madvise(MADV_HUGEPAGE)が成功しても透過的ヒュージページが使われるとは限らないため、
+ *   /sys/kernel/mm/transparent_hugepage/enabled と /proc/self/smaps で確かめてから
+ *   CSTRUCT_HUGE_TRANSPARENTとし、確かめられない場合はCSTRUCT_HUGE_REQUESTEDとする
+ */
+#ifndef CSTRUCT_HUGEPAGE_H
+#define CSTRUCT_HUGEPAGE_H
+
+#if defined(__linux__)
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief 明示的なヒュージページ（MAP_HUGETLB）を試さない */
+#define CSTRUCT_HUGE_NO_EXPLICIT   0x01
+/** @brief 透過的ヒュージページ（MADV_HUGEPAGE）を試さない */
+#define CSTRUCT_HUGE_NO_TRANSPARENT 0x02
+/** @brief 明示的なヒュージページに1GiBのページを要求する */
+#define CSTRUCT_HUGE_1GB           0x04
+/** @brief マッピング時にページを割り当てる（MAP_POPULATE） */
+#define CSTRUCT_HUGE_POPULATE      0x08
+
+/**
+ * @brief 得られたページの種類
+ */
+typedef enum {
+    CSTRUCT_HUGE_NONE,        /**< 通常のページ */
+    CSTRUCT_HUGE_TRANSPARENT, /**< 透過的ヒュージページ（カーネルの設定または割り当てを確認した） */
+    CSTRUCT_HUGE_EXPLICIT,    /**< 明示的なヒュージページ */
+    CSTRUCT_HUGE_REQUESTED    /**< 透過的ヒュージページを要求したが、使われるかは確認できない */
+} cstruct_huge_kind_t;
+
+/**
+ * @brief ヒュージページで確保したバッファ
+ */
+typedef struct {
+    void *addr;               /**< 先頭アドレス */
+    size_t len;               /**< 要求したバイト数 */
+    void *map;                /**< マッピングの先頭（解放用） */
+    size_t map_len;           /**< マッピングのバイト数（解放用） */
+    size_t page_size;         /**< 得られたページのサイズ */
+    cstruct_huge_kind_t kind; /**< 得られたページの種類 */
+} cstruct_hugebuf_t;
+
+/**
+ * @brief ヒュージページでバッファを確保する
+ *
+ * ヒュージページを使えない場合は通常のページで確保します。
+ * 確保した領域は0で初期化されています。
+ *
+ * @param buf 確保結果の格納先
+ * @param len バイト数
+ * @param flags CSTRUCT_HUGE_NO_EXPLICITなどのフラグ
+ * @return 成功時はbuf、エラー時はNULL
+ */
+cstruct_hugebuf_t *cstruct_huge_alloc(cstruct_hugebuf_t *buf, size_t len, unsigned flags);
+
+/**
+ * @brief ファイルを読み取り専用でマッピングする
+ *
+ * 透過的ヒュージページと順次読み出し（MADV_SEQUENTIAL）を要求します。
+ * CSTRUCT_HUGE_NO_EXPLICIT・CSTRUCT_HUGE_1GBは無視されます。
+ * ファイルのページがヒュージページで割り当てられたことを確認できた場合（CSTRUCT_HUGE_POPULATEで
+ * 割り当て済みの場合に限る）のみCSTRUCT_HUGE_TRANSPARENT、それ以外はCSTRUCT_HUGE_REQUESTEDとなります。
+ *
+ * @param buf マッピング結果の格納先（lenはファイルサイズ）
+ * @param path ファイルパス
+ * @param flags CSTRUCT_HUGE_POPULATEなどのフラグ
+ * @return 成功時はbuf、エラー時（空のファイルを含む）はNULL
+ */
+cstruct_hugebuf_t *cstruct_huge_map_file(cstruct_hugebuf_t *buf, const char *path, unsigned flags);
+
+/**
+ * @brief 確保・マッピングした領域を解放する
+ * @param buf 確保結果
+ */
+void cstruct_huge_free(cstruct_hugebuf_t *buf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __linux__ */
+
+#endif /* CSTRUCT_HUGEPAGE_H */
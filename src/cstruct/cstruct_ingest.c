@@ -0,0 +1,503 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file cstruct_ingest.c
+ * @brief UDP/TCPパケット受信サーバの実装（Linux専用）
+ */
+#if defined(__linux__)
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "cstruct_ingest.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+/** @brief epoll_wait()で一度に受け取るイベント数 */
+#define CSTRUCT_INGEST_EVENTS 16
+
+/**
+ * @brief 登録済みソケットの種類
+ */
+typedef enum {
+    CSTRUCT_INGEST_UDP,    /**< UDPソケット */
+    CSTRUCT_INGEST_LISTEN, /**< TCPの待ち受けソケット */
+    CSTRUCT_INGEST_CONN    /**< TCPの接続済みソケット */
+} cstruct_ingest_kind_t;
+
+/**
+ * @brief 登録済みソケット
+ */
+typedef struct cstruct_ingest_sock {
+    int fd;                           /**< ファイルディスクリプタ */
+    cstruct_ingest_kind_t kind;       /**< ソケットの種類 */
+    struct cstruct_ingest_sock *next; /**< リストの次の要素 */
+    size_t fill;                      /**< partialに溜まっているバイト数 */
+    uint8_t partial[];                /**< read境界をまたいだフレーム（TCPのみ） */
+} cstruct_ingest_sock_t;
+
+/**
+ * @brief フレームを振り分け先に渡す
+ *
+ * 構造体へのデコードに失敗した場合は、handlerを呼ばずにフレームを破棄します。
+ *
+ * @param ing サーバ
+ * @param route 振り分け先
+ * @param frame フレームの先頭
+ */
+static void cstruct_ingest_deliver(cstruct_ingest_t *ing, const cstruct_ingest_route_t *route, const uint8_t *frame) {
+    void *record = NULL;
+
+    if (route->offsets != NULL) {
+        if (cstruct_unpack_struct(frame, route->plan->size, route->plan, route->record, route->offsets) == NULL) {
+            // デコードできなかったレコードは渡さずに破棄する
+            ing->stats.undecoded++;
+            return;
+        }
+        record = route->record;
+    }
+    route->handler(route->ctx, frame, route->plan->size, record);
+    ing->stats.frames++;
+}
+
+/**
+ * @brief ソケットを作成してepollに登録する
+ * @param ing サーバ
+ * @param fd ファイルディスクリプタ
+ * @param kind ソケットの種類
+ * @return 登録したソケット、エラー時はNULL（fdは閉じられる）
+ */
+static cstruct_ingest_sock_t *cstruct_ingest_add(cstruct_ingest_t *ing, int fd, cstruct_ingest_kind_t kind) {
+    size_t extra = (kind == CSTRUCT_INGEST_CONN) ? ing->max_frame : 0;
+    cstruct_ingest_sock_t *s = (cstruct_ingest_sock_t *)malloc(sizeof(*s) + extra);
+    struct epoll_event ev;
+
+    if (s == NULL) {
+        close(fd);
+        return NULL;
+    }
+    s->fd = fd;
+    s->kind = kind;
+    s->fill = 0;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = s;
+    if (epoll_ctl(ing->epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        close(fd);
+        free(s);
+        return NULL;
+    }
+
+    s->next = (cstruct_ingest_sock_t *)ing->sockets;
+    ing->sockets = s;
+    return s;
+}
+
+/**
+ * @brief ソケットをepollから外して閉じる
+ * @param ing サーバ
+ * @param s ソケット
+ */
+static void cstruct_ingest_remove(cstruct_ingest_t *ing, cstruct_ingest_sock_t *s) {
+    cstruct_ingest_sock_t **link = (cstruct_ingest_sock_t **)&ing->sockets;
+
+    while (*link != NULL && *link != s) {
+        link = &(*link)->next;
+    }
+    if (*link != NULL) {
+        *link = s->next;
+    }
+
+    epoll_ctl(ing->epfd, EPOLL_CTL_DEL, s->fd, NULL);
+    close(s->fd);
+    if (s->kind == CSTRUCT_INGEST_CONN) {
+        ing->stats.closed++;
+    }
+    free(s);
+}
+
+/**
+ * @brief 待ち受けソケットを開く
+ * @param ing サーバ
+ * @param type SOCK_DGRAMまたはSOCK_STREAM
+ * @param addr 待ち受けるIPv4アドレス
+ * @param port 待ち受けるポート番号
+ * @return 待ち受けたポート番号、エラー時は負の値
+ */
+static int cstruct_ingest_listen(cstruct_ingest_t *ing, int type, const char *addr, uint16_t port) {
+    struct sockaddr_in sin;
+    socklen_t sinlen = sizeof(sin);
+    int one = 1;
+    int fd;
+
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_port = htons(port);
+    if (addr == NULL) {
+        sin.sin_addr.s_addr = htonl(INADDR_ANY);
+    } else if (inet_pton(AF_INET, addr, &sin.sin_addr) != 1) {
+        return -1;
+    }
+
+    fd = socket(AF_INET, type | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd, (struct sockaddr *)&sin, sizeof(sin)) != 0 ||
+        (type == SOCK_STREAM && listen(fd, SOMAXCONN) != 0) ||
+        getsockname(fd, (struct sockaddr *)&sin, &sinlen) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    if (cstruct_ingest_add(ing, fd, (type == SOCK_STREAM) ? CSTRUCT_INGEST_LISTEN : CSTRUCT_INGEST_UDP) == NULL) {
+        return -1;
+    }
+    return ntohs(sin.sin_port);
+}
+
+/**
+ * @brief UDPソケットに届いたデータグラムをまとめて受信して振り分ける
+ * @param ing サーバ
+ * @param s ソケット
+ */
+static void cstruct_ingest_read_udp(cstruct_ingest_t *ing, cstruct_ingest_sock_t *s) {
+    struct mmsghdr *msgs = (struct mmsghdr *)ing->msgs;
+
+    for (;;) {
+        int n = recvmmsg(s->fd, msgs, (unsigned int)ing->batch, MSG_DONTWAIT, NULL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return; // EAGAINを含め、次のイベントまで待つ
+        }
+        ing->stats.batches++;
+
+        for (int i = 0; i < n; i++) {
+            const uint8_t *slot = ing->rxbuf + (size_t)i * ing->slot_size;
+            size_t len = msgs[i].msg_len;
+            long used;
+
+            ing->stats.datagrams++;
+            ing->stats.bytes += len;
+            if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                // 受信バッファに収まらなかったデータグラム
+                ing->stats.truncated++;
+                continue;
+            }
+
+            used = cstruct_ingest_dispatch(ing, slot, len);
+            if (used >= 0 && (size_t)used < len) {
+                ing->stats.truncated++;
+            }
+        }
+
+        if ((size_t)n < ing->batch) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief TCP接続を受け付ける
+ * @param ing サーバ
+ * @param s 待ち受けソケット
+ */
+static void cstruct_ingest_accept(cstruct_ingest_t *ing, cstruct_ingest_sock_t *s) {
+    for (;;) {
+        int fd = accept4(s->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        if (cstruct_ingest_add(ing, fd, CSTRUCT_INGEST_CONN) != NULL) {
+            ing->stats.accepted++;
+        }
+    }
+}
+
+/**
+ * @brief TCP接続に届いたデータを受信して振り分ける
+ * @param ing サーバ
+ * @param s 接続済みソケット
+ */
+static void cstruct_ingest_read_tcp(cstruct_ingest_t *ing, cstruct_ingest_sock_t *s) {
+    size_t cap = ing->batch * ing->slot_size;
+
+    for (;;) {
+        ssize_t n = recv(s->fd, ing->rxbuf, cap, MSG_DONTWAIT);
+        const uint8_t *p = ing->rxbuf;
+        const uint8_t *end;
+
+        if (n == 0) {
+            cstruct_ingest_remove(ing, s);
+            return;
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                cstruct_ingest_remove(ing, s);
+            }
+            return;
+        }
+        ing->stats.batches++;
+        ing->stats.bytes += (uint64_t)n;
+        end = p + n;
+
+        // 前回のread境界をまたいだフレームを先に完成させる
+        while (s->fill > 0 && p < end) {
+            const cstruct_ingest_route_t *route = NULL;
+            size_t need;
+            size_t take;
+
+            if (s->fill > ing->type_offset) {
+                route = ing->dispatch[s->partial[ing->type_offset]];
+                need = route->plan->size - s->fill;
+            } else {
+                need = ing->type_offset + 1 - s->fill;
+            }
+
+            take = ((size_t)(end - p) < need) ? (size_t)(end - p) : need;
+            memcpy(s->partial + s->fill, p, take);
+            s->fill += take;
+            p += take;
+
+            if (s->fill > ing->type_offset) {
+                route = ing->dispatch[s->partial[ing->type_offset]];
+                if (route == NULL) {
+                    // ストリームの同期が取れなくなったため接続を閉じる
+                    ing->stats.unknown++;
+                    cstruct_ingest_remove(ing, s);
+                    return;
+                }
+                if (s->fill == route->plan->size) {
+                    cstruct_ingest_deliver(ing, route, s->partial);
+                    s->fill = 0;
+                }
+            }
+        }
+
+        if (p < end) {
+            long used = cstruct_ingest_dispatch(ing, p, (size_t)(end - p));
+            if (used < 0) {
+                cstruct_ingest_remove(ing, s);
+                return;
+            }
+            p += used;
+
+            // 末尾の不完全なフレームは次のreadまで保持する
+            s->fill = (size_t)(end - p);
+            memcpy(s->partial, p, s->fill);
+        }
+    }
+}
+
+/**
+ * @brief 振り分け先のプランを構造体へデコードできるか判定する
+ * @param route 振り分け先
+ * @return デコードできる場合（デコードしない場合を含む）は1
+ */
+static int cstruct_ingest_decodable(const cstruct_ingest_route_t *route) {
+    if (route->offsets == NULL) {
+        return 1;
+    }
+    if (route->record == NULL) {
+        return 0;
+    }
+    for (size_t i = 0; i < route->plan->count; i++) {
+        // インターリーブした配列は構造体のメンバに対応付けられない
+        if (route->plan->tokens[i].channels != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief パケット受信サーバを初期化する
+ *
+ * 構造体へデコードできないプラン（インターリーブした配列を含むものなど）に
+ * offsetsを設定した振り分け先はエラーになります。
+ *
+ * @param ing 初期化するサーバ
+ * @param routes 振り分け先の配列（サーバより長く保持すること）
+ * @param nroutes 振り分け先の数
+ * @param type_offset フレーム内の種別バイトの位置
+ * @param batch recvmmsg()で一度に受信するデータグラム数
+ * @param slot_size データグラム1つ分の受信バッファサイズ
+ * @return 成功時はing、エラー時はNULL
+ */
+cstruct_ingest_t *cstruct_ingest_init(cstruct_ingest_t *ing, const cstruct_ingest_route_t *routes, size_t nroutes,
+                                      size_t type_offset, size_t batch, size_t slot_size) {
+    struct mmsghdr *msgs;
+    struct iovec *iovs;
+
+    memset(ing, 0, sizeof(*ing));
+    ing->epfd = -1;
+    ing->type_offset = type_offset;
+    ing->max_frame = type_offset + 1;
+
+    for (size_t i = 0; i < nroutes; i++) {
+        const cstruct_ingest_route_t *route = &routes[i];
+        if (route->plan == NULL || route->handler == NULL || route->plan->size <= type_offset ||
+            !cstruct_ingest_decodable(route) || ing->dispatch[route->type] != NULL) {
+            return NULL;
+        }
+        ing->dispatch[route->type] = route;
+        if (route->plan->size > ing->max_frame) {
+            ing->max_frame = route->plan->size;
+        }
+    }
+    if (batch == 0 || slot_size < ing->max_frame) {
+        return NULL;
+    }
+
+    ing->batch = batch;
+    ing->slot_size = slot_size;
+    ing->rxbuf = (uint8_t *)malloc(batch * slot_size);
+    ing->msgs = calloc(batch, sizeof(struct mmsghdr));
+    ing->iovs = calloc(batch, sizeof(struct iovec));
+    ing->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (ing->rxbuf == NULL || ing->msgs == NULL || ing->iovs == NULL || ing->epfd < 0) {
+        cstruct_ingest_close(ing);
+        return NULL;
+    }
+
+    // recvmmsg()用のヘッダは受信バッファのスロットを指したまま使い回す
+    msgs = (struct mmsghdr *)ing->msgs;
+    iovs = (struct iovec *)ing->iovs;
+    for (size_t i = 0; i < batch; i++) {
+        iovs[i].iov_base = ing->rxbuf + i * slot_size;
+        iovs[i].iov_len = slot_size;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    return ing;
+}
+
+/**
+ * @brief UDPソケットを開いて受信を開始する
+ *
+ * @param ing サーバ
+ * @param addr 待ち受けるIPv4アドレス（例: "127.0.0.1"、NULLなら全アドレス）
+ * @param port 待ち受けるポート番号（0なら自動割り当て）
+ * @return 待ち受けたポート番号、エラー時は負の値
+ */
+int cstruct_ingest_listen_udp(cstruct_ingest_t *ing, const char *addr, uint16_t port) {
+    return cstruct_ingest_listen(ing, SOCK_DGRAM, addr, port);
+}
+
+/**
+ * @brief TCPソケットを開いて接続の受け付けを開始する
+ *
+ * @param ing サーバ
+ * @param addr 待ち受けるIPv4アドレス（例: "127.0.0.1"、NULLなら全アドレス）
+ * @param port 待ち受けるポート番号（0なら自動割り当て）
+ * @return 待ち受けたポート番号、エラー時は負の値
+ */
+int cstruct_ingest_listen_tcp(cstruct_ingest_t *ing, const char *addr, uint16_t port) {
+    return cstruct_ingest_listen(ing, SOCK_STREAM, addr, port);
+}
+
+/**
+ * @brief 受信可能なソケットを待ち、届いたフレームを振り分ける
+ *
+ * @param ing サーバ
+ * @param timeout_ms 待ち時間（ミリ秒、-1で無期限）
+ * @return 振り分けたフレーム数、エラー時は負の値
+ */
+int cstruct_ingest_poll(cstruct_ingest_t *ing, int timeout_ms) {
+    struct epoll_event events[CSTRUCT_INGEST_EVENTS];
+    uint64_t before = ing->stats.frames;
+    int n = epoll_wait(ing->epfd, events, CSTRUCT_INGEST_EVENTS, timeout_ms);
+
+    if (n < 0) {
+        return (errno == EINTR) ? 0 : -1;
+    }
+
+    for (int i = 0; i < n; i++) {
+        cstruct_ingest_sock_t *s = (cstruct_ingest_sock_t *)events[i].data.ptr;
+        switch (s->kind) {
+            case CSTRUCT_INGEST_UDP:
+                cstruct_ingest_read_udp(ing, s);
+                break;
+            case CSTRUCT_INGEST_LISTEN:
+                cstruct_ingest_accept(ing, s);
+                break;
+            case CSTRUCT_INGEST_CONN:
+                cstruct_ingest_read_tcp(ing, s);
+                break;
+        }
+    }
+
+    return (int)(ing->stats.frames - before);
+}
+
+/**
+ * @brief バッファ上のフレーム列を振り分ける
+ *
+ * @param ing サーバ
+ * @param buf フレーム列
+ * @param len フレーム列のサイズ
+ * @return 振り分けに使ったバイト数（末尾の不完全なフレームは含まない）、
+ *         種別が不明なフレームがあった場合は負の値
+ */
+long cstruct_ingest_dispatch(cstruct_ingest_t *ing, const uint8_t *buf, size_t len) {
+    size_t pos = 0;
+
+    while (len - pos > ing->type_offset) {
+        const cstruct_ingest_route_t *route = ing->dispatch[buf[pos + ing->type_offset]];
+        if (route == NULL) {
+            ing->stats.unknown++;
+            return -1;
+        }
+        if (len - pos < route->plan->size) {
+            break;
+        }
+        cstruct_ingest_deliver(ing, route, buf + pos);
+        pos += route->plan->size;
+    }
+
+    return (long)pos;
+}
+
+/**
+ * @brief パケット受信サーバを閉じる
+ * @param ing サーバ
+ */
+void cstruct_ingest_close(cstruct_ingest_t *ing) {
+    while (ing->sockets != NULL) {
+        cstruct_ingest_remove(ing, (cstruct_ingest_sock_t *)ing->sockets);
+    }
+    if (ing->epfd >= 0) {
+        close(ing->epfd);
+        ing->epfd = -1;
+    }
+    free(ing->rxbuf);
+    free(ing->msgs);
+    free(ing->iovs);
+    ing->rxbuf = NULL;
+    ing->msgs = NULL;
+    ing->iovs = NULL;
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,157 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file cstruct_ingest.h
+ * @brief UDP/TCPパケット受信サーバのヘッダファイル（Linux専用）
+ *
+ * ノンブロッキングソケットとepollでデバイスからのパケットを受信し、
+ * フレーム内の種別バイトでコンパイル済みフォーマットを引き当ててデコードします。
+ *
+ * - UDPはrecvmmsg()で複数のデータグラムをまとめて受信する
+ * - 1つのデータグラム（TCPの場合はストリーム）に複数のフレームを連結できる
+ * - フレームは受信バッファ上から直接デコードされる
+ *   （TCPでread境界をまたいだフレームのみ、接続ごとのバッファに集めてからデコードする）
+ * - フレーム長は種別ごとのプランのサイズ（cstruct_plan_t::size）で決まる
+ */
+#ifndef CSTRUCT_INGEST_H
+#define CSTRUCT_INGEST_H
+
+#if defined(__linux__)
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cstruct.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief フレーム受信時に呼ばれる関数
+ * @param ctx ルートに設定したコンテキスト
+ * @param frame フレームの先頭（受信バッファ上）
+ * @param len フレームのサイズ
+ * @param record デコード済みのレコード（ルートにoffsetsを設定していない場合はNULL）
+ */
+typedef void (*cstruct_ingest_handler_fn)(void *ctx, const uint8_t *frame, size_t len, void *record);
+
+/**
+ * @brief フレーム種別ごとの振り分け先
+ */
+typedef struct {
+    uint8_t type;                      /**< 種別バイトの値 */
+    const cstruct_plan_t *plan;        /**< フレームのプラン */
+    const size_t *offsets;             /**< 構造体メンバのオフセット（デコード不要ならNULL） */
+    void *record;                      /**< デコード先の構造体 */
+    cstruct_ingest_handler_fn handler; /**< 受信時に呼ばれる関数 */
+    void *ctx;                         /**< handlerに渡すコンテキスト */
+} cstruct_ingest_route_t;
+
+/**
+ * @brief 受信統計
+ */
+typedef struct {
+    uint64_t datagrams;   /**< 受信したUDPデータグラム数 */
+    uint64_t bytes;       /**< 受信したバイト数 */
+    uint64_t frames;      /**< 振り分けたフレーム数 */
+    uint64_t batches;     /**< recvmmsg()/recv()の呼び出し回数 */
+    uint64_t unknown;     /**< 種別が不明なため破棄したフレーム数 */
+    uint64_t truncated;   /**< 途中で切れていたため破棄したフレーム数 */
+    uint64_t undecoded;   /**< 構造体へデコードできなかったため破棄したフレーム数 */
+    uint64_t accepted;    /**< 受け付けたTCP接続数 */
+    uint64_t closed;      /**< 閉じたTCP接続数 */
+} cstruct_ingest_stats_t;
+
+/**
+ * @brief パケット受信サーバ
+ */
+typedef struct {
+    int epfd;                                     /**< epollのファイルディスクリプタ */
+    const cstruct_ingest_route_t *dispatch[256];  /**< 種別バイトから振り分け先への表 */
+    size_t type_offset;                           /**< フレーム内の種別バイトの位置 */
+    size_t max_frame;                             /**< 最大フレームサイズ */
+    size_t batch;                                 /**< recvmmsg()で一度に受信するデータグラム数 */
+    size_t slot_size;                             /**< データグラム1つ分の受信バッファサイズ */
+    uint8_t *rxbuf;                               /**< 受信バッファ（batch × slot_size） */
+    void *msgs;                                   /**< recvmmsg()用のヘッダ配列 */
+    void *iovs;                                   /**< recvmmsg()用のiovec配列 */
+    void *sockets;                                /**< 登録済みソケットのリスト */
+    cstruct_ingest_stats_t stats;                 /**< 受信統計 */
+} cstruct_ingest_t;
+
+/**
+ * @brief パケット受信サーバを初期化する
+ *
+ * 構造体へデコードできないプラン（インターリーブした配列を含むものなど）に
+ * offsetsを設定した振り分け先はエラーになります。
+ *
+ * @param ing 初期化するサーバ
+ * @param routes 振り分け先の配列（サーバより長く保持すること）
+ * @param nroutes 振り分け先の数
+ * @param type_offset フレーム内の種別バイトの位置
+ * @param batch recvmmsg()で一度に受信するデータグラム数
+ * @param slot_size データグラム1つ分の受信バッファサイズ
+ * @return 成功時はing、エラー時はNULL
+ */
+cstruct_ingest_t *cstruct_ingest_init(cstruct_ingest_t *ing, const cstruct_ingest_route_t *routes, size_t nroutes,
+                                      size_t type_offset, size_t batch, size_t slot_size);
+
+/**
+ * @brief UDPソケットを開いて受信を開始する
+ *
+ * @param ing サーバ
+ * @param addr 待ち受けるIPv4アドレス（例: "127.0.0.1"、NULLなら全アドレス）
+ * @param port 待ち受けるポート番号（0なら自動割り当て）
+ * @return 待ち受けたポート番号、エラー時は負の値
+ */
+int cstruct_ingest_listen_udp(cstruct_ingest_t *ing, const char *addr, uint16_t port);
+
+/**
+ * @brief TCPソケットを開いて接続の受け付けを開始する
+ *
+ * @param ing サーバ
+ * @param addr 待ち受けるIPv4アドレス（例: "127.0.0.1"、NULLなら全アドレス）
+ * @param port 待ち受けるポート番号（0なら自動割り当て）
+ * @return 待ち受けたポート番号、エラー時は負の値
+ */
+int cstruct_ingest_listen_tcp(cstruct_ingest_t *ing, const char *addr, uint16_t port);
+
+/**
+ * @brief 受信可能なソケットを待ち、届いたフレームを振り分ける
+ *
+ * @param ing サーバ
+ * @param timeout_ms 待ち時間（ミリ秒、-1で無期限）
+ * @return 振り分けたフレーム数、エラー時は負の値
+ */
+int cstruct_ingest_poll(cstruct_ingest_t *ing, int timeout_ms);
+
+/**
+ * @brief バッファ上のフレーム列を振り分ける
+ *
+ * 受信処理と同じ振り分けを、任意のバッファに対して行います。
+ *
+ * @param ing サーバ
+ * @param buf フレーム列
+ * @param len フレーム列のサイズ
+ * @return 振り分けに使ったバイト数（末尾の不完全なフレームは含まない）、
+ *         種別が不明なフレームがあった場合は負の値
+ */
+long cstruct_ingest_dispatch(cstruct_ingest_t *ing, const uint8_t *buf, size_t len);
+
+/**
+ * @brief パケット受信サーバを閉じる
+ * @param ing サーバ
+ */
+void cstruct_ingest_close(cstruct_ingest_t *ing);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __linux__ */
+
+#endif /* CSTRUCT_INGEST_H */
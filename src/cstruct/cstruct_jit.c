@@ -0,0 +1,512 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file cstruct_jit.c
+ * @brief コンパイル済みフォーマットのネイティブコード生成の実装（Linux専用）
+ *
+ * # 生成する関数
+ * - アンパック: const void *fn(const void *src, void *rec)
+ * - パック:     void *fn(void *dst, const void *rec)
+ *
+ * どちらも入口で第1引数（ワイヤ上のバッファ）をr8、第2引数（構造体）をr9へ移し、
+ * 以後はr8/r9からの固定オフセットでロード・ストアします。戻り値はr8 + プランのサイズです。
+ */
+#if defined(__linux__)
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "cstruct_jit.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+/** @brief 非エンディアン変換のコピーでrep movsbを使い始めるバイト数 */
+#define CSTRUCT_JIT_REP_THRESHOLD 128
+
+/**
+ * @brief 構造体上でフィールドが占めるバイト数を求める
+ * @param tok フォーマットトークン
+ * @return バイト数
+ */
+static size_t cstruct_jit_member_size(const cstruct_token_t *tok) {
+    return tok->size * tok->count;
+}
+
+#if defined(__x86_64__)
+/** @brief レジスタ番号 */
+enum {
+    CSTRUCT_JIT_RAX = 0,
+    CSTRUCT_JIT_RCX = 1,
+    CSTRUCT_JIT_RDX = 2,
+    CSTRUCT_JIT_RSI = 6,
+    CSTRUCT_JIT_RDI = 7
+};
+
+/** @brief ベースレジスタ（REX.Bと組み合わせてr8/r9を表す） */
+enum {
+    CSTRUCT_JIT_R8 = 0, /**< ワイヤ上のバッファ */
+    CSTRUCT_JIT_R9 = 1  /**< 構造体 */
+};
+
+/**
+ * @brief 機械語の書き込み先
+ *
+ * bufがNULLの場合は書き込まずにバイト数だけを数えます。
+ */
+typedef struct {
+    uint8_t *buf; /**< 書き込み先 */
+    size_t len;   /**< 書き込んだバイト数 */
+} cstruct_jit_emit_t;
+
+/**
+ * @brief 1バイト書き込む
+ * @param e 書き込み先
+ * @param b 値
+ */
+static void cstruct_jit_byte(cstruct_jit_emit_t *e, uint8_t b) {
+    if (e->buf != NULL) {
+        e->buf[e->len] = b;
+    }
+    e->len++;
+}
+
+/**
+ * @brief 32ビット値をリトルエンディアンで書き込む
+ * @param e 書き込み先
+ * @param v 値
+ */
+static void cstruct_jit_u32(cstruct_jit_emit_t *e, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        cstruct_jit_byte(e, (uint8_t)(v >> (8 * i)));
+    }
+}
+
+/**
+ * @brief [base + disp32]を参照する命令を書き込む
+ *
+ * @param e 書き込み先
+ * @param size オペランドサイズ（2なら0x66プレフィックス、8ならREX.W）
+ * @param op オペコード
+ * @param oplen オペコードのバイト数
+ * @param reg レジスタ番号
+ * @param base ベースレジスタ（r8/r9）
+ * @param disp 変位
+ */
+static void cstruct_jit_mem(cstruct_jit_emit_t *e, size_t size, const uint8_t *op, size_t oplen, int reg, int base,
+                            uint32_t disp) {
+    if (size == 2) {
+        cstruct_jit_byte(e, 0x66);
+    }
+    cstruct_jit_byte(e, (uint8_t)(0x41 | (size == 8 ? 0x08 : 0)));
+    for (size_t i = 0; i < oplen; i++) {
+        cstruct_jit_byte(e, op[i]);
+    }
+    cstruct_jit_byte(e, (uint8_t)(0x80 | (reg << 3) | base));
+    cstruct_jit_u32(e, disp);
+}
+
+/**
+ * @brief mov reg, [base + disp]
+ */
+static void cstruct_jit_load(cstruct_jit_emit_t *e, size_t size, int reg, int base, uint32_t disp) {
+    static const uint8_t op8[] = { 0x8A };
+    static const uint8_t op[] = { 0x8B };
+    cstruct_jit_mem(e, size, (size == 1) ? op8 : op, 1, reg, base, disp);
+}
+
+/**
+ * @brief mov [base + disp], reg
+ */
+static void cstruct_jit_store(cstruct_jit_emit_t *e, size_t size, int reg, int base, uint32_t disp) {
+    static const uint8_t op8[] = { 0x88 };
+    static const uint8_t op[] = { 0x89 };
+    cstruct_jit_mem(e, size, (size == 1) ? op8 : op, 1, reg, base, disp);
+}
+
+/**
+ * @brief バイト順を逆転しながら mov reg, [base + disp]
+ */
+static void cstruct_jit_load_swap(cstruct_jit_emit_t *e, size_t size, int reg, int base, uint32_t disp, int movbe) {
+    static const uint8_t op_movbe[] = { 0x0F, 0x38, 0xF0 };
+
+    if (movbe) {
+        cstruct_jit_mem(e, size, op_movbe, sizeof(op_movbe), reg, base, disp);
+        return;
+    }
+    cstruct_jit_load(e, size, reg, base, disp);
+    if (size == 2) {
+        // rol reg16, 8
+        cstruct_jit_byte(e, 0x66);
+        cstruct_jit_byte(e, 0xC1);
+        cstruct_jit_byte(e, (uint8_t)(0xC0 | reg));
+        cstruct_jit_byte(e, 8);
+    } else {
+        // bswap reg
+        if (size == 8) {
+            cstruct_jit_byte(e, 0x48);
+        }
+        cstruct_jit_byte(e, 0x0F);
+        cstruct_jit_byte(e, (uint8_t)(0xC8 | reg));
+    }
+}
+
+/**
+ * @brief lea reg, [base + disp]
+ */
+static void cstruct_jit_lea(cstruct_jit_emit_t *e, int reg, int base, uint32_t disp) {
+    static const uint8_t op[] = { 0x8D };
+    cstruct_jit_mem(e, 8, op, 1, reg, base, disp);
+}
+
+/**
+ * @brief バイト順を変えずにブロックをコピーする
+ * @param e 書き込み先
+ * @param from コピー元のベースレジスタ
+ * @param from_off コピー元のオフセット
+ * @param to コピー先のベースレジスタ
+ * @param to_off コピー先のオフセット
+ * @param n バイト数
+ */
+static void cstruct_jit_copy(cstruct_jit_emit_t *e, int from, uint32_t from_off, int to, uint32_t to_off, size_t n) {
+    if (n > CSTRUCT_JIT_REP_THRESHOLD) {
+        // lea rsi, [from + off]; lea rdi, [to + off]; mov ecx, n; rep movsb
+        cstruct_jit_lea(e, CSTRUCT_JIT_RSI, from, from_off);
+        cstruct_jit_lea(e, CSTRUCT_JIT_RDI, to, to_off);
+        cstruct_jit_byte(e, (uint8_t)(0xB8 | CSTRUCT_JIT_RCX));
+        cstruct_jit_u32(e, (uint32_t)n);
+        cstruct_jit_byte(e, 0xF3);
+        cstruct_jit_byte(e, 0xA4);
+        return;
+    }
+    while (n > 0) {
+        size_t chunk = (n >= 8) ? 8 : (n >= 4) ? 4 : (n >= 2) ? 2 : 1;
+        cstruct_jit_load(e, chunk, CSTRUCT_JIT_RAX, from, from_off);
+        cstruct_jit_store(e, chunk, CSTRUCT_JIT_RAX, to, to_off);
+        from_off += (uint32_t)chunk;
+        to_off += (uint32_t)chunk;
+        n -= chunk;
+    }
+}
+
+/**
+ * @brief パックまたはアンパックの関数を生成する
+ *
+ * @param e 書き込み先
+ * @param plan プラン
+ * @param offsets フィールドごとのメンバのオフセット
+ * @param pack パック関数なら1
+ * @param movbe movbe命令を使う場合は1
+ */
+static void cstruct_jit_generate(cstruct_jit_emit_t *e, const cstruct_plan_t *plan, const size_t *offsets, int pack,
+                                 int movbe) {
+    uint32_t wire = 0;
+    size_t field = 0;
+
+    // mov r8, rdi; mov r9, rsi
+    cstruct_jit_byte(e, 0x49);
+    cstruct_jit_byte(e, 0x89);
+    cstruct_jit_byte(e, 0xF8);
+    cstruct_jit_byte(e, 0x49);
+    cstruct_jit_byte(e, 0x89);
+    cstruct_jit_byte(e, 0xF1);
+
+    for (size_t i = 0; i < plan->count; i++) {
+        const cstruct_token_t *tok = &plan->tokens[i];
+        size_t n = cstruct_jit_member_size(tok);
+
+        if (tok->type == CSTRUCT_TYPE_PADDING) {
+            wire += (uint32_t)n;
+            continue;
+        }
+
+        uint32_t rec = (uint32_t)offsets[field++];
+        int from = pack ? CSTRUCT_JIT_R9 : CSTRUCT_JIT_R8;
+        int to = pack ? CSTRUCT_JIT_R8 : CSTRUCT_JIT_R9;
+        uint32_t from_off = pack ? rec : wire;
+        uint32_t to_off = pack ? wire : rec;
+
+        if (tok->endian == CSTRUCT_ENDIAN_LITTLE || tok->size == 1) {
+            cstruct_jit_copy(e, from, from_off, to, to_off, n);
+        } else {
+            for (size_t k = 0; k < tok->count; k++) {
+                uint32_t fo = from_off + (uint32_t)(k * tok->size);
+                uint32_t to2 = to_off + (uint32_t)(k * tok->size);
+                if (tok->size == 16) {
+                    // 上位・下位の8バイトをそれぞれ逆転して入れ替える
+                    cstruct_jit_load_swap(e, 8, CSTRUCT_JIT_RAX, from, fo, movbe);
+                    cstruct_jit_load_swap(e, 8, CSTRUCT_JIT_RDX, from, fo + 8, movbe);
+                    cstruct_jit_store(e, 8, CSTRUCT_JIT_RAX, to, to2 + 8);
+                    cstruct_jit_store(e, 8, CSTRUCT_JIT_RDX, to, to2);
+                } else {
+                    cstruct_jit_load_swap(e, tok->size, CSTRUCT_JIT_RAX, from, fo, movbe);
+                    cstruct_jit_store(e, tok->size, CSTRUCT_JIT_RAX, to, to2);
+                }
+            }
+        }
+        wire += (uint32_t)n;
+    }
+
+    // lea rax, [r8 + size]; ret
+    cstruct_jit_lea(e, CSTRUCT_JIT_RAX, CSTRUCT_JIT_R8, wire);
+    cstruct_jit_byte(e, 0xC3);
+}
+
+/**
+ * @brief プランをネイティブコードに変換できるか確認する
+ * @param plan プラン
+ * @param offsets フィールドごとのメンバのオフセット
+ * @return 変換できる場合は1
+ */
+static int cstruct_jit_supported(const cstruct_plan_t *plan, const size_t *offsets) {
+    size_t field = 0;
+
+    // 変位は符号付き32ビットに収める
+    if (plan->size > INT32_MAX) {
+        return 0;
+    }
+    for (size_t i = 0; i < plan->count; i++) {
+        const cstruct_token_t *tok = &plan->tokens[i];
+        if (tok->type == CSTRUCT_TYPE_FLOAT16 || tok->type == CSTRUCT_TYPE_STRING) {
+            return 0;
+        }
+        if (tok->type == CSTRUCT_TYPE_PADDING) {
+            continue;
+        }
+        if (tok->size != cstruct_token_elem_size(tok)) {
+            return 0; // 幅を縮めた整数（"i:24"など）
+        }
+        if (tok->channels != 0) {
+            return 0; // インターリーブした配列（"2*256h"など）
+        }
+        size_t off = offsets[field++];
+        if (off > INT32_MAX || cstruct_jit_member_size(tok) > INT32_MAX - off) {
+            return 0;
+        }
+    }
+    return 1;
+}
+#endif /* __x86_64__ */
+
+/**
+ * @brief プランをネイティブコードに変換する
+ *
+ * ネイティブコードを生成できない場合もjitを返し、以後はインタプリタで処理します。
+ * ネイティブコードが生成されたかどうかはjit->codeで確認できます。
+ *
+ * @param jit 初期化する変換結果
+ * @param plan プラン（jitより長く保持すること）
+ * @param offsets フィールドごとのメンバのオフセット（jitより長く保持すること）
+ * @param flags CSTRUCT_JIT_DISABLEなどのフラグ
+ * @return 成功時はjit、エラー時はNULL
+ */
+cstruct_jit_t *cstruct_jit_compile(cstruct_jit_t *jit, const cstruct_plan_t *plan, const size_t *offsets, unsigned flags) {
+    if (jit == NULL || plan == NULL || (offsets == NULL && plan->fields > 0)) {
+        return NULL;
+    }
+    jit->plan = plan;
+    jit->offsets = offsets;
+    jit->code = NULL;
+    jit->code_size = 0;
+    jit->pack_fn = NULL;
+    jit->unpack_fn = NULL;
+
+#if defined(__x86_64__) && !defined(CSTRUCT_NO_JIT)
+    if ((flags & CSTRUCT_JIT_DISABLE) || !cstruct_jit_supported(plan, offsets)) {
+        return jit;
+    }
+
+    unsigned eax, ebx, ecx, edx;
+    int movbe = 0;
+    if (!(flags & CSTRUCT_JIT_NO_MOVBE) && __get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        movbe = (ecx & bit_MOVBE) != 0;
+    }
+
+    // 1回目はサイズだけを数え、2回目で書き込む
+    cstruct_jit_emit_t e = { NULL, 0 };
+    cstruct_jit_generate(&e, plan, offsets, 0, movbe);
+    size_t pack_at = (e.len + 15) & ~(size_t)15;
+    e.len = pack_at;
+    cstruct_jit_generate(&e, plan, offsets, 1, movbe);
+
+    size_t code_size = e.len;
+    void *code = mmap(NULL, code_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (code == MAP_FAILED) {
+        return jit;
+    }
+    // 隙間はint3で埋める
+    memset(code, 0xCC, code_size);
+    e.buf = (uint8_t *)code;
+    e.len = 0;
+    cstruct_jit_generate(&e, plan, offsets, 0, movbe);
+    e.len = pack_at;
+    cstruct_jit_generate(&e, plan, offsets, 1, movbe);
+
+    // 書き込みを禁止してから実行可能にする
+    if (mprotect(code, code_size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(code, code_size);
+        return jit;
+    }
+
+    union {
+        void *p;
+        const void *(*fn)(const void *, void *);
+    } unpack_fn = { code };
+    union {
+        void *p;
+        void *(*fn)(void *, const void *);
+    } pack_fn = { (uint8_t *)code + pack_at };
+
+    jit->code = code;
+    jit->code_size = code_size;
+    jit->unpack_fn = unpack_fn.fn;
+    jit->pack_fn = pack_fn.fn;
+
+    if ((flags & CSTRUCT_JIT_VERIFY) && cstruct_jit_verify(jit, 64) != 0) {
+        cstruct_jit_free(jit);
+    }
+#else
+    (void)flags;
+#endif
+    return jit;
+}
+
+/**
+ * @brief 構造体のメンバからパックする
+ *
+ * @param jit 変換結果
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param rec 構造体へのポインタ
+ * @return パック後の次の位置、エラー時はNULL
+ */
+void *cstruct_jit_pack(const cstruct_jit_t *jit, void *dst, size_t dstlen, const void *rec) {
+    if (dstlen < jit->plan->size) {
+        return NULL;
+    }
+    if (jit->pack_fn != NULL) {
+        return jit->pack_fn(dst, rec);
+    }
+    return cstruct_pack_struct(dst, dstlen, jit->plan, rec, jit->offsets);
+}
+
+/**
+ * @brief 構造体のメンバへアンパックする
+ *
+ * @param jit 変換結果
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param rec 構造体へのポインタ
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_jit_unpack(const cstruct_jit_t *jit, const void *src, size_t srclen, void *rec) {
+    if (srclen < jit->plan->size) {
+        return NULL;
+    }
+    if (jit->unpack_fn != NULL) {
+        return jit->unpack_fn(src, rec);
+    }
+    return cstruct_unpack_struct(src, srclen, jit->plan, rec, jit->offsets);
+}
+
+/**
+ * @brief 生成したコードの結果をインタプリタと照合する
+ *
+ * 疑似乱数のバイト列をアンパックした構造体と、その構造体をパックしたバイト列を比較します。
+ *
+ * @param jit 変換結果
+ * @param rounds 照合する回数
+ * @return 一致した場合（インタプリタで処理する場合を含む）は0、不一致またはエラー時は-1
+ */
+int cstruct_jit_verify(const cstruct_jit_t *jit, unsigned rounds) {
+    const cstruct_plan_t *plan = jit->plan;
+    size_t rec_size = 0;
+    size_t field = 0;
+    uint32_t seed = 0x9E3779B9u;
+    uint8_t *mem;
+    int result = 0;
+
+    if (jit->code == NULL) {
+        return 0;
+    }
+
+    // 構造体はフィールドが占める範囲の最大値までを比較する
+    for (size_t i = 0; i < plan->count; i++) {
+        const cstruct_token_t *tok = &plan->tokens[i];
+        if (tok->type == CSTRUCT_TYPE_PADDING) {
+            continue;
+        }
+        size_t end = jit->offsets[field++] + cstruct_jit_member_size(tok);
+        if (end > rec_size) {
+            rec_size = end;
+        }
+    }
+
+    // src、ネイティブ・インタプリタそれぞれの構造体とパック結果
+    size_t wire = plan->size;
+    mem = (uint8_t *)malloc(wire * 3 + rec_size * 2 + 1);
+    if (mem == NULL) {
+        return -1;
+    }
+    uint8_t *src = mem;
+    uint8_t *rec_a = src + wire;
+    uint8_t *rec_b = rec_a + rec_size;
+    uint8_t *out_a = rec_b + rec_size;
+    uint8_t *out_b = out_a + wire;
+
+    for (unsigned r = 0; r < rounds && result == 0; r++) {
+        for (size_t i = 0; i < wire; i++) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            src[i] = (uint8_t)seed;
+        }
+        memset(rec_a, 0xA5, rec_size);
+        memset(rec_b, 0xA5, rec_size);
+        memset(out_a, 0x5A, wire);
+        memset(out_b, 0x5A, wire);
+
+        if (jit->unpack_fn(src, rec_a) != src + wire ||
+            cstruct_unpack_struct(src, wire, plan, rec_b, jit->offsets) != src + wire ||
+            memcmp(rec_a, rec_b, rec_size) != 0) {
+            result = -1;
+            break;
+        }
+        if (jit->pack_fn(out_a, rec_a) != out_a + wire ||
+            cstruct_pack_struct(out_b, wire, plan, rec_a, jit->offsets) != out_b + wire ||
+            memcmp(out_a, out_b, wire) != 0) {
+            result = -1;
+        }
+    }
+
+    free(mem);
+    return result;
+}
+
+/**
+ * @brief 生成したコードを解放する
+ *
+ * 以後はインタプリタで処理します。
+ *
+ * @param jit 変換結果
+ */
+void cstruct_jit_free(cstruct_jit_t *jit) {
+    if (jit->code != NULL) {
+        munmap(jit->code, jit->code_size);
+    }
+    jit->code = NULL;
+    jit->code_size = 0;
+    jit->pack_fn = NULL;
+    jit->unpack_fn = NULL;
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,113 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file cstruct_jit.h
+ * @brief コンパイル済みフォーマットのネイティブコード生成のヘッダファイル（Linux専用）
+ *
+ * 構造体に対応付けたプランを、x86-64の機械語に変換して実行します。
+ * 生成されるコードはループや分岐を含まない、ロード・ストアとbswap（またはmovbe）の並びです。
+ *
+ * - 対応する型は整数・float32・float64・パディング（float16と文字列を含むプランは変換しない）
+ * - x86-64以外の環境、変換できないプラン、CSTRUCT_JIT_DISABLEを指定した場合は
+ *   cstruct_pack_struct()/cstruct_unpack_struct()で処理する
+ * - コードはmmap()した領域に書き込み、実行可能にする前に書き込みを禁止する
+ */
+#ifndef CSTRUCT_JIT_H
+#define CSTRUCT_JIT_H
+
+#if defined(__linux__)
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cstruct.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief ネイティブコードを生成せず、常にインタプリタで処理する */
+#define CSTRUCT_JIT_DISABLE  0x01
+/** @brief movbe命令を使わない */
+#define CSTRUCT_JIT_NO_MOVBE 0x02
+/** @brief 生成後にインタプリタとの照合を行い、不一致ならインタプリタに戻す */
+#define CSTRUCT_JIT_VERIFY   0x04
+
+/**
+ * @brief 構造体に対応付けたプランのネイティブコード
+ */
+typedef struct {
+    const cstruct_plan_t *plan;                        /**< プラン */
+    const size_t *offsets;                             /**< フィールドごとのメンバのオフセット */
+    void *code;                                        /**< 生成したコード（インタプリタで処理する場合はNULL） */
+    size_t code_size;                                  /**< 生成したコードの領域のサイズ */
+    void *(*pack_fn)(void *dst, const void *rec);      /**< 生成したパック関数 */
+    const void *(*unpack_fn)(const void *src, void *rec); /**< 生成したアンパック関数 */
+} cstruct_jit_t;
+
+/**
+ * @brief プランをネイティブコードに変換する
+ *
+ * ネイティブコードを生成できない場合もjitを返し、以後はインタプリタで処理します。
+ * ネイティブコードが生成されたかどうかはjit->codeで確認できます。
+ *
+ * @param jit 初期化する変換結果
+ * @param plan プラン（jitより長く保持すること）
+ * @param offsets フィールドごとのメンバのオフセット（jitより長く保持すること）
+ * @param flags CSTRUCT_JIT_DISABLEなどのフラグ
+ * @return 成功時はjit、エラー時はNULL
+ */
+cstruct_jit_t *cstruct_jit_compile(cstruct_jit_t *jit, const cstruct_plan_t *plan, const size_t *offsets, unsigned flags);
+
+/**
+ * @brief 構造体のメンバからパックする
+ *
+ * @param jit 変換結果
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param rec 構造体へのポインタ
+ * @return パック後の次の位置、エラー時はNULL
+ */
+void *cstruct_jit_pack(const cstruct_jit_t *jit, void *dst, size_t dstlen, const void *rec);
+
+/**
+ * @brief 構造体のメンバへアンパックする
+ *
+ * @param jit 変換結果
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param rec 構造体へのポインタ
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_jit_unpack(const cstruct_jit_t *jit, const void *src, size_t srclen, void *rec);
+
+/**
+ * @brief 生成したコードの結果をインタプリタと照合する
+ *
+ * 疑似乱数のバイト列をアンパックした構造体と、その構造体をパックしたバイト列を比較します。
+ *
+ * @param jit 変換結果
+ * @param rounds 照合する回数
+ * @return 一致した場合（インタプリタで処理する場合を含む）は0、不一致またはエラー時は-1
+ */
+int cstruct_jit_verify(const cstruct_jit_t *jit, unsigned rounds);
+
+/**
+ * @brief 生成したコードを解放する
+ *
+ * 以後はインタプリタで処理します。
+ *
+ * @param jit 変換結果
+ */
+void cstruct_jit_free(cstruct_jit_t *jit);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __linux__ */
+
+#endif /* CSTRUCT_JIT_H */
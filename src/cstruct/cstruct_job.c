@@ -0,0 +1,138 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file cstruct_job.c
+ * @brief 分割して進めるパック・アンパックの実装
+ */
+#include "cstruct_job.h"
+#include <string.h>
+
+/**
+ * @brief パックのジョブを作る
+ *
+ * @param job 初期化するジョブ
+ * @param dst 出力先バッファ（ジョブの完了まで保持すること）
+ * @param dstlen 出力先バッファのサイズ
+ * @param plan プラン
+ * @param values フィールドごとの値へのポインタ（cstruct_pack_a()と同じ）
+ * @return 成功時はjob、エラー時（バッファ不足）はNULL
+ */
+cstruct_job_t *cstruct_job_pack(cstruct_job_t *job, void *dst, size_t dstlen,
+                                const cstruct_plan_t *plan, const void *const *values) {
+    if (dstlen < plan->size) {
+        return NULL;
+    }
+    memset(job, 0, sizeof(*job));
+    job->plan = plan;
+    job->dst = (uint8_t *)dst;
+    job->values = values;
+    return job;
+}
+
+/**
+ * @brief アンパックのジョブを作る
+ *
+ * @param job 初期化するジョブ
+ * @param src 入力元バッファ（ジョブの完了まで保持すること）
+ * @param srclen 入力元バッファのサイズ
+ * @param plan プラン
+ * @param targets フィールドごとの格納先へのポインタ（cstruct_unpack_a()と同じ）
+ * @return 成功時はjob、エラー時（バッファ不足）はNULL
+ */
+cstruct_job_t *cstruct_job_unpack(cstruct_job_t *job, const void *src, size_t srclen,
+                                  const cstruct_plan_t *plan, void *const *targets) {
+    if (srclen < plan->size) {
+        return NULL;
+    }
+    memset(job, 0, sizeof(*job));
+    job->plan = plan;
+    job->src = (const uint8_t *)src;
+    job->targets = targets;
+    return job;
+}
+
+/**
+ * @brief ジョブを進める
+ *
+ * @param job ジョブ
+ * @param max_bytes 今回処理するワイヤ上の最大バイト数
+ * @return 完了した場合は0、残りがある場合は1
+ */
+int cstruct_job_step(cstruct_job_t *job, size_t max_bytes) {
+    const cstruct_plan_t *plan = job->plan;
+    size_t budget = max_bytes;
+    int progressed = 0;
+
+    while (job->token < plan->count) {
+        const cstruct_token_t *tok = &plan->tokens[job->token];
+        cstruct_token_t part = *tok;
+        size_t left = tok->count - job->element;
+
+        // 文字列とパディングは1つの単位として扱う
+        // インターリーブした配列はフレーム（チャネルごとに1要素ずつの組）単位で分ける
+        if (tok->type != CSTRUCT_TYPE_STRING && tok->type != CSTRUCT_TYPE_PADDING) {
+            size_t unit = (tok->channels != 0) ? tok->channels : 1;
+            size_t fit = budget / (tok->size * unit);
+            if (fit == 0 && !progressed) {
+                fit = 1; // 少なくとも1要素（1フレーム）は処理する
+            }
+            part.count = (left / unit < fit ? left / unit : fit) * unit;
+        } else if (tok->size * tok->count > budget && progressed) {
+            part.count = 0;
+        }
+        if (part.count == 0) {
+            break;
+        }
+
+        size_t bytes = part.size * part.count;
+        if (tok->type == CSTRUCT_TYPE_PADDING) {
+            if (job->dst != NULL) {
+                cstruct_pack_token(job->dst + job->offset, &part, NULL);
+            }
+        } else if (tok->channels != 0) {
+            size_t first = job->element / tok->channels;
+            size_t frames = part.count / tok->channels;
+            if (job->dst != NULL) {
+                cstruct_pack_interleaved(job->dst + job->offset, tok, (const void *const *)job->values[job->field],
+                                         first, frames);
+            } else if (job->targets[job->field] != NULL) {
+                cstruct_unpack_interleaved(job->src + job->offset, tok, (void *const *)job->targets[job->field],
+                                           first, frames);
+            }
+        } else {
+            size_t skip = job->element * cstruct_token_elem_size(tok);
+            if (job->dst != NULL) {
+                const uint8_t *value = (const uint8_t *)job->values[job->field];
+                cstruct_pack_token(job->dst + job->offset, &part, value + skip);
+            } else {
+                uint8_t *value = (uint8_t *)job->targets[job->field];
+                cstruct_unpack_token(job->src + job->offset, &part, value == NULL ? NULL : value + skip);
+            }
+        }
+
+        job->offset += bytes;
+        job->element += part.count;
+        budget = bytes < budget ? budget - bytes : 0;
+        progressed = 1;
+        if (job->element == tok->count || tok->type == CSTRUCT_TYPE_STRING || tok->type == CSTRUCT_TYPE_PADDING) {
+            job->field += (tok->type != CSTRUCT_TYPE_PADDING);
+            job->token++;
+            job->element = 0;
+        }
+    }
+
+    return cstruct_job_done(job) ? 0 : 1;
+}
+
+/**
+ * @brief ジョブが完了したか調べる
+ * @param job ジョブ
+ * @return 完了した場合は1
+ */
+int cstruct_job_done(const cstruct_job_t *job) {
+    return job->token >= job->plan->count;
+}
@@ -0,0 +1,91 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file cstruct_job.h
+ * @brief 分割して進めるパック・アンパックのヘッダファイル
+ *
+ * 大きなフレームのパック・アンパックを複数回の呼び出しに分けて進めます。
+ * loop()の1回あたりの処理時間を抑え、他の処理の締め切りに間に合わせるためのものです。
+ *
+ * - ジョブはプランと、フィールドごとの値（格納先）へのポインタ配列から作る
+ * - cstruct_job_step()は、ワイヤ上で最大max_bytesバイト分を処理して戻る
+ * - 配列は要素の境界で区切る（文字列は区切らない）
+ * - 1回の呼び出しで少なくとも1要素は処理する
+ */
+#ifndef CSTRUCT_JOB_H
+#define CSTRUCT_JOB_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cstruct.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 分割して進めるパック・アンパック
+ */
+typedef struct {
+    const cstruct_plan_t *plan; /**< プラン */
+    uint8_t *dst;               /**< パックの出力先（アンパックではNULL） */
+    const uint8_t *src;         /**< アンパックの入力元（パックではNULL） */
+    const void *const *values;  /**< パックする値へのポインタ */
+    void *const *targets;       /**< アンパックの格納先へのポインタ */
+    size_t token;               /**< 処理中のトークン */
+    size_t element;             /**< 処理中のトークンで処理済みの要素数 */
+    size_t field;               /**< 処理中のフィールド（パディングを除く） */
+    size_t offset;              /**< 処理済みのバイト数 */
+} cstruct_job_t;
+
+/**
+ * @brief パックのジョブを作る
+ *
+ * @param job 初期化するジョブ
+ * @param dst 出力先バッファ（ジョブの完了まで保持すること）
+ * @param dstlen 出力先バッファのサイズ
+ * @param plan プラン
+ * @param values フィールドごとの値へのポインタ（cstruct_pack_a()と同じ）
+ * @return 成功時はjob、エラー時（バッファ不足）はNULL
+ */
+cstruct_job_t *cstruct_job_pack(cstruct_job_t *job, void *dst, size_t dstlen,
+                                const cstruct_plan_t *plan, const void *const *values);
+
+/**
+ * @brief アンパックのジョブを作る
+ *
+ * @param job 初期化するジョブ
+ * @param src 入力元バッファ（ジョブの完了まで保持すること）
+ * @param srclen 入力元バッファのサイズ
+ * @param plan プラン
+ * @param targets フィールドごとの格納先へのポインタ（cstruct_unpack_a()と同じ）
+ * @return 成功時はjob、エラー時（バッファ不足）はNULL
+ */
+cstruct_job_t *cstruct_job_unpack(cstruct_job_t *job, const void *src, size_t srclen,
+                                  const cstruct_plan_t *plan, void *const *targets);
+
+/**
+ * @brief ジョブを進める
+ *
+ * @param job ジョブ
+ * @param max_bytes 今回処理するワイヤ上の最大バイト数
+ * @return 完了した場合は0、残りがある場合は1
+ */
+int cstruct_job_step(cstruct_job_t *job, size_t max_bytes);
+
+/**
+ * @brief ジョブが完了したか調べる
+ * @param job ジョブ
+ * @return 完了した場合は1
+ */
+int cstruct_job_done(const cstruct_job_t *job);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CSTRUCT_JOB_H */
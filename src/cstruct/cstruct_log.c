@@ -0,0 +1,346 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file cstruct_log.c
+ * @brief ページ境界に揃えたレコードロガーの実装
+ */
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "cstruct_log.h"
+#include "cstruct.h"
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief 現在のページを索引に登録する
+ *
+ * 索引が満杯になった場合は1つおきにエントリを間引き、登録するページの間隔を2倍にします。
+ * これにより、索引の大きさを固定したままログ全体を粗く覆い続けます。
+ *
+ * @param log ロガー
+ * @param timestamp レコードのタイムスタンプ
+ * @param offset レコードのページ内オフセット
+ */
+static void cstruct_log_index_add(cstruct_log_t *log, uint32_t timestamp, size_t offset) {
+    if (log->index == NULL || log->index_cap == 0) {
+        return;
+    }
+
+    if (log->index_len == log->index_cap) {
+        size_t kept = 0;
+        for (size_t i = 0; i < log->index_len; i += 2) {
+            log->index[kept++] = log->index[i];
+        }
+        log->index_len = kept;
+        if (log->index_stride <= UINT32_MAX / 2) {
+            log->index_stride *= 2;
+        }
+    }
+
+    // 前回登録したページから間隔が空いていなければ登録しない
+    if (log->index_len > 0 &&
+        log->page_no - log->index[log->index_len - 1].page_no < log->index_stride) {
+        return;
+    }
+    if (log->index_len == log->index_cap) {
+        return;
+    }
+
+    cstruct_log_index_t *entry = &log->index[log->index_len++];
+    entry->page_no = log->page_no;
+    entry->timestamp = timestamp;
+    entry->offset = (uint32_t)offset;
+}
+
+/**
+ * @brief 埋まったページをデバイスに書き出し、はみ出した分をバッファ先頭へ移動する
+ * @param log ロガー
+ * @return 成功時は0、エラー時は負の値
+ */
+static int cstruct_log_drain(cstruct_log_t *log) {
+    while (log->fill >= log->page_size) {
+        if (log->dev.write(log->dev.ctx, log->page_no, log->buf, log->page_size) != 0) {
+            return -1;
+        }
+        log->fill -= log->page_size;
+        memmove(log->buf, log->buf + log->page_size, log->fill);
+        // パディング（xN）は書き込みを行わないため、未使用部分を0に戻しておく
+        memset(log->buf + log->fill, 0, log->bufsize - log->fill);
+        log->page_no++;
+        log->page_indexed = 0;
+    }
+    return 0;
+}
+
+/**
+ * @brief ページロガーを初期化する
+ *
+ * @param log 初期化するロガー
+ * @param dev 書き込み先デバイス
+ * @param buf ページバッファ（ページサイズ + 最大レコードサイズ以上）
+ * @param bufsize ページバッファのサイズ
+ * @param page_size ページサイズ
+ * @param index 索引用の配列（不要ならNULL）
+ * @param index_cap 索引用の配列の要素数
+ * @return 成功時はlog、エラー時はNULL
+ */
+cstruct_log_t *cstruct_log_init(cstruct_log_t *log, const cstruct_blockdev_t *dev,
+                                void *buf, size_t bufsize, size_t page_size,
+                                cstruct_log_index_t *index, size_t index_cap) {
+    if (log == NULL || dev == NULL || dev->write == NULL || buf == NULL ||
+        page_size == 0 || bufsize < page_size) {
+        return NULL;
+    }
+
+    log->dev = *dev;
+    log->buf = (uint8_t *)buf;
+    log->bufsize = bufsize;
+    log->page_size = page_size;
+    log->fill = 0;
+    log->page_no = 0;
+    log->page_indexed = 0;
+    log->index = index;
+    log->index_cap = (index != NULL) ? index_cap : 0;
+    log->index_len = 0;
+    log->index_stride = 1;
+
+    memset(log->buf, 0, bufsize);
+    return log;
+}
+
+/**
+ * @brief レコードをパックしてログに追加する（va_list版）
+ *
+ * @param log ロガー
+ * @param timestamp レコードのタイムスタンプ
+ * @param fmt フォーマット文字列
+ * @param args 可変引数リスト
+ * @return 成功時は0、エラー時は負の値
+ */
+int cstruct_log_append_v(cstruct_log_t *log, uint32_t timestamp, const char *fmt, va_list args) {
+    // 前回の書き出しに失敗したページが残っていれば先に書き出す
+    if (cstruct_log_drain(log) != 0) {
+        return -1;
+    }
+
+    size_t start = log->fill;
+    uint8_t *end = (uint8_t *)cstruct_pack_v(log->buf + start, log->bufsize - start, fmt, args);
+    if (end == NULL) {
+        // バッファのはみ出し領域に収まらないレコード、またはフォーマットエラー
+        // 途中まで書き込んだ分を消し、未使用部分を0に戻しておく
+        memset(log->buf + start, 0, log->bufsize - start);
+        return -1;
+    }
+
+    if (!log->page_indexed) {
+        cstruct_log_index_add(log, timestamp, start);
+        log->page_indexed = 1;
+    }
+    log->fill = (size_t)(end - log->buf);
+
+    return cstruct_log_drain(log);
+}
+
+/**
+ * @brief レコードをパックしてログに追加する
+ *
+ * @param log ロガー
+ * @param timestamp レコードのタイムスタンプ
+ * @param fmt フォーマット文字列
+ * @param ... フォーマット文字列に対応する値
+ * @return 成功時は0、エラー時は負の値
+ */
+int cstruct_log_append(cstruct_log_t *log, uint32_t timestamp, const char *fmt, ...) {
+    int result;
+    va_list args;
+    va_start(args, fmt);
+    result = cstruct_log_append_v(log, timestamp, fmt, args);
+    va_end(args);
+    return result;
+}
+
+/**
+ * @brief 書きかけのページをデバイスに書き出す
+ *
+ * @param log ロガー
+ * @return 成功時は0、エラー時は負の値
+ */
+int cstruct_log_flush(cstruct_log_t *log) {
+    if (cstruct_log_drain(log) != 0) {
+        return -1;
+    }
+    if (log->fill == 0) {
+        return 0;
+    }
+    // 未使用部分は0で埋められているため、ページ全体をそのまま書き出す
+    return (log->dev.write(log->dev.ctx, log->page_no, log->buf, log->page_size) == 0) ? 0 : -1;
+}
+
+/**
+ * @brief ログ先頭からの書き込み済みバイト数を取得する
+ * @param log ロガー
+ * @return 書き込み済みバイト数（バッファ上の未書き出し分を含む）
+ */
+uint64_t cstruct_log_tell(const cstruct_log_t *log) {
+    return (uint64_t)log->page_no * log->page_size + log->fill;
+}
+
+/**
+ * @brief 指定した時刻以前で最も新しい索引位置を求める
+ *
+ * @param log ロガー
+ * @param timestamp 探索する時刻
+ * @param page_no 見つかったページ番号の格納先
+ * @param offset 見つかったレコードのページ内オフセットの格納先
+ * @return 成功時は0、該当する位置がない場合は負の値
+ */
+int cstruct_log_seek(const cstruct_log_t *log, uint32_t timestamp, uint32_t *page_no, size_t *offset) {
+    size_t lo = 0;
+    size_t hi = log->index_len;
+
+    // timestamp以下となる最後のエントリを二分探索する
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (log->index[mid].timestamp <= timestamp) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == 0) {
+        return -1;
+    }
+
+    *page_no = log->index[lo - 1].page_no;
+    *offset = log->index[lo - 1].offset;
+    return 0;
+}
+
+/**
+ * @brief ログの読み出し位置を初期化する
+ *
+ * @param reader 初期化する読み出し位置
+ * @param dev 読み出し元デバイス
+ * @param page ページ読み出し用バッファ（ページサイズ）
+ * @param page_size ページサイズ
+ * @param page_no 読み出しを開始するページ番号
+ * @param offset 読み出しを開始するページ内オフセット
+ * @return 成功時はreader、エラー時はNULL
+ */
+cstruct_log_reader_t *cstruct_log_reader_init(cstruct_log_reader_t *reader, const cstruct_blockdev_t *dev,
+                                              void *page, size_t page_size, uint32_t page_no, size_t offset) {
+    if (reader == NULL || dev == NULL || dev->read == NULL || page == NULL ||
+        page_size == 0 || offset >= page_size) {
+        return NULL;
+    }
+
+    reader->dev = dev;
+    reader->page = (uint8_t *)page;
+    reader->page_size = page_size;
+    reader->page_no = page_no;
+    reader->offset = offset;
+    reader->loaded = 0;
+    return reader;
+}
+
+/**
+ * @brief ログからレコード1件分のバイト列を読み出す
+ *
+ * @param reader 読み出し位置
+ * @param dst 読み出し先バッファ
+ * @param size レコードサイズ（cstruct_calcsize()の値）
+ * @return 成功時は0、エラー時は負の値
+ */
+int cstruct_log_read(cstruct_log_reader_t *reader, void *dst, size_t size) {
+    uint8_t *out = (uint8_t *)dst;
+
+    while (size > 0) {
+        if (!reader->loaded) {
+            if (reader->dev->read(reader->dev->ctx, reader->page_no, reader->page, reader->page_size) != 0) {
+                return -1;
+            }
+            reader->loaded = 1;
+        }
+
+        size_t avail = reader->page_size - reader->offset;
+        size_t n = (size < avail) ? size : avail;
+        memcpy(out, reader->page + reader->offset, n);
+        out += n;
+        size -= n;
+        reader->offset += n;
+
+        // ページ末尾に達したら次のページへ進む
+        if (reader->offset == reader->page_size) {
+            reader->page_no++;
+            reader->offset = 0;
+            reader->loaded = 0;
+        }
+    }
+    return 0;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+/**
+ * @brief ファイルのブロックデバイス - ページ書き込み
+ */
+static int cstruct_blockdev_file_write(void *ctx, uint32_t page_no, const void *page, size_t page_size) {
+    int fd = (int)(intptr_t)ctx;
+    off_t pos = (off_t)page_no * (off_t)page_size;
+    ssize_t n = pwrite(fd, page, page_size, pos);
+    return (n >= 0 && (size_t)n == page_size) ? 0 : -1;
+}
+
+/**
+ * @brief ファイルのブロックデバイス - ページ読み出し
+ *
+ * ファイル末尾を越えた部分は0で埋めます。
+ */
+static int cstruct_blockdev_file_read(void *ctx, uint32_t page_no, void *page, size_t page_size) {
+    int fd = (int)(intptr_t)ctx;
+    off_t pos = (off_t)page_no * (off_t)page_size;
+    ssize_t n = pread(fd, page, page_size, pos);
+    if (n < 0) {
+        return -1;
+    }
+    memset((uint8_t *)page + n, 0, page_size - (size_t)n);
+    return 0;
+}
+
+/**
+ * @brief ファイルをブロックデバイスとして開く
+ *
+ * @param dev 初期化するブロックデバイス
+ * @param path ファイルパス
+ * @return 成功時はdev、エラー時はNULL
+ */
+cstruct_blockdev_t *cstruct_blockdev_file_open(cstruct_blockdev_t *dev, const char *path) {
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    dev->write = cstruct_blockdev_file_write;
+    dev->read = cstruct_blockdev_file_read;
+    dev->ctx = (void *)(intptr_t)fd;
+    return dev;
+}
+
+/**
+ * @brief ファイルのブロックデバイスを閉じる
+ * @param dev ブロックデバイス
+ * @return 成功時は0、エラー時は負の値
+ */
+int cstruct_blockdev_file_close(cstruct_blockdev_t *dev) {
+    return (close((int)(intptr_t)dev->ctx) == 0) ? 0 : -1;
+}
+#endif
@@ -0,0 +1,220 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file cstruct_log.h
+ * @brief ページ境界に揃えたレコードロガーのヘッダファイル
+ *
+ * SDカードやSPIフラッシュに対して、パックしたレコードをページ単位
+ * （512バイトや4KBなど）でまとめて書き込むためのロガーを提供します。
+ *
+ * - レコードはページバッファへ直接パックされる
+ * - ページをまたぐレコードはそのまま次のページへ続けて格納される
+ * - 書き込みはブロックデバイスのコールバックを通じてページ単位で行われる
+ * - 各ページで最初に始まるレコードのタイムスタンプを小さな索引に保持し、
+ *   時刻からページ位置を高速に求められる
+ *
+ * ページバッファは「ページサイズ + 最大レコードサイズ」以上を確保します。
+ * ページ末尾からはみ出した分は、ページ書き込み後にバッファ先頭へ移動されます。
+ */
+#ifndef CSTRUCT_LOG_H
+#define CSTRUCT_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdarg.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief ブロックデバイスのページ書き込み関数
+ * @param ctx デバイス固有のコンテキスト
+ * @param page_no ページ番号
+ * @param page ページデータ
+ * @param page_size ページサイズ
+ * @return 成功時は0、エラー時は負の値
+ */
+typedef int (*cstruct_blockdev_write_fn)(void *ctx, uint32_t page_no, const void *page, size_t page_size);
+
+/**
+ * @brief ブロックデバイスのページ読み出し関数
+ * @param ctx デバイス固有のコンテキスト
+ * @param page_no ページ番号
+ * @param page 読み出し先バッファ
+ * @param page_size ページサイズ
+ * @return 成功時は0、エラー時は負の値
+ */
+typedef int (*cstruct_blockdev_read_fn)(void *ctx, uint32_t page_no, void *page, size_t page_size);
+
+/**
+ * @brief ブロックデバイス
+ */
+typedef struct {
+    cstruct_blockdev_write_fn write; /**< ページ書き込み関数 */
+    cstruct_blockdev_read_fn read;   /**< ページ読み出し関数（読み出し不要ならNULL） */
+    void *ctx;                       /**< デバイス固有のコンテキスト */
+} cstruct_blockdev_t;
+
+/**
+ * @brief ページ索引のエントリ
+ */
+typedef struct {
+    uint32_t page_no;   /**< ページ番号 */
+    uint32_t timestamp; /**< ページ内で最初に始まるレコードのタイムスタンプ */
+    uint32_t offset;    /**< そのレコードのページ内オフセット */
+} cstruct_log_index_t;
+
+/**
+ * @brief ページロガー
+ */
+typedef struct {
+    cstruct_blockdev_t dev;       /**< 書き込み先デバイス */
+    uint8_t *buf;                 /**< ページバッファ */
+    size_t bufsize;               /**< ページバッファのサイズ */
+    size_t page_size;             /**< ページサイズ */
+    size_t fill;                  /**< 現在のページの使用バイト数 */
+    uint32_t page_no;             /**< 現在のページ番号 */
+    int page_indexed;             /**< 現在のページを索引に登録済みか */
+    cstruct_log_index_t *index;   /**< 索引 */
+    size_t index_cap;             /**< 索引の最大エントリ数 */
+    size_t index_len;             /**< 索引の現在のエントリ数 */
+    uint32_t index_stride;        /**< 索引に登録するページの間隔 */
+} cstruct_log_t;
+
+/**
+ * @brief ログの読み出し位置
+ */
+typedef struct {
+    const cstruct_blockdev_t *dev; /**< 読み出し元デバイス */
+    uint8_t *page;                 /**< ページ読み出し用バッファ（ページサイズ） */
+    size_t page_size;              /**< ページサイズ */
+    uint32_t page_no;              /**< 現在のページ番号 */
+    size_t offset;                 /**< 現在のページ内オフセット */
+    int loaded;                    /**< pageに現在のページが読み込まれているか */
+} cstruct_log_reader_t;
+
+/**
+ * @brief ページロガーを初期化する
+ *
+ * @param log 初期化するロガー
+ * @param dev 書き込み先デバイス
+ * @param buf ページバッファ（ページサイズ + 最大レコードサイズ以上）
+ * @param bufsize ページバッファのサイズ
+ * @param page_size ページサイズ
+ * @param index 索引用の配列（不要ならNULL）
+ * @param index_cap 索引用の配列の要素数
+ * @return 成功時はlog、エラー時はNULL
+ */
+cstruct_log_t *cstruct_log_init(cstruct_log_t *log, const cstruct_blockdev_t *dev,
+                                void *buf, size_t bufsize, size_t page_size,
+                                cstruct_log_index_t *index, size_t index_cap);
+
+/**
+ * @brief レコードをパックしてログに追加する
+ *
+ * @param log ロガー
+ * @param timestamp レコードのタイムスタンプ
+ * @param fmt フォーマット文字列
+ * @param ... フォーマット文字列に対応する値
+ * @return 成功時は0、エラー時は負の値
+ */
+int cstruct_log_append(cstruct_log_t *log, uint32_t timestamp, const char *fmt, ...);
+
+/**
+ * @brief レコードをパックしてログに追加する（va_list版）
+ *
+ * @param log ロガー
+ * @param timestamp レコードのタイムスタンプ
+ * @param fmt フォーマット文字列
+ * @param args 可変引数リスト
+ * @return 成功時は0、エラー時は負の値
+ */
+int cstruct_log_append_v(cstruct_log_t *log, uint32_t timestamp, const char *fmt, va_list args);
+
+/**
+ * @brief 書きかけのページをデバイスに書き出す
+ *
+ * ページの未使用部分は0で埋められます。書き出し後も同じページへの追記は続き、
+ * 次にページが埋まった時点（または次のフラッシュ時）に同じページ番号で再度書き込まれます。
+ *
+ * @param log ロガー
+ * @return 成功時は0、エラー時は負の値
+ */
+int cstruct_log_flush(cstruct_log_t *log);
+
+/**
+ * @brief ログ先頭からの書き込み済みバイト数を取得する
+ * @param log ロガー
+ * @return 書き込み済みバイト数（バッファ上の未書き出し分を含む）
+ */
+uint64_t cstruct_log_tell(const cstruct_log_t *log);
+
+/**
+ * @brief 指定した時刻以前で最も新しい索引位置を求める
+ *
+ * タイムスタンプは単調増加しているものとして二分探索します。
+ *
+ * @param log ロガー
+ * @param timestamp 探索する時刻
+ * @param page_no 見つかったページ番号の格納先
+ * @param offset 見つかったレコードのページ内オフセットの格納先
+ * @return 成功時は0、該当する位置がない場合は負の値
+ */
+int cstruct_log_seek(const cstruct_log_t *log, uint32_t timestamp, uint32_t *page_no, size_t *offset);
+
+/**
+ * @brief ログの読み出し位置を初期化する
+ *
+ * @param reader 初期化する読み出し位置
+ * @param dev 読み出し元デバイス
+ * @param page ページ読み出し用バッファ（ページサイズ）
+ * @param page_size ページサイズ
+ * @param page_no 読み出しを開始するページ番号
+ * @param offset 読み出しを開始するページ内オフセット
+ * @return 成功時はreader、エラー時はNULL
+ */
+cstruct_log_reader_t *cstruct_log_reader_init(cstruct_log_reader_t *reader, const cstruct_blockdev_t *dev,
+                                              void *page, size_t page_size, uint32_t page_no, size_t offset);
+
+/**
+ * @brief ログからレコード1件分のバイト列を読み出す
+ *
+ * ページをまたぐレコードは連結して返します。
+ *
+ * @param reader 読み出し位置
+ * @param dst 読み出し先バッファ
+ * @param size レコードサイズ（cstruct_calcsize()の値）
+ * @return 成功時は0、エラー時は負の値
+ */
+int cstruct_log_read(cstruct_log_reader_t *reader, void *dst, size_t size);
+
+#if defined(__unix__) || defined(__APPLE__)
+/**
+ * @brief ファイルをブロックデバイスとして開く
+ *
+ * ページ番号 × ページサイズの位置に読み書きします。ホスト環境での動作確認用です。
+ *
+ * @param dev 初期化するブロックデバイス
+ * @param path ファイルパス
+ * @return 成功時はdev、エラー時はNULL
+ */
+cstruct_blockdev_t *cstruct_blockdev_file_open(cstruct_blockdev_t *dev, const char *path);
+
+/**
+ * @brief ファイルのブロックデバイスを閉じる
+ * @param dev ブロックデバイス
+ * @return 成功時は0、エラー時は負の値
+ */
+int cstruct_blockdev_file_close(cstruct_blockdev_t *dev);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CSTRUCT_LOG_H */
@@ -0,0 +1,684 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file cstruct_parallel.c
+ * @brief NUMAを考慮した並列一括アンパック・並列バイト順変換・並列トランスコードの実装（Linux専用）
+ *
+ * get_mempolicy()・mbind()はlibnumaを使わず、システムコールで直接呼び出します。
+ */
+#if defined(__linux__)
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "cstruct_parallel.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#ifndef MPOL_BIND
+#define MPOL_BIND 2
+#endif
+#ifndef MPOL_F_NODE
+#define MPOL_F_NODE (1 << 0)
+#endif
+#ifndef MPOL_F_ADDR
+#define MPOL_F_ADDR (1 << 1)
+#endif
+#ifndef MPOL_MF_MOVE
+#define MPOL_MF_MOVE (1 << 1)
+#endif
+
+/** @brief ノードを調べる間隔の既定値 */
+#define CSTRUCT_PAR_GRANULARITY (2u * 1024u * 1024u)
+
+/**
+ * @brief 同じノードに置かれた連続したレコードの範囲
+ */
+typedef struct {
+    size_t first; /**< 先頭のレコード番号 */
+    size_t count; /**< レコード数 */
+    int node;     /**< ノード番号 */
+} cstruct_par_segment_t;
+
+/**
+ * @brief ワーカースレッドの担当
+ */
+typedef struct {
+    const uint8_t *src;                   /**< 入力元バッファ */
+    const cstruct_plan_t *plan;           /**< プラン */
+    void *const *columns;                 /**< フィールドごとの配列 */
+    void **cols;                          /**< 範囲の先頭に合わせた配列（作業領域） */
+    const size_t *csizes;                 /**< フィールドごとのC言語上のバイト数 */
+    const cstruct_par_segment_t *segs;    /**< 範囲の列 */
+    size_t nsegs;                         /**< 範囲の数 */
+    int node;                             /**< 担当するノード */
+    size_t skip;                          /**< ノードの範囲のうち読み飛ばすレコード数 */
+    size_t count;                         /**< 担当するレコード数 */
+    unsigned flags;                       /**< フラグ */
+    int failed;                           /**< アンパックに失敗した範囲があれば1 */
+} cstruct_par_work_t;
+
+/**
+ * @brief CPUリスト（"0-3,8-11"の形式）を読み取ってノードを割り当てる
+ * @param topo トポロジ
+ * @param list CPUリスト
+ * @param node ノード番号
+ */
+static void cstruct_numa_parse_cpulist(cstruct_numa_topology_t *topo, const char *list, int node) {
+    const char *p = list;
+    while (*p >= '0' && *p <= '9') {
+        char *end;
+        long lo = strtol(p, &end, 10);
+        long hi = lo;
+        if (*end == '-') {
+            hi = strtol(end + 1, &end, 10);
+        }
+        for (long cpu = lo; cpu <= hi && cpu < CSTRUCT_NUMA_MAX_CPUS; cpu++) {
+            topo->cpu_node[cpu] = (int16_t)node;
+        }
+        p = (*end == ',') ? end + 1 : end;
+    }
+}
+
+/**
+ * @brief 実行中のマシンのNUMAトポロジを調べる
+ *
+ * /sys/devices/system/node を読み取ります。読み取れない場合は、
+ * オンラインのすべてのCPUを1つのノードとします。
+ *
+ * @param topo 格納先
+ * @return 成功時はtopo、エラー時はNULL
+ */
+cstruct_numa_topology_t *cstruct_numa_detect(cstruct_numa_topology_t *topo) {
+    char path[64];
+    char list[4096];
+
+    memset(topo, 0, sizeof(*topo));
+    for (size_t cpu = 0; cpu < CSTRUCT_NUMA_MAX_CPUS; cpu++) {
+        topo->cpu_node[cpu] = -1;
+    }
+
+    for (int node = 0; node < CSTRUCT_NUMA_MAX_NODES; node++) {
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        FILE *fp = fopen(path, "r");
+        if (fp == NULL) {
+            break;
+        }
+        if (fgets(list, sizeof(list), fp) != NULL) {
+            cstruct_numa_parse_cpulist(topo, list, node);
+        }
+        fclose(fp);
+        topo->nodes = (unsigned)node + 1;
+    }
+
+    // NUMAの情報がない場合は単一ノードとする
+    if (topo->nodes == 0) {
+        long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+        if (ncpu < 1) {
+            ncpu = 1;
+        }
+        for (long cpu = 0; cpu < ncpu && cpu < CSTRUCT_NUMA_MAX_CPUS; cpu++) {
+            topo->cpu_node[cpu] = 0;
+        }
+        topo->nodes = 1;
+    }
+
+    return topo;
+}
+
+/**
+ * @brief ページが置かれたノードを返す
+ *
+ * @param topo トポロジ
+ * @param addr アドレス
+ * @return ノード番号、不明な場合は-1
+ */
+int cstruct_numa_page_node(const cstruct_numa_topology_t *topo, const void *addr) {
+    if (topo->page_node != NULL) {
+        return topo->page_node(topo->ctx, addr);
+    }
+#if defined(SYS_get_mempolicy)
+    int node = -1;
+    if (syscall(SYS_get_mempolicy, &node, NULL, 0UL, addr, (unsigned long)(MPOL_F_NODE | MPOL_F_ADDR)) == 0) {
+        return node;
+    }
+#endif
+    return -1;
+}
+
+/**
+ * @brief トークン1つ分の値がC言語上で占めるバイト数を求める
+ * @param tok フォーマットトークン
+ * @return バイト数（パディングは0）
+ */
+static size_t cstruct_par_csize(const cstruct_token_t *tok) {
+    if (tok->type == CSTRUCT_TYPE_STRING) {
+        return cstruct_token_elem_size(tok);
+    }
+    return cstruct_token_elem_size(tok) * tok->count;
+}
+
+/**
+ * @brief 出力の列のうち範囲に完全に含まれるページをノードへ移動する
+ * @param addr 範囲の先頭
+ * @param len 範囲のバイト数
+ * @param node ノード番号
+ */
+static void cstruct_par_mbind(void *addr, size_t len, int node) {
+#if defined(SYS_mbind)
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t lo = ((uintptr_t)addr + page - 1) & ~(page - 1);
+    uintptr_t hi = ((uintptr_t)addr + len) & ~(page - 1);
+    unsigned long mask = 1UL << node;
+    if (hi > lo) {
+        // 失敗しても結果には影響しないため、戻り値は確認しない
+        (void)syscall(SYS_mbind, (void *)lo, (unsigned long)(hi - lo), (unsigned long)MPOL_BIND,
+                      &mask, (unsigned long)(sizeof(mask) * 8), (unsigned long)MPOL_MF_MOVE);
+    }
+#else
+    (void)addr;
+    (void)len;
+    (void)node;
+#endif
+}
+
+/**
+ * @brief レコードの範囲をアンパックする
+ * @param w 担当
+ * @param first 先頭のレコード番号
+ * @param count レコード数
+ * @return 成功時は0、エラー時は-1
+ */
+static int cstruct_par_decode(cstruct_par_work_t *w, size_t first, size_t count) {
+    const cstruct_plan_t *plan = w->plan;
+
+    for (size_t f = 0; f < plan->fields; f++) {
+        w->cols[f] = (uint8_t *)w->columns[f] + first * w->csizes[f];
+        if (w->flags & CSTRUCT_PAR_MBIND) {
+            cstruct_par_mbind(w->cols[f], count * w->csizes[f], w->node);
+        }
+    }
+    if (cstruct_unpack_batch(w->src + first * plan->size, count * plan->size, plan, w->cols, count) == NULL) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief ワーカースレッドの処理
+ *
+ * ノードの範囲を順にたどり、skipから始まるcount件を処理します。
+ * アンパックに失敗した範囲があればfailedを設定します。
+ *
+ * @param arg 担当
+ * @return NULL
+ */
+static void *cstruct_par_worker(void *arg) {
+    cstruct_par_work_t *w = (cstruct_par_work_t *)arg;
+    size_t skip = w->skip;
+    size_t left = w->count;
+
+    for (size_t i = 0; i < w->nsegs && left > 0; i++) {
+        const cstruct_par_segment_t *seg = &w->segs[i];
+        if (seg->node != w->node) {
+            continue;
+        }
+        if (skip >= seg->count) {
+            skip -= seg->count;
+            continue;
+        }
+        size_t n = seg->count - skip;
+        if (n > left) {
+            n = left;
+        }
+        if (cstruct_par_decode(w, seg->first + skip, n) != 0) {
+            w->failed = 1;
+        }
+        skip = 0;
+        left -= n;
+    }
+    return NULL;
+}
+
+/**
+ * @brief 入力をノードごとの範囲に区切る
+ *
+ * granularityごとにページのノードを調べ、同じノードが続く範囲をまとめます。
+ * ノードが不明な位置は直前の範囲と同じノードとします。
+ *
+ * @param segs 範囲の格納先
+ * @param src 入力元バッファ
+ * @param size レコードのバイト数
+ * @param nrec レコード数
+ * @param topo トポロジ
+ * @return 範囲の数
+ */
+static size_t cstruct_par_partition(cstruct_par_segment_t *segs, const uint8_t *src, size_t size, size_t nrec,
+                                    const cstruct_numa_topology_t *topo) {
+    size_t step = topo->granularity != 0 ? topo->granularity : CSTRUCT_PAR_GRANULARITY;
+    size_t per = step / size != 0 ? step / size : 1;
+    size_t nsegs = 0;
+
+    for (size_t first = 0; first < nrec; first += per) {
+        size_t count = nrec - first < per ? nrec - first : per;
+        int node = cstruct_numa_page_node(topo, src + first * size);
+        if (node < 0 || (unsigned)node >= topo->nodes || node >= CSTRUCT_NUMA_MAX_NODES) {
+            node = nsegs > 0 ? segs[nsegs - 1].node : 0;
+        }
+        if (nsegs > 0 && segs[nsegs - 1].node == node) {
+            segs[nsegs - 1].count += count;
+        } else {
+            segs[nsegs].first = first;
+            segs[nsegs].count = count;
+            segs[nsegs].node = node;
+            nsegs++;
+        }
+    }
+    return nsegs;
+}
+
+/**
+ * @brief レコード列を列ごとの配列へ並列にアンパックする
+ *
+ * 結果はcstruct_unpack_batch()と同じです。
+ *
+ * @param src 入力元バッファ（レコードが隙間なく並んだもの）
+ * @param srclen 入力元バッファのサイズ
+ * @param plan プラン
+ * @param columns フィールドごとの配列へのポインタ
+ * @param nrec レコード数
+ * @param topo トポロジ（NULLで単一ノード）
+ * @param threads_per_node ノードごとのスレッド数（0でノードのCPU数）
+ * @param flags CSTRUCT_PAR_MBINDなどのフラグ
+ * @param stats 統計の格納先（不要ならNULL）
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_batch_parallel(const void *src, size_t srclen, const cstruct_plan_t *plan,
+                                          void *const *columns, size_t nrec,
+                                          const cstruct_numa_topology_t *topo, unsigned threads_per_node,
+                                          unsigned flags, cstruct_parallel_stats_t *stats) {
+    const uint8_t *in = (const uint8_t *)src;
+    unsigned nodes = (topo != NULL && topo->nodes > 1) ? topo->nodes : 1;
+    unsigned ncpu[CSTRUCT_NUMA_MAX_NODES] = {0};
+    size_t node_recs[CSTRUCT_NUMA_MAX_NODES] = {0};
+
+    if (plan->size == 0 || nrec > srclen / plan->size) {
+        return NULL;
+    }
+    for (size_t i = 0; i < plan->count; i++) {
+        if (plan->tokens[i].channels != 0) {
+            return NULL; // インターリーブした配列は列に格納できない
+        }
+    }
+    if (nodes > CSTRUCT_NUMA_MAX_NODES) {
+        nodes = CSTRUCT_NUMA_MAX_NODES;
+    }
+    if (stats != NULL) {
+        memset(stats, 0, sizeof(*stats));
+    }
+    if (nrec == 0) {
+        return in;
+    }
+
+    // ノードごとのCPU数
+    if (topo != NULL) {
+        for (size_t cpu = 0; cpu < CSTRUCT_NUMA_MAX_CPUS; cpu++) {
+            int node = topo->cpu_node[cpu];
+            if (node >= 0 && (unsigned)node < nodes) {
+                ncpu[node]++;
+            }
+        }
+    } else {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        ncpu[0] = n > 0 ? (unsigned)n : 1;
+    }
+
+    // 作業領域：範囲の列、ワーカー、フィールドごとの情報
+    size_t step = (topo != NULL && topo->granularity != 0) ? topo->granularity : CSTRUCT_PAR_GRANULARITY;
+    size_t per = step / plan->size != 0 ? step / plan->size : 1;
+    size_t maxsegs = nodes > 1 ? (nrec + per - 1) / per : 1;
+    size_t maxwork = 0;
+    for (unsigned node = 0; node < nodes; node++) {
+        maxwork += threads_per_node != 0 ? threads_per_node : (ncpu[node] != 0 ? ncpu[node] : 1);
+    }
+
+    cstruct_par_segment_t *segs = (cstruct_par_segment_t *)malloc(maxsegs * sizeof(*segs));
+    cstruct_par_work_t *work = (cstruct_par_work_t *)calloc(maxwork, sizeof(*work));
+    pthread_t *tids = (pthread_t *)calloc(maxwork, sizeof(*tids));
+    size_t *csizes = (size_t *)malloc((plan->fields + 1) * sizeof(*csizes));
+    void **cols = (void **)malloc((maxwork * plan->fields + 1) * sizeof(*cols));
+    if (segs == NULL || work == NULL || tids == NULL || csizes == NULL || cols == NULL) {
+        free(segs);
+        free(work);
+        free(tids);
+        free(csizes);
+        free(cols);
+        return NULL;
+    }
+
+    size_t field = 0;
+    for (size_t i = 0; i < plan->count; i++) {
+        if (plan->tokens[i].type != CSTRUCT_TYPE_PADDING) {
+            csizes[field++] = cstruct_par_csize(&plan->tokens[i]);
+        }
+    }
+
+    // 単一ノードの場合は全体を1つの範囲とする
+    size_t nsegs;
+    if (nodes > 1) {
+        nsegs = cstruct_par_partition(segs, in, plan->size, nrec, topo);
+    } else {
+        segs[0].first = 0;
+        segs[0].count = nrec;
+        segs[0].node = 0;
+        nsegs = 1;
+    }
+    for (size_t i = 0; i < nsegs; i++) {
+        node_recs[segs[i].node] += segs[i].count;
+    }
+
+    // ノードごとのレコードをスレッドに均等に割り当てる
+    size_t nwork = 0;
+    for (unsigned node = 0; node < nodes; node++) {
+        unsigned nthr = threads_per_node != 0 ? threads_per_node : (ncpu[node] != 0 ? ncpu[node] : 1);
+        if (node_recs[node] == 0) {
+            continue;
+        }
+        if (nthr > node_recs[node]) {
+            nthr = (unsigned)node_recs[node];
+        }
+        for (unsigned t = 0; t < nthr; t++) {
+            cstruct_par_work_t *w = &work[nwork];
+            w->src = in;
+            w->plan = plan;
+            w->columns = columns;
+            w->cols = &cols[nwork * plan->fields];
+            w->csizes = csizes;
+            w->segs = segs;
+            w->nsegs = nsegs;
+            w->node = (int)node;
+            w->skip = node_recs[node] * t / nthr;
+            w->count = node_recs[node] * (t + 1) / nthr - w->skip;
+            w->flags = nodes > 1 ? flags : (flags & ~(unsigned)CSTRUCT_PAR_MBIND);
+            nwork++;
+        }
+        if (stats != NULL) {
+            stats->records[node] = node_recs[node];
+        }
+    }
+
+    // 複数ノードの場合は、すべての担当をスレッドで処理し、起動時からノードのCPUに固定する
+    size_t first = nodes > 1 ? 0 : 1;
+    size_t started = 0;
+    unsigned pinned = 0;
+    for (size_t i = first; i < nwork; i++) {
+        pthread_attr_t attr;
+        int rc = -1;
+        if (nodes > 1 && !(flags & CSTRUCT_PAR_NO_PIN) && pthread_attr_init(&attr) == 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (int cpu = 0; cpu < CSTRUCT_NUMA_MAX_CPUS && cpu < CPU_SETSIZE; cpu++) {
+                if (topo->cpu_node[cpu] == work[i].node) {
+                    CPU_SET(cpu, &set);
+                }
+            }
+            if (pthread_attr_setaffinity_np(&attr, sizeof(set), &set) == 0) {
+                rc = pthread_create(&tids[i], &attr, cstruct_par_worker, &work[i]);
+            }
+            pthread_attr_destroy(&attr);
+            if (rc == 0) {
+                pinned++;
+            }
+        }
+        // 固定できないCPU（模擬トポロジなど）の場合は固定せずに起動する
+        if (rc != 0) {
+            rc = pthread_create(&tids[i], NULL, cstruct_par_worker, &work[i]);
+        }
+        if (rc != 0) {
+            // スレッドを起動できない場合は呼び出し元のスレッドで処理する
+            cstruct_par_worker(&work[i]);
+            tids[i] = pthread_self();
+            continue;
+        }
+        started++;
+    }
+
+    // 単一ノードの場合、最初の担当は呼び出し元のスレッドで処理する
+    if (first == 1 && nwork > 0) {
+        cstruct_par_worker(&work[0]);
+    }
+    for (size_t i = first; i < nwork; i++) {
+        if (!pthread_equal(tids[i], pthread_self())) {
+            pthread_join(tids[i], NULL);
+        }
+    }
+
+    if (stats != NULL) {
+        stats->threads = (unsigned)started;
+        stats->pinned = pinned;
+    }
+
+    int failed = 0;
+    for (size_t i = 0; i < nwork; i++) {
+        failed |= work[i].failed;
+    }
+
+    free(segs);
+    free(work);
+    free(tids);
+    free(csizes);
+    free(cols);
+
+    return failed ? NULL : in + plan->size * nrec;
+}
+
+/**
+ * @brief 等分した範囲を処理する関数
+ * @param ctx コンテキスト
+ * @param first 担当する最初のレコードの番号
+ * @param nrec 担当するレコード数
+ * @return 成功時は0、エラー時は0以外
+ */
+typedef int (*cstruct_par_range_fn)(void *ctx, size_t first, size_t nrec);
+
+/**
+ * @brief 等分した範囲の担当
+ */
+typedef struct {
+    cstruct_par_range_fn fn; /**< 範囲を処理する関数 */
+    void *ctx;               /**< fnに渡すコンテキスト */
+    size_t first;            /**< 最初のレコードの番号 */
+    size_t nrec;             /**< レコード数 */
+    int status;              /**< fnの戻り値 */
+} cstruct_par_range_t;
+
+/**
+ * @brief 等分した範囲のワーカースレッドの処理
+ * @param arg 担当
+ * @return NULL
+ */
+static void *cstruct_par_range_worker(void *arg) {
+    cstruct_par_range_t *w = (cstruct_par_range_t *)arg;
+    w->status = w->fn(w->ctx, w->first, w->nrec);
+    return NULL;
+}
+
+/**
+ * @brief レコード列をスレッド数で等分し、それぞれの範囲をfnで並列に処理する
+ *
+ * 最初の範囲は呼び出し元のスレッドで処理します。スレッドを起動できなかった範囲も同様です。
+ *
+ * @param nrec レコード数
+ * @param threads スレッド数（0でオンラインのCPU数）
+ * @param fn 範囲を処理する関数
+ * @param ctx fnに渡すコンテキスト
+ * @return 成功時は0、エラー時（fnが失敗した範囲がある場合を含む）は0以外
+ */
+static int cstruct_par_run_ranges(size_t nrec, unsigned threads, cstruct_par_range_fn fn, void *ctx) {
+    if (threads == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = n > 0 ? (unsigned)n : 1;
+    }
+    if (threads > nrec) {
+        threads = nrec > 0 ? (unsigned)nrec : 1;
+    }
+
+    cstruct_par_range_t *work = (cstruct_par_range_t *)calloc(threads, sizeof(*work));
+    pthread_t *tids = (pthread_t *)calloc(threads, sizeof(*tids));
+    int *started = (int *)calloc(threads, sizeof(*started));
+    if (work == NULL || tids == NULL || started == NULL) {
+        free(work);
+        free(tids);
+        free(started);
+        return -1;
+    }
+
+    for (unsigned t = 0; t < threads; t++) {
+        work[t].fn = fn;
+        work[t].ctx = ctx;
+        work[t].first = nrec * t / threads;
+        work[t].nrec = nrec * (t + 1) / threads - work[t].first;
+    }
+
+    for (unsigned t = 1; t < threads; t++) {
+        started[t] = pthread_create(&tids[t], NULL, cstruct_par_range_worker, &work[t]) == 0;
+    }
+    cstruct_par_range_worker(&work[0]);
+    for (unsigned t = 1; t < threads; t++) {
+        if (started[t]) {
+            pthread_join(tids[t], NULL);
+        } else {
+            cstruct_par_range_worker(&work[t]);
+        }
+    }
+
+    int status = 0;
+    for (unsigned t = 0; t < threads; t++) {
+        status |= work[t].status;
+    }
+
+    free(work);
+    free(tids);
+    free(started);
+    return status;
+}
+
+/**
+ * @brief バイト順の逆転のコンテキスト
+ */
+typedef struct {
+    uint8_t *buf;               /**< レコード列 */
+    const cstruct_plan_t *plan; /**< プラン */
+} cstruct_par_swap_t;
+
+/**
+ * @brief 範囲のバイト順を逆転する
+ * @param ctx コンテキスト
+ * @param first 最初のレコードの番号
+ * @param nrec レコード数
+ * @return 成功時は0、エラー時は-1
+ */
+static int cstruct_par_swap_range(void *ctx, size_t first, size_t nrec) {
+    cstruct_par_swap_t *c = (cstruct_par_swap_t *)ctx;
+    if (cstruct_swap_batch(c->buf + c->plan->size * first, c->plan->size * nrec, c->plan, nrec) == NULL) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 連続したレコード列のバイト順を並列にその場で逆転する
+ *
+ * レコード列をスレッド数で等分し、それぞれをcstruct_swap_batch()で処理します。
+ *
+ * @param buf レコード列（レコードが隙間なく並んだもの）
+ * @param len レコード列のバイト数
+ * @param plan プラン
+ * @param nrec レコード数
+ * @param threads スレッド数（0でオンラインのCPU数）
+ * @return 処理したデータの次の位置、エラー時（12ビットの組を含む場合を含む）はNULL
+ */
+void *cstruct_swap_batch_parallel(void *buf, size_t len, const cstruct_plan_t *plan, size_t nrec, unsigned threads) {
+    cstruct_par_swap_t c = {(uint8_t *)buf, plan};
+
+    if (plan->size != 0 && nrec > len / plan->size) {
+        return NULL;
+    }
+    for (size_t i = 0; i < plan->count; i++) {
+        if (plan->tokens[i].type == CSTRUCT_TYPE_PACKED12) {
+            return NULL; // 12ビットの組はバイト順の逆転では変換できない
+        }
+    }
+    if (cstruct_par_run_ranges(nrec, threads, cstruct_par_swap_range, &c) != 0) {
+        return NULL;
+    }
+    return c.buf + plan->size * nrec;
+}
+
+/**
+ * @brief 変換のコンテキスト
+ */
+typedef struct {
+    uint8_t *dst;                   /**< 出力 */
+    const uint8_t *src;             /**< 入力 */
+    const cstruct_transcoder_t *xc; /**< 変換 */
+} cstruct_par_xc_t;
+
+/**
+ * @brief 範囲を変換する
+ * @param ctx コンテキスト
+ * @param first 最初のレコードの番号
+ * @param nrec レコード数
+ * @return 成功時は0、エラー時は-1
+ */
+static int cstruct_par_xc_range(void *ctx, size_t first, size_t nrec) {
+    cstruct_par_xc_t *c = (cstruct_par_xc_t *)ctx;
+    size_t ssize = c->xc->src->size;
+    size_t dsize = c->xc->dst->size;
+    if (cstruct_transcode_batch(c->dst + dsize * first, dsize * nrec, c->src + ssize * first, ssize * nrec, c->xc,
+                                nrec) == NULL) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 連続したレコード列を並列に変換する
+ *
+ * レコード列をスレッド数で等分し、それぞれをcstruct_transcode_batch()で処理します。
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param src 入力元バッファ（レコードが隙間なく並んだもの）
+ * @param srclen 入力元バッファのサイズ
+ * @param xc 変換
+ * @param nrec レコード数
+ * @param threads スレッド数（0でオンラインのCPU数）
+ * @return 出力の次の位置、エラー時はNULL
+ */
+void *cstruct_transcode_batch_parallel(void *dst, size_t dstlen, const void *src, size_t srclen,
+                                       const cstruct_transcoder_t *xc, size_t nrec, unsigned threads) {
+    cstruct_par_xc_t c = {(uint8_t *)dst, (const uint8_t *)src, xc};
+    size_t ssize = xc->src->size;
+    size_t dsize = xc->dst->size;
+
+    if ((ssize != 0 && nrec > srclen / ssize) || (dsize != 0 && nrec > dstlen / dsize)) {
+        return NULL;
+    }
+    if (cstruct_par_run_ranges(nrec, threads, cstruct_par_xc_range, &c) != 0) {
+        return NULL;
+    }
+    return c.dst + dsize * nrec;
+}
+
+#endif /* __linux__ */
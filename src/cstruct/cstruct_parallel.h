@@ -0,0 +1,153 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file cstruct_parallel.h
+ * @brief NUMAを考慮した並列一括アンパック・並列バイト順変換・並列トランスコードのヘッダファイル（Linux専用）
+ *
+ * レコード列をワーカースレッドで分担してアンパックします。
+ * 複数ノードの環境では、入力のページが置かれたノードごとにレコード列を区切り、
+ * そのノードのCPUに固定したスレッドで処理します。
+ *
+ * - ページのノードはget_mempolicy()（システムコール）で調べる（libnumaは使わない）
+ * - 出力の列は、処理するスレッドが最初に書き込んだノードに割り当てられる（ファーストタッチ）
+ *   CSTRUCT_PAR_MBINDを指定すると、書き込み済みのページもmbind()で移動する
+ * - 単一ノードの環境では、CPUの固定を行わずにレコード列を均等に分ける
+ * - cstruct_numa_topology_t::page_nodeを差し替えると、任意のトポロジを模擬できる
+ *
+ * リンク時に-pthreadが必要です。
+ */
+#ifndef CSTRUCT_PARALLEL_H
+#define CSTRUCT_PARALLEL_H
+
+#if defined(__linux__)
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cstruct.h"
+#include "cstruct_transcode.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief 扱うノード数の上限 */
+#define CSTRUCT_NUMA_MAX_NODES 16
+/** @brief 扱うCPU数の上限 */
+#define CSTRUCT_NUMA_MAX_CPUS 1024
+
+/** @brief 書き込み済みの出力ページも処理するスレッドのノードへ移動する */
+#define CSTRUCT_PAR_MBIND   0x01
+/** @brief スレッドをCPUに固定しない */
+#define CSTRUCT_PAR_NO_PIN  0x02
+
+/**
+ * @brief ページが置かれたノードを返す関数
+ * @param ctx コンテキスト
+ * @param addr アドレス
+ * @return ノード番号、不明な場合は-1
+ */
+typedef int (*cstruct_numa_node_fn)(void *ctx, const void *addr);
+
+/**
+ * @brief NUMAトポロジ
+ */
+typedef struct {
+    unsigned nodes;                             /**< ノード数 */
+    int16_t cpu_node[CSTRUCT_NUMA_MAX_CPUS];    /**< CPUごとのノード番号（存在しないCPUは-1） */
+    cstruct_numa_node_fn page_node;             /**< ページのノードを返す関数（NULLでget_mempolicy()） */
+    void *ctx;                                  /**< page_nodeに渡すコンテキスト */
+    size_t granularity;                         /**< ノードを調べる間隔のバイト数（0で2MiB） */
+} cstruct_numa_topology_t;
+
+/**
+ * @brief 並列アンパックの統計
+ */
+typedef struct {
+    uint64_t records[CSTRUCT_NUMA_MAX_NODES]; /**< ノードごとに処理したレコード数 */
+    unsigned threads;                         /**< 起動したスレッド数 */
+    unsigned pinned;                          /**< CPUに固定できたスレッド数 */
+} cstruct_parallel_stats_t;
+
+/**
+ * @brief 実行中のマシンのNUMAトポロジを調べる
+ *
+ * /sys/devices/system/node を読み取ります。読み取れない場合は、
+ * オンラインのすべてのCPUを1つのノードとします。
+ *
+ * @param topo 格納先
+ * @return 成功時はtopo、エラー時はNULL
+ */
+cstruct_numa_topology_t *cstruct_numa_detect(cstruct_numa_topology_t *topo);
+
+/**
+ * @brief ページが置かれたノードを返す
+ *
+ * @param topo トポロジ
+ * @param addr アドレス
+ * @return ノード番号、不明な場合は-1
+ */
+int cstruct_numa_page_node(const cstruct_numa_topology_t *topo, const void *addr);
+
+/**
+ * @brief レコード列を列ごとの配列へ並列にアンパックする
+ *
+ * 結果はcstruct_unpack_batch()と同じです。
+ *
+ * @param src 入力元バッファ（レコードが隙間なく並んだもの）
+ * @param srclen 入力元バッファのサイズ
+ * @param plan プラン
+ * @param columns フィールドごとの配列へのポインタ
+ * @param nrec レコード数
+ * @param topo トポロジ（NULLで単一ノード）
+ * @param threads_per_node ノードごとのスレッド数（0でノードのCPU数）
+ * @param flags CSTRUCT_PAR_MBINDなどのフラグ
+ * @param stats 統計の格納先（不要ならNULL）
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_batch_parallel(const void *src, size_t srclen, const cstruct_plan_t *plan,
+                                          void *const *columns, size_t nrec,
+                                          const cstruct_numa_topology_t *topo, unsigned threads_per_node,
+                                          unsigned flags, cstruct_parallel_stats_t *stats);
+
+/**
+ * @brief 連続したレコード列のバイト順を並列にその場で逆転する
+ *
+ * レコード列をスレッド数で等分し、それぞれをcstruct_swap_batch()で処理します。
+ *
+ * @param buf レコード列（レコードが隙間なく並んだもの）
+ * @param len レコード列のバイト数
+ * @param plan プラン
+ * @param nrec レコード数
+ * @param threads スレッド数（0でオンラインのCPU数）
+ * @return 処理したデータの次の位置、エラー時（12ビットの組を含む場合を含む）はNULL
+ */
+void *cstruct_swap_batch_parallel(void *buf, size_t len, const cstruct_plan_t *plan, size_t nrec, unsigned threads);
+
+/**
+ * @brief 連続したレコード列を並列に変換する
+ *
+ * レコード列をスレッド数で等分し、それぞれをcstruct_transcode_batch()で処理します。
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param src 入力元バッファ（レコードが隙間なく並んだもの）
+ * @param srclen 入力元バッファのサイズ
+ * @param xc 変換
+ * @param nrec レコード数
+ * @param threads スレッド数（0でオンラインのCPU数）
+ * @return 出力の次の位置、エラー時はNULL
+ */
+void *cstruct_transcode_batch_parallel(void *dst, size_t dstlen, const void *src, size_t srclen,
+                                       const cstruct_transcoder_t *xc, size_t nrec, unsigned threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __linux__ */
+
+#endif /* CSTRUCT_PARALLEL_H */
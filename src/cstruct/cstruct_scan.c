@@ -0,0 +1,523 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file cstruct_scan.c
+ * @brief パック済みログファイルの一括読み出しの実装（Linux専用）
+ *
+ * io_uringはliburingを使わず、システムコールとリングのmmapで直接扱います。
+ */
+#if defined(__linux__)
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "cstruct_scan.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+#if defined(__NR_io_uring_setup) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define CSTRUCT_SCAN_HAVE_URING 1
+#endif
+#endif
+
+/** @brief 同時に発行する読み出し数の上限 */
+#define CSTRUCT_SCAN_MAX_DEPTH 64
+
+/**
+ * @brief チャンクをレコード単位に揃えてコールバックに渡すための状態
+ */
+typedef struct {
+    const cstruct_plan_t *plan;   /**< レコードのプラン */
+    cstruct_scan_fn fn;           /**< レコード列を受け取る関数 */
+    void *ctx;                    /**< fnに渡すコンテキスト */
+    uint8_t *carry;               /**< チャンク境界をまたいだレコード */
+    size_t carry_fill;            /**< carryに溜まっているバイト数 */
+    cstruct_scan_stats_t *stats;  /**< 読み出し統計 */
+} cstruct_scan_feed_t;
+
+/**
+ * @brief 読み出したバイト列をレコード単位でコールバックに渡す
+ * @param feed 状態
+ * @param p バイト列
+ * @param len バイト数
+ * @return 続行する場合は0、fnが中断した場合はその戻り値
+ */
+static int cstruct_scan_feed(cstruct_scan_feed_t *feed, const uint8_t *p, size_t len) {
+    size_t size = feed->plan->size;
+    size_t nrec;
+    size_t rem;
+    int r;
+
+    feed->stats->bytes += len;
+
+    // 前のチャンクから続くレコードを完成させる
+    if (feed->carry_fill > 0) {
+        size_t take = size - feed->carry_fill;
+        if (take > len) {
+            take = len;
+        }
+        memcpy(feed->carry + feed->carry_fill, p, take);
+        feed->carry_fill += take;
+        p += take;
+        len -= take;
+        if (feed->carry_fill == size) {
+            feed->carry_fill = 0;
+            feed->stats->records++;
+            if ((r = feed->fn(feed->ctx, feed->carry, 1)) != 0) {
+                return r;
+            }
+        }
+    }
+
+    // チャンク内のレコードはコピーせずそのまま渡す
+    nrec = len / size;
+    if (nrec > 0) {
+        feed->stats->records += nrec;
+        if ((r = feed->fn(feed->ctx, p, nrec)) != 0) {
+            return r;
+        }
+    }
+
+    rem = len - nrec * size;
+    memcpy(feed->carry + feed->carry_fill, p + nrec * size, rem);
+    feed->carry_fill += rem;
+    return 0;
+}
+
+/**
+ * @brief pread()で順に読み出す
+ * @param fd ファイルディスクリプタ
+ * @param chunk チャンクサイズ
+ * @param feed 状態
+ * @return 成功時は0、fnが中断した場合はその戻り値、エラー時は-1
+ */
+static int cstruct_scan_pread(int fd, size_t chunk, cstruct_scan_feed_t *feed) {
+    uint8_t *buf = (uint8_t *)malloc(chunk);
+    off_t off = 0;
+    int r = 0;
+
+    if (buf == NULL) {
+        return -1;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    for (;;) {
+        ssize_t n = pread(fd, buf, chunk, off);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            r = -1;
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+        feed->stats->reads++;
+        off += n;
+        if ((r = cstruct_scan_feed(feed, buf, (size_t)n)) != 0) {
+            break;
+        }
+    }
+
+    free(buf);
+    return r;
+}
+
+#if defined(CSTRUCT_SCAN_HAVE_URING)
+/**
+ * @brief mmapしたio_uringのリング
+ */
+typedef struct {
+    int fd;                      /**< io_uringのファイルディスクリプタ */
+    unsigned *sq_tail;           /**< SQの末尾 */
+    unsigned *sq_mask;           /**< SQのマスク */
+    unsigned *sq_array;          /**< SQの索引配列 */
+    unsigned *cq_head;           /**< CQの先頭 */
+    unsigned *cq_tail;           /**< CQの末尾 */
+    unsigned *cq_mask;           /**< CQのマスク */
+    struct io_uring_sqe *sqes;   /**< SQE配列 */
+    struct io_uring_cqe *cqes;   /**< CQE配列 */
+    void *sq_ptr;                /**< SQリングのマッピング */
+    void *cq_ptr;                /**< CQリングのマッピング */
+    size_t sq_len;               /**< SQリングのマッピングサイズ */
+    size_t cq_len;               /**< CQリングのマッピングサイズ */
+    size_t sqes_len;             /**< SQE配列のマッピングサイズ */
+    unsigned pending;            /**< 未送信のSQE数 */
+} cstruct_uring_t;
+
+/**
+ * @brief io_uringを作成してリングをmmapする
+ * @param ring リング
+ * @param entries エントリ数
+ * @return 成功時は0、エラー時は-1
+ */
+static int cstruct_uring_setup(cstruct_uring_t *ring, unsigned entries) {
+    struct io_uring_params p;
+    uint8_t *sq;
+    uint8_t *cq;
+
+    memset(ring, 0, sizeof(*ring));
+    memset(&p, 0, sizeof(p));
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+    if (ring->fd < 0) {
+        return -1;
+    }
+
+    ring->sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    ring->cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_len > ring->sq_len) {
+            ring->sq_len = ring->cq_len;
+        }
+        ring->cq_len = ring->sq_len;
+    }
+
+    ring->sq_ptr = mmap(NULL, ring->sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ptr == MAP_FAILED) {
+        close(ring->fd);
+        return -1;
+    }
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_ptr = ring->sq_ptr;
+    } else {
+        ring->cq_ptr = mmap(NULL, ring->cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ptr == MAP_FAILED) {
+            munmap(ring->sq_ptr, ring->sq_len);
+            close(ring->fd);
+            return -1;
+        }
+    }
+    ring->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = (struct io_uring_sqe *)mmap(NULL, ring->sqes_len, PROT_READ | PROT_WRITE,
+                                             MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        if (ring->cq_ptr != ring->sq_ptr) {
+            munmap(ring->cq_ptr, ring->cq_len);
+        }
+        munmap(ring->sq_ptr, ring->sq_len);
+        close(ring->fd);
+        return -1;
+    }
+
+    sq = (uint8_t *)ring->sq_ptr;
+    cq = (uint8_t *)ring->cq_ptr;
+    ring->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+    ring->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+    ring->sq_array = (unsigned *)(sq + p.sq_off.array);
+    ring->cq_head = (unsigned *)(cq + p.cq_off.head);
+    ring->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+    ring->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    return 0;
+}
+
+/**
+ * @brief io_uringを閉じる
+ * @param ring リング
+ */
+static void cstruct_uring_teardown(cstruct_uring_t *ring) {
+    munmap(ring->sqes, ring->sqes_len);
+    if (ring->cq_ptr != ring->sq_ptr) {
+        munmap(ring->cq_ptr, ring->cq_len);
+    }
+    munmap(ring->sq_ptr, ring->sq_len);
+    close(ring->fd);
+}
+
+/**
+ * @brief 読み出し要求をSQに積む
+ * @param ring リング
+ * @param fd 読み出すファイル
+ * @param iov 読み出し先
+ * @param offset ファイル内の位置
+ * @param slot バッファ番号
+ * @param registered 登録済みバッファを使うか
+ */
+static void cstruct_uring_prep_read(cstruct_uring_t *ring, int fd, struct iovec *iov, uint64_t offset,
+                                    unsigned slot, int registered) {
+    unsigned tail = *ring->sq_tail;
+    unsigned idx = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[idx];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->fd = fd;
+    sqe->off = offset;
+    sqe->user_data = slot;
+    if (registered) {
+        sqe->opcode = IORING_OP_READ_FIXED;
+        sqe->addr = (uint64_t)(uintptr_t)iov->iov_base;
+        sqe->len = (uint32_t)iov->iov_len;
+        sqe->buf_index = (uint16_t)slot;
+    } else {
+        sqe->opcode = IORING_OP_READV;
+        sqe->addr = (uint64_t)(uintptr_t)iov;
+        sqe->len = 1;
+    }
+    ring->sq_array[idx] = idx;
+
+    // SQEの書き込みを末尾の更新より先にカーネルから見えるようにする
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring->pending++;
+}
+
+/**
+ * @brief 積んだ要求を送信し、必要なら完了を待つ
+ * @param ring リング
+ * @param min_complete 待つ完了数
+ * @return 成功時は0、エラー時は-1
+ */
+static int cstruct_uring_enter(cstruct_uring_t *ring, unsigned min_complete) {
+    for (;;) {
+        long r = syscall(__NR_io_uring_enter, ring->fd, ring->pending, min_complete,
+                         min_complete > 0 ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+        if (r >= 0) {
+            ring->pending -= (unsigned)r;
+            return 0;
+        }
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
+/**
+ * @brief io_uringで先行読み出ししながら順に処理する
+ * @param fd ファイルディスクリプタ
+ * @param total ファイルサイズ
+ * @param chunk チャンクサイズ
+ * @param depth 同時に発行する読み出し数
+ * @param feed 状態
+ * @return 成功時は0、fnが中断した場合はその戻り値、io_uringが使えない場合は-2、エラー時は-1
+ */
+static int cstruct_scan_uring(int fd, uint64_t total, size_t chunk, unsigned depth, cstruct_scan_feed_t *feed) {
+    cstruct_uring_t ring;
+    struct iovec iovs[CSTRUCT_SCAN_MAX_DEPTH];
+    uint64_t offsets[CSTRUCT_SCAN_MAX_DEPTH];
+    int32_t results[CSTRUCT_SCAN_MAX_DEPTH];
+    uint8_t done[CSTRUCT_SCAN_MAX_DEPTH];
+    uint8_t *pool;
+    uint64_t next_off = 0;
+    uint64_t submitted = 0;
+    uint64_t processed = 0;
+    unsigned inflight = 0;
+    int registered;
+    int r = 0;
+
+    if (cstruct_uring_setup(&ring, depth) != 0) {
+        return -2;
+    }
+    if (posix_memalign((void **)&pool, 4096, chunk * depth) != 0) {
+        cstruct_uring_teardown(&ring);
+        return -1;
+    }
+    for (unsigned i = 0; i < depth; i++) {
+        iovs[i].iov_base = pool + (size_t)i * chunk;
+        iovs[i].iov_len = chunk;
+        done[i] = 0;
+    }
+
+    // バッファを登録できればページの固定をカーネルが読み出しごとに行わずに済む
+    registered = (syscall(__NR_io_uring_register, ring.fd, IORING_REGISTER_BUFFERS, iovs, depth) == 0);
+    feed->stats->uring = 1;
+    feed->stats->registered = registered;
+
+    // チャンクkは常にバッファk % depthに読み出す
+    for (unsigned i = 0; i < depth && next_off < total; i++) {
+        uint64_t len = total - next_off;
+        iovs[i].iov_len = (len < chunk) ? (size_t)len : chunk;
+        offsets[i] = next_off;
+        cstruct_uring_prep_read(&ring, fd, &iovs[i], next_off, i, registered);
+        next_off += iovs[i].iov_len;
+        submitted++;
+        inflight++;
+    }
+    if (cstruct_uring_enter(&ring, 0) != 0) {
+        r = -1;
+    }
+
+    while (r == 0 && processed < submitted) {
+        unsigned slot = (unsigned)(processed % depth);
+
+        // 処理したいチャンクの完了を待つ（他のチャンクの完了も記録しておく）
+        while (!done[slot]) {
+            unsigned head = *ring.cq_head;
+            if (head == __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE)) {
+                if (cstruct_uring_enter(&ring, 1) != 0) {
+                    r = -1;
+                    break;
+                }
+                continue;
+            }
+            struct io_uring_cqe *cqe = &ring.cqes[head & *ring.cq_mask];
+            done[cqe->user_data] = 1;
+            results[cqe->user_data] = cqe->res;
+            inflight--;
+            __atomic_store_n(ring.cq_head, head + 1, __ATOMIC_RELEASE);
+        }
+        if (r != 0) {
+            break;
+        }
+        done[slot] = 0;
+        feed->stats->reads++;
+
+        if (results[slot] < 0) {
+            r = -1;
+            break;
+        }
+
+        // 短い読み出しになった場合は残りをpread()で補う
+        size_t got = (size_t)results[slot];
+        while (got < iovs[slot].iov_len) {
+            ssize_t n = pread(fd, (uint8_t *)iovs[slot].iov_base + got, iovs[slot].iov_len - got,
+                              (off_t)(offsets[slot] + got));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                break;
+            }
+            got += (size_t)n;
+        }
+
+        r = cstruct_scan_feed(feed, (const uint8_t *)iovs[slot].iov_base, got);
+        processed++;
+
+        // 空いたバッファで次のチャンクの読み出しを発行する
+        if (r == 0 && next_off < total) {
+            uint64_t len = total - next_off;
+            iovs[slot].iov_len = (len < chunk) ? (size_t)len : chunk;
+            offsets[slot] = next_off;
+            cstruct_uring_prep_read(&ring, fd, &iovs[slot], next_off, slot, registered);
+            next_off += iovs[slot].iov_len;
+            submitted++;
+            inflight++;
+            if (cstruct_uring_enter(&ring, 0) != 0) {
+                r = -1;
+            }
+        }
+    }
+
+    // 送信できなかった要求はカーネルに渡っていないため、完了を待たない
+    inflight -= ring.pending;
+    ring.pending = 0;
+
+    // バッファを解放する前に発行済みの読み出しの完了を待つ
+    while (inflight > 0) {
+        unsigned head = *ring.cq_head;
+        if (head == __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE)) {
+            if (cstruct_uring_enter(&ring, 1) != 0) {
+                break;
+            }
+            continue;
+        }
+        inflight--;
+        __atomic_store_n(ring.cq_head, head + 1, __ATOMIC_RELEASE);
+    }
+
+    // リングを閉じても発行済みの読み出しは非同期に終わるため、完了を待てなかった場合は
+    // カーネルが後から書き込みうるバッファを解放せずに残す
+    cstruct_uring_teardown(&ring);
+    if (inflight == 0) {
+        free(pool);
+    }
+    return r;
+}
+#endif /* CSTRUCT_SCAN_HAVE_URING */
+
+/**
+ * @brief ファイル内のレコード列を一括で読み出す
+ *
+ * @param path ファイルパス
+ * @param plan レコードのプラン
+ * @param chunk_size 1回の読み出しサイズ
+ * @param depth 同時に発行する読み出しの数（io_uring使用時）
+ * @param flags CSTRUCT_SCAN_PREADなどのフラグ
+ * @param fn レコード列を受け取る関数
+ * @param ctx fnに渡すコンテキスト
+ * @param stats 読み出し統計の格納先（不要ならNULL）
+ * @return 成功時は0、fnが中断した場合はその戻り値、エラー時は-1
+ */
+int cstruct_scan_file(const char *path, const cstruct_plan_t *plan, size_t chunk_size, unsigned depth,
+                      unsigned flags, cstruct_scan_fn fn, void *ctx, cstruct_scan_stats_t *stats) {
+    cstruct_scan_stats_t local;
+    cstruct_scan_feed_t feed;
+    struct stat st;
+    int fd;
+    int r = -2;
+
+    if (plan->size == 0 || fn == NULL) {
+        return -1;
+    }
+    if (stats == NULL) {
+        stats = &local;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    // チャンクをレコードサイズの倍数に揃え、通常はチャンク境界でレコードが分かれないようにする
+    chunk_size -= chunk_size % plan->size;
+    if (chunk_size == 0) {
+        chunk_size = plan->size;
+    }
+    if (depth == 0) {
+        depth = 1;
+    }
+    if (depth > CSTRUCT_SCAN_MAX_DEPTH) {
+        depth = CSTRUCT_SCAN_MAX_DEPTH;
+    }
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    feed.plan = plan;
+    feed.fn = fn;
+    feed.ctx = ctx;
+    feed.carry = (uint8_t *)malloc(plan->size);
+    feed.carry_fill = 0;
+    feed.stats = stats;
+    if (feed.carry == NULL) {
+        close(fd);
+        return -1;
+    }
+
+#if defined(CSTRUCT_SCAN_HAVE_URING)
+    if (!(flags & CSTRUCT_SCAN_PREAD) && S_ISREG(st.st_mode)) {
+        r = cstruct_scan_uring(fd, (uint64_t)st.st_size, chunk_size, depth, &feed);
+    }
+#else
+    (void)flags;
+#endif
+    if (r == -2) {
+        // io_uringが使えない場合
+        r = cstruct_scan_pread(fd, chunk_size, &feed);
+    }
+
+    stats->trailing = feed.carry_fill;
+    free(feed.carry);
+    close(fd);
+    return r;
+}
+
+#endif /* __linux__ */
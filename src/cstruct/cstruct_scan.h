@@ -0,0 +1,80 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file cstruct_scan.h
+ * @brief パック済みログファイルの一括読み出しのヘッダファイル（Linux専用）
+ *
+ * レコードが隙間なく並んだファイルを大きなチャンク単位で読み出し、
+ * レコード単位に揃えてコールバックに渡します。コールバックでは
+ * cstruct_unpack_batch()などでまとめてデコードします。
+ *
+ * io_uringが使える場合は、登録済みバッファ（IORING_REGISTER_BUFFERS）への
+ * 読み出しを複数先行して発行し、デコード中も次のチャンクの読み出しを進めます。
+ * io_uringが使えない場合はpread()で順に読み出します。
+ */
+#ifndef CSTRUCT_SCAN_H
+#define CSTRUCT_SCAN_H
+
+#if defined(__linux__)
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cstruct.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief io_uringを使わずpread()で読み出す */
+#define CSTRUCT_SCAN_PREAD 0x01
+
+/**
+ * @brief レコード列を受け取る関数
+ * @param ctx cstruct_scan_file()に渡したコンテキスト
+ * @param records レコード列の先頭
+ * @param nrec レコード数
+ * @return 続行する場合は0、中断する場合は正の値
+ */
+typedef int (*cstruct_scan_fn)(void *ctx, const uint8_t *records, size_t nrec);
+
+/**
+ * @brief 読み出し統計
+ */
+typedef struct {
+    uint64_t records;  /**< コールバックに渡したレコード数 */
+    uint64_t bytes;    /**< 読み出したバイト数 */
+    uint64_t reads;    /**< 発行した読み出しの数 */
+    uint64_t trailing; /**< ファイル末尾の不完全なレコードのバイト数 */
+    int uring;         /**< io_uringを使った場合は1 */
+    int registered;    /**< 登録済みバッファを使った場合は1 */
+} cstruct_scan_stats_t;
+
+/**
+ * @brief ファイル内のレコード列を一括で読み出す
+ *
+ * チャンクサイズはレコードサイズの倍数に切り下げられます。
+ *
+ * @param path ファイルパス
+ * @param plan レコードのプラン
+ * @param chunk_size 1回の読み出しサイズ
+ * @param depth 同時に発行する読み出しの数（io_uring使用時）
+ * @param flags CSTRUCT_SCAN_PREADなどのフラグ
+ * @param fn レコード列を受け取る関数
+ * @param ctx fnに渡すコンテキスト
+ * @param stats 読み出し統計の格納先（不要ならNULL）
+ * @return 成功時は0、fnが中断した場合はその戻り値、エラー時は-1
+ */
+int cstruct_scan_file(const char *path, const cstruct_plan_t *plan, size_t chunk_size, unsigned depth,
+                      unsigned flags, cstruct_scan_fn fn, void *ctx, cstruct_scan_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __linux__ */
+
+#endif /* CSTRUCT_SCAN_H */
@@ -0,0 +1,217 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file cstruct_snapshot.c
+ * @brief 割り込み安全なダブルバッファ・スナップショットの実装
+ */
+#include "cstruct_snapshot.h"
+#include "cstruct.h"
+#include <string.h>
+
+// 単一コアの割り込みではコンパイラバリア、マルチコアではメモリバリアとして働く
+#define CSTRUCT_SEQ_LOAD(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define CSTRUCT_SEQ_STORE(p, v) __atomic_store_n((p), (cstruct_snapshot_seq_t)(v), __ATOMIC_RELEASE)
+
+/**
+ * @brief 読み出し中に読んでいたバッファが書き換えられなかったかを確認する
+ *
+ * 読み始めのシーケンス番号s1で公開中だったバッファは、書き込み側が2回先の書き込みを
+ * 始めた時点（s1の偶数部分 + 3）で初めて書き換えられます。
+ *
+ * @param s1 読み始めのシーケンス番号
+ * @param s2 読み終わりのシーケンス番号
+ * @return 読んだ内容が有効なら1
+ */
+static int cstruct_snapshot_valid(cstruct_snapshot_seq_t s1, cstruct_snapshot_seq_t s2) {
+    cstruct_snapshot_seq_t base = (cstruct_snapshot_seq_t)(s1 & ~(cstruct_snapshot_seq_t)1);
+    return (cstruct_snapshot_seq_t)(s2 - base) < 3;
+}
+
+/**
+ * @brief スナップショットを初期化する
+ *
+ * @param snap 初期化するスナップショット
+ * @param storage バッファ領域（半分ずつ2つのバッファとして使う）
+ * @param storage_len バッファ領域のサイズ
+ * @return 成功時はsnap、エラー時はNULL
+ */
+cstruct_snapshot_t *cstruct_snapshot_init(cstruct_snapshot_t *snap, void *storage, size_t storage_len) {
+    if (snap == NULL || storage == NULL || storage_len < 2) {
+        return NULL;
+    }
+    snap->size = storage_len / 2;
+    snap->buf[0] = (uint8_t *)storage;
+    snap->buf[1] = (uint8_t *)storage + snap->size;
+    snap->len[0] = 0;
+    snap->len[1] = 0;
+    snap->seq = 0;
+    return snap;
+}
+
+/**
+ * @brief 書き込みを開始する（書き込み側）
+ *
+ * 公開中でない方のバッファを返します。書き込み後にcstruct_snapshot_commit()で公開するか、
+ * cstruct_snapshot_abort()で取り消します。
+ *
+ * @param snap スナップショット
+ * @return 書き込み先バッファ（サイズはsnap->size）
+ */
+uint8_t *cstruct_snapshot_begin(cstruct_snapshot_t *snap) {
+    cstruct_snapshot_seq_t seq = snap->seq;
+
+    // 書き込み中を示してから、バッファへの書き込みを始める
+    CSTRUCT_SEQ_STORE(&snap->seq, seq + 1);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    return snap->buf[((seq >> 1) + 1) & 1];
+}
+
+/**
+ * @brief 書き込んだフレームを公開する（書き込み側）
+ *
+ * @param snap スナップショット
+ * @param len フレームのサイズ
+ */
+void cstruct_snapshot_commit(cstruct_snapshot_t *snap, size_t len) {
+    cstruct_snapshot_seq_t seq = snap->seq;
+
+    snap->len[((seq >> 1) + 1) & 1] = len;
+    CSTRUCT_SEQ_STORE(&snap->seq, seq + 1);
+}
+
+/**
+ * @brief 書き込みを取り消す（書き込み側）
+ *
+ * 公開中のフレームはそのまま残ります。書き込みと重なった読み出しはやり直しになります。
+ *
+ * @param snap スナップショット
+ */
+void cstruct_snapshot_abort(cstruct_snapshot_t *snap) {
+    // 番号を戻すと、取り消した書き込みと重なった読み出しが有効と判定されてしまう。
+    // 2k+1から2k+4へ進めると同じバッファを公開したまま、重なった読み出しはすべて無効になる
+    CSTRUCT_SEQ_STORE(&snap->seq, snap->seq + 3);
+}
+
+/**
+ * @brief フレームをパックして公開する（書き込み側、va_list版）
+ *
+ * @param snap スナップショット
+ * @param fmt フォーマット文字列
+ * @param args 可変引数リスト
+ * @return 成功時は0、エラー時は負の値（公開中のフレームは変わらない）
+ */
+int cstruct_snapshot_pack_v(cstruct_snapshot_t *snap, const char *fmt, va_list args) {
+    uint8_t *buf = cstruct_snapshot_begin(snap);
+    uint8_t *end = (uint8_t *)cstruct_pack_v(buf, snap->size, fmt, args);
+
+    if (end == NULL) {
+        cstruct_snapshot_abort(snap);
+        return -1;
+    }
+    cstruct_snapshot_commit(snap, (size_t)(end - buf));
+    return 0;
+}
+
+/**
+ * @brief フレームをパックして公開する（書き込み側）
+ *
+ * @param snap スナップショット
+ * @param fmt フォーマット文字列
+ * @param ... フォーマット文字列に対応する値
+ * @return 成功時は0、エラー時は負の値（公開中のフレームは変わらない）
+ */
+int cstruct_snapshot_pack(cstruct_snapshot_t *snap, const char *fmt, ...) {
+    int result;
+    va_list args;
+    va_start(args, fmt);
+    result = cstruct_snapshot_pack_v(snap, fmt, args);
+    va_end(args);
+    return result;
+}
+
+/**
+ * @brief 公開中のフレームをコピーする（読み出し側）
+ *
+ * @param snap スナップショット
+ * @param dst コピー先バッファ
+ * @param dstlen コピー先バッファのサイズ
+ * @return フレームのサイズ、まだ公開されていない場合やdstlenが足りない場合は0
+ */
+size_t cstruct_snapshot_read(const cstruct_snapshot_t *snap, void *dst, size_t dstlen) {
+    for (;;) {
+        cstruct_snapshot_seq_t s1 = CSTRUCT_SEQ_LOAD(&snap->seq);
+        unsigned idx = (unsigned)(s1 >> 1) & 1;
+        size_t len = snap->len[idx];
+        size_t n = len;
+
+        // 書き換え途中のlenを読んでもバッファの外へは出ないようにする
+        if (n > snap->size) {
+            n = snap->size;
+        }
+        if (n > dstlen) {
+            n = dstlen;
+        }
+        memcpy(dst, snap->buf[idx], n);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (!cstruct_snapshot_valid(s1, CSTRUCT_SEQ_LOAD(&snap->seq))) {
+            continue;
+        }
+        return (len > dstlen) ? 0 : len;
+    }
+}
+
+/**
+ * @brief 公開中のフレームをアンパックする（読み出し側、va_list版）
+ *
+ * @param snap スナップショット
+ * @param fmt フォーマット文字列
+ * @param args 可変引数リスト
+ * @return 成功時は0、エラー時は負の値
+ */
+int cstruct_snapshot_unpack_v(const cstruct_snapshot_t *snap, const char *fmt, va_list args) {
+    for (;;) {
+        cstruct_snapshot_seq_t s1 = CSTRUCT_SEQ_LOAD(&snap->seq);
+        unsigned idx = (unsigned)(s1 >> 1) & 1;
+        size_t len = snap->len[idx];
+        const void *end;
+        va_list ap;
+
+        if (len > snap->size) {
+            len = snap->size;
+        }
+        // 読み直しに備えて引数リストは毎回複製して使う
+        va_copy(ap, args);
+        end = cstruct_unpack_v(snap->buf[idx], len, fmt, ap);
+        va_end(ap);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (!cstruct_snapshot_valid(s1, CSTRUCT_SEQ_LOAD(&snap->seq))) {
+            continue;
+        }
+        return (end == NULL) ? -1 : 0;
+    }
+}
+
+/**
+ * @brief 公開中のフレームをアンパックする（読み出し側）
+ *
+ * 共有バッファから直接アンパックし、途中でバッファが書き換えられた場合はアンパックし直します。
+ *
+ * @param snap スナップショット
+ * @param fmt フォーマット文字列
+ * @param ... フォーマット文字列に対応する格納先ポインタ
+ * @return 成功時は0、エラー時は負の値
+ */
+int cstruct_snapshot_unpack(const cstruct_snapshot_t *snap, const char *fmt, ...) {
+    int result;
+    va_list args;
+    va_start(args, fmt);
+    result = cstruct_snapshot_unpack_v(snap, fmt, args);
+    va_end(args);
+    return result;
+}
@@ -0,0 +1,142 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file cstruct_snapshot.h
+ * @brief 割り込み安全なダブルバッファ・スナップショットのヘッダファイル
+ *
+ * 割り込みハンドラ（書き込み側）がパックしたフレームを、メインループ（読み出し側）へ
+ * 割り込みを禁止せずに受け渡すためのシーケンスロックを提供します。
+ *
+ * - 書き込み側は公開中でない方のバッファへパックし、完了後にシーケンス番号を進めて切り替える
+ * - 読み出し側は公開中のバッファを読み、その間に書き込み側がバッファを一巡していたら読み直す
+ * - 書き込み側は1つ（同じ割り込みハンドラ、または同じスレッド）に限る
+ *
+ * シーケンス番号は偶数なら確定、奇数なら書き込み中を表し、(seq / 2) % 2 が公開中のバッファです。
+ * AVRでは割り込みと不可分に読み書きできるよう8ビット、それ以外では32ビットの値を使います。
+ */
+#ifndef CSTRUCT_SNAPSHOT_H
+#define CSTRUCT_SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdarg.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__AVR__)
+typedef uint8_t cstruct_snapshot_seq_t;
+#else
+typedef uint32_t cstruct_snapshot_seq_t;
+#endif
+
+/**
+ * @brief ダブルバッファ・スナップショット
+ */
+typedef struct {
+    uint8_t *buf[2];                      /**< フレームを格納するバッファ */
+    size_t size;                          /**< バッファ1つ分のサイズ */
+    volatile size_t len[2];               /**< 各バッファに格納されたフレームのサイズ */
+    volatile cstruct_snapshot_seq_t seq;  /**< シーケンス番号 */
+} cstruct_snapshot_t;
+
+/**
+ * @brief スナップショットを初期化する
+ *
+ * @param snap 初期化するスナップショット
+ * @param storage バッファ領域（半分ずつ2つのバッファとして使う）
+ * @param storage_len バッファ領域のサイズ
+ * @return 成功時はsnap、エラー時はNULL
+ */
+cstruct_snapshot_t *cstruct_snapshot_init(cstruct_snapshot_t *snap, void *storage, size_t storage_len);
+
+/**
+ * @brief 書き込みを開始する（書き込み側）
+ *
+ * 公開中でない方のバッファを返します。書き込み後にcstruct_snapshot_commit()で公開するか、
+ * cstruct_snapshot_abort()で取り消します。
+ *
+ * @param snap スナップショット
+ * @return 書き込み先バッファ（サイズはsnap->size）
+ */
+uint8_t *cstruct_snapshot_begin(cstruct_snapshot_t *snap);
+
+/**
+ * @brief 書き込んだフレームを公開する（書き込み側）
+ *
+ * @param snap スナップショット
+ * @param len フレームのサイズ
+ */
+void cstruct_snapshot_commit(cstruct_snapshot_t *snap, size_t len);
+
+/**
+ * @brief 書き込みを取り消す（書き込み側）
+ *
+ * 公開中のフレームはそのまま残ります。書き込みと重なった読み出しはやり直しになります。
+ *
+ * @param snap スナップショット
+ */
+void cstruct_snapshot_abort(cstruct_snapshot_t *snap);
+
+/**
+ * @brief フレームをパックして公開する（書き込み側）
+ *
+ * @param snap スナップショット
+ * @param fmt フォーマット文字列
+ * @param ... フォーマット文字列に対応する値
+ * @return 成功時は0、エラー時は負の値（公開中のフレームは変わらない）
+ */
+int cstruct_snapshot_pack(cstruct_snapshot_t *snap, const char *fmt, ...);
+
+/**
+ * @brief フレームをパックして公開する（書き込み側、va_list版）
+ *
+ * @param snap スナップショット
+ * @param fmt フォーマット文字列
+ * @param args 可変引数リスト
+ * @return 成功時は0、エラー時は負の値（公開中のフレームは変わらない）
+ */
+int cstruct_snapshot_pack_v(cstruct_snapshot_t *snap, const char *fmt, va_list args);
+
+/**
+ * @brief 公開中のフレームをコピーする（読み出し側）
+ *
+ * @param snap スナップショット
+ * @param dst コピー先バッファ
+ * @param dstlen コピー先バッファのサイズ
+ * @return フレームのサイズ、まだ公開されていない場合やdstlenが足りない場合は0
+ */
+size_t cstruct_snapshot_read(const cstruct_snapshot_t *snap, void *dst, size_t dstlen);
+
+/**
+ * @brief 公開中のフレームをアンパックする（読み出し側）
+ *
+ * 共有バッファから直接アンパックし、途中でバッファが書き換えられた場合はアンパックし直します。
+ *
+ * @param snap スナップショット
+ * @param fmt フォーマット文字列
+ * @param ... フォーマット文字列に対応する格納先ポインタ
+ * @return 成功時は0、エラー時は負の値
+ */
+int cstruct_snapshot_unpack(const cstruct_snapshot_t *snap, const char *fmt, ...);
+
+/**
+ * @brief 公開中のフレームをアンパックする（読み出し側、va_list版）
+ *
+ * @param snap スナップショット
+ * @param fmt フォーマット文字列
+ * @param args 可変引数リスト
+ * @return 成功時は0、エラー時は負の値
+ */
+int cstruct_snapshot_unpack_v(const cstruct_snapshot_t *snap, const char *fmt, va_list args);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CSTRUCT_SNAPSHOT_H */
@@ -0,0 +1,255 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file cstruct_stream.c
+ * @brief 大きな配列・レコード列のストリーミング変換の実装（ホスト専用）
+ *
+ * 変換はブロック単位で中間バッファに行い、中間バッファから出力へのコピーだけを
+ * ノンテンポラルストアにします。変換処理そのものは通常のトークン処理を使います。
+ */
+#if !defined(ARDUINO)
+
+#include "cstruct_stream.h"
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/** @brief ノンテンポラルストアを使い始める出力サイズの既定値 */
+#ifndef CSTRUCT_STREAM_DEFAULT_THRESHOLD
+#define CSTRUCT_STREAM_DEFAULT_THRESHOLD (4u * 1024u * 1024u)
+#endif
+
+/** @brief 1ブロックで変換するバイト数の上限（中間バッファのサイズ） */
+#ifndef CSTRUCT_STREAM_BLOCK
+#define CSTRUCT_STREAM_BLOCK 4096
+#endif
+
+/** @brief キャッシュラインのバイト数（プリフェッチの間隔） */
+#define CSTRUCT_STREAM_LINE 64
+
+#if defined(__GNUC__)
+#define CSTRUCT_STREAM_PREFETCH(p) __builtin_prefetch((p), 0, 0)
+#else
+#define CSTRUCT_STREAM_PREFETCH(p) ((void)(p))
+#endif
+
+static size_t cstruct_stream_limit = CSTRUCT_STREAM_DEFAULT_THRESHOLD;
+
+/**
+ * @brief ノンテンポラルストアを使い始める出力サイズを設定する
+ *
+ * プロセス全体の設定です。変換を始める前に設定してください。
+ *
+ * @param bytes 出力のバイト数（SIZE_MAXで常に通常の変換）
+ */
+void cstruct_stream_set_threshold(size_t bytes) {
+    cstruct_stream_limit = bytes;
+}
+
+/**
+ * @brief ノンテンポラルストアを使い始める出力サイズを取得する
+ * @return 出力のバイト数
+ */
+size_t cstruct_stream_threshold(void) {
+    return cstruct_stream_limit;
+}
+
+/**
+ * @brief 次のブロックの入力をプリフェッチする
+ * @param next 次のブロックの先頭
+ * @param len 次のブロックのバイト数
+ */
+static void cstruct_stream_prefetch(const uint8_t *next, size_t len) {
+    for (size_t off = 0; off < len; off += CSTRUCT_STREAM_LINE) {
+        CSTRUCT_STREAM_PREFETCH(next + off);
+    }
+}
+
+/**
+ * @brief 中間バッファから出力へキャッシュを経由せずにコピーする
+ *
+ * 16バイト境界に揃わない先頭と末尾は通常のストアで書き込みます。
+ * 書き込みの完了はcstruct_stream_fence()で確定させてください。
+ *
+ * @param dst 出力先
+ * @param src 中間バッファ
+ * @param len バイト数
+ */
+static void cstruct_stream_copy(uint8_t *dst, const uint8_t *src, size_t len) {
+#if defined(__SSE2__)
+    size_t head = (size_t)(-(uintptr_t)dst & 15);
+    if (head > len) {
+        head = len;
+    }
+    memcpy(dst, src, head);
+    dst += head;
+    src += head;
+    len -= head;
+
+    for (; len >= 64; len -= 64, dst += 64, src += 64) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(const void *)(src + 0));
+        __m128i b = _mm_loadu_si128((const __m128i *)(const void *)(src + 16));
+        __m128i c = _mm_loadu_si128((const __m128i *)(const void *)(src + 32));
+        __m128i d = _mm_loadu_si128((const __m128i *)(const void *)(src + 48));
+        _mm_stream_si128((__m128i *)(void *)(dst + 0), a);
+        _mm_stream_si128((__m128i *)(void *)(dst + 16), b);
+        _mm_stream_si128((__m128i *)(void *)(dst + 32), c);
+        _mm_stream_si128((__m128i *)(void *)(dst + 48), d);
+    }
+    for (; len >= 16; len -= 16, dst += 16, src += 16) {
+        _mm_stream_si128((__m128i *)(void *)dst, _mm_loadu_si128((const __m128i *)(const void *)src));
+    }
+#endif
+    memcpy(dst, src, len);
+}
+
+/**
+ * @brief ノンテンポラルストアの書き込みを確定させる
+ *
+ * ノンテンポラルストアは通常のストアと順序が保証されないため、
+ * 呼び出し元に戻る前（他のスレッドに出力を渡す前）に実行します。
+ */
+static void cstruct_stream_fence(void) {
+#if defined(__SSE2__)
+    _mm_sfence();
+#endif
+}
+
+/**
+ * @brief 配列トークンをストリーミングでパックする
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param tok フォーマットトークン（整数・浮動小数点数の配列）
+ * @param values 値の配列
+ * @return パック後の次の位置、エラー時はNULL
+ */
+void *cstruct_pack_stream(void *dst, size_t dstlen, const cstruct_token_t *tok, const void *values) {
+    uint8_t stage[CSTRUCT_STREAM_BLOCK];
+    uint8_t *out = (uint8_t *)dst;
+    const uint8_t *in = (const uint8_t *)values;
+
+    if (tok->size == 0 || tok->count > dstlen / tok->size) {
+        return NULL;
+    }
+
+    size_t csize = cstruct_token_elem_size(tok);
+    size_t total = tok->size * tok->count;
+    if (tok->type == CSTRUCT_TYPE_PADDING || tok->type == CSTRUCT_TYPE_STRING || tok->channels != 0 ||
+        total < cstruct_stream_limit || csize > CSTRUCT_STREAM_BLOCK) {
+        return cstruct_pack_token(out, tok, values);
+    }
+
+    // 入力・出力のどちらもブロックに収まる要素数ずつ処理する
+    cstruct_token_t part = *tok;
+    size_t per = CSTRUCT_STREAM_BLOCK / (csize > tok->size ? csize : tok->size);
+    size_t left = tok->count;
+    while (left > 0) {
+        part.count = left < per ? left : per;
+        left -= part.count;
+        cstruct_stream_prefetch(in + part.count * csize, (left < per ? left : per) * csize);
+        cstruct_pack_token(stage, &part, in);
+        cstruct_stream_copy(out, stage, part.count * tok->size);
+        in += part.count * csize;
+        out += part.count * tok->size;
+    }
+    cstruct_stream_fence();
+
+    return out;
+}
+
+/**
+ * @brief 配列トークンをストリーミングでアンパックする
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param tok フォーマットトークン（整数・浮動小数点数の配列）
+ * @param values 格納先の配列
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_stream(const void *src, size_t srclen, const cstruct_token_t *tok, void *values) {
+    uint8_t stage[CSTRUCT_STREAM_BLOCK];
+    const uint8_t *in = (const uint8_t *)src;
+    uint8_t *out = (uint8_t *)values;
+
+    if (tok->size == 0 || tok->count > srclen / tok->size) {
+        return NULL;
+    }
+
+    size_t csize = cstruct_token_elem_size(tok);
+    if (tok->type == CSTRUCT_TYPE_PADDING || tok->type == CSTRUCT_TYPE_STRING || tok->channels != 0 ||
+        csize * tok->count < cstruct_stream_limit || csize > CSTRUCT_STREAM_BLOCK) {
+        return cstruct_unpack_token(in, tok, values);
+    }
+
+    cstruct_token_t part = *tok;
+    size_t per = CSTRUCT_STREAM_BLOCK / (csize > tok->size ? csize : tok->size);
+    size_t left = tok->count;
+    while (left > 0) {
+        part.count = left < per ? left : per;
+        left -= part.count;
+        cstruct_stream_prefetch(in + part.count * tok->size, (left < per ? left : per) * tok->size);
+        cstruct_unpack_token(in, &part, stage);
+        cstruct_stream_copy(out, stage, part.count * csize);
+        in += part.count * tok->size;
+        out += part.count * csize;
+    }
+    cstruct_stream_fence();
+
+    return in;
+}
+
+/**
+ * @brief 連続したレコード列を構造体の配列へストリーミングでアンパックする
+ *
+ * cstruct_unpack_bound_batch()と同じ結果になります。
+ * ただし、しきい値以上の場合は構造体のうち対応付けのないバイト（構造体のパディングなど）は0になります。
+ *
+ * @param src 入力元バッファ（レコードが隙間なく並んだもの）
+ * @param srclen 入力元バッファのサイズ
+ * @param binding 対応付け
+ * @param recs 構造体の配列
+ * @param stride 構造体1つ分のバイト数（sizeof）
+ * @param nrec レコード数
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_batch_stream(const void *src, size_t srclen, const cstruct_binding_t *binding,
+                                        void *recs, size_t stride, size_t nrec) {
+    uint8_t stage[CSTRUCT_STREAM_BLOCK];
+    size_t size = binding->plan->size;
+    const uint8_t *in = (const uint8_t *)src;
+    uint8_t *out = (uint8_t *)recs;
+
+    if (size != 0 && nrec > srclen / size) {
+        return NULL;
+    }
+    if (stride == 0 || stride > CSTRUCT_STREAM_BLOCK || nrec > SIZE_MAX / stride ||
+        stride * nrec < cstruct_stream_limit) {
+        return cstruct_unpack_bound_batch(in, srclen, binding, recs, stride, nrec);
+    }
+
+    // 対応付けのないバイトが前回のブロックの内容にならないよう、中間バッファを0で初期化する
+    memset(stage, 0, sizeof(stage));
+
+    size_t per = CSTRUCT_STREAM_BLOCK / stride;
+    size_t left = nrec;
+    while (left > 0) {
+        size_t n = left < per ? left : per;
+        left -= n;
+        cstruct_stream_prefetch(in + n * size, (left < per ? left : per) * size);
+        in = (const uint8_t *)cstruct_unpack_bound_batch(in, n * size, binding, stage, stride, n);
+        cstruct_stream_copy(out, stage, n * stride);
+        out += n * stride;
+    }
+    cstruct_stream_fence();
+
+    return in;
+}
+
+#endif /* !ARDUINO */
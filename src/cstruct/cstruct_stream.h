@@ -0,0 +1,94 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file cstruct_stream.h
+ * @brief 大きな配列・レコード列のストリーミング変換のヘッダファイル（ホスト専用）
+ *
+ * 数百MB規模の配列やレコード列を変換する際に、入力を先読み（プリフェッチ）し、
+ * 出力をキャッシュを経由しないストア（ノンテンポラルストア）で書き込みます。
+ * 変換結果をすぐに読まない大きな出力で、他のスレッドが使っているキャッシュラインを
+ * 追い出さないようにするためのものです。
+ *
+ * - 入力をブロック単位で変換し、L1キャッシュに収まる中間バッファを経由して出力へ書き込む
+ * - 出力がしきい値（cstruct_stream_set_threshold()）未満の場合は通常の変換を行う
+ * - ノンテンポラルストアはSSE2が使える環境でのみ使用し、最後にsfenceで順序を確定する
+ *   （それ以外の環境ではプリフェッチのみ行う）
+ */
+#ifndef CSTRUCT_STREAM_H
+#define CSTRUCT_STREAM_H
+
+#if !defined(ARDUINO)
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cstruct.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief ノンテンポラルストアを使い始める出力サイズを設定する
+ *
+ * プロセス全体の設定です。変換を始める前に設定してください。
+ *
+ * @param bytes 出力のバイト数（SIZE_MAXで常に通常の変換）
+ */
+void cstruct_stream_set_threshold(size_t bytes);
+
+/**
+ * @brief ノンテンポラルストアを使い始める出力サイズを取得する
+ * @return 出力のバイト数
+ */
+size_t cstruct_stream_threshold(void);
+
+/**
+ * @brief 配列トークンをストリーミングでパックする
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param tok フォーマットトークン（整数・浮動小数点数の配列）
+ * @param values 値の配列
+ * @return パック後の次の位置、エラー時はNULL
+ */
+void *cstruct_pack_stream(void *dst, size_t dstlen, const cstruct_token_t *tok, const void *values);
+
+/**
+ * @brief 配列トークンをストリーミングでアンパックする
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param tok フォーマットトークン（整数・浮動小数点数の配列）
+ * @param values 格納先の配列
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_stream(const void *src, size_t srclen, const cstruct_token_t *tok, void *values);
+
+/**
+ * @brief 連続したレコード列を構造体の配列へストリーミングでアンパックする
+ *
+ * cstruct_unpack_bound_batch()と同じ結果になります。
+ * ただし、しきい値以上の場合は構造体のうち対応付けのないバイト（構造体のパディングなど）は0になります。
+ *
+ * @param src 入力元バッファ（レコードが隙間なく並んだもの）
+ * @param srclen 入力元バッファのサイズ
+ * @param binding 対応付け
+ * @param recs 構造体の配列
+ * @param stride 構造体1つ分のバイト数（sizeof）
+ * @param nrec レコード数
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_unpack_batch_stream(const void *src, size_t srclen, const cstruct_binding_t *binding,
+                                        void *recs, size_t stride, size_t nrec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !ARDUINO */
+
+#endif /* CSTRUCT_STREAM_H */
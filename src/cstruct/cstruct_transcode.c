@@ -0,0 +1,380 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file cstruct_transcode.c
+ * @brief フォーマット間の変換（トランスコード）の実装
+ */
+#include "cstruct_transcode.h"
+#include <string.h>
+
+/** @brief 型変換で一度に処理する要素数 */
+#if defined(__AVR__)
+#define CSTRUCT_XC_BLOCK 8
+#else
+#define CSTRUCT_XC_BLOCK 64
+#endif
+
+/**
+ * @brief 数値として変換できる型か調べる
+ * @param type データ型
+ * @return 変換できる場合は1
+ */
+static int cstruct_xc_numeric(cstruct_type_t type) {
+    return type <= CSTRUCT_TYPE_UINT64 || type == CSTRUCT_TYPE_FLOAT16 ||
+           type == CSTRUCT_TYPE_FLOAT32 || type == CSTRUCT_TYPE_FLOAT64;
+}
+
+/**
+ * @brief 変換先のトークンの値を受け渡すC言語上の型を返す
+ * @param type 変換先のデータ型
+ * @return C言語上の型
+ */
+static cstruct_type_t cstruct_xc_ctype(cstruct_type_t type) {
+    return type == CSTRUCT_TYPE_FLOAT16 ? CSTRUCT_TYPE_FLOAT32 : type;
+}
+
+/**
+ * @brief 処理単位を追加する
+ *
+ * 直前の処理単位と連続するコピー・0埋めはまとめます。
+ *
+ * @param xc 変換
+ * @param capacity 処理単位の格納先の要素数
+ * @param op 追加する処理単位
+ * @return 成功時は0、容量不足の場合は-1
+ */
+static int cstruct_xc_emit(cstruct_transcoder_t *xc, size_t capacity, const cstruct_xop_t *op) {
+    if (xc->count > 0) {
+        cstruct_xop_t *prev = &xc->ops[xc->count - 1];
+        if (prev->kind == op->kind && prev->dst + prev->len == op->dst) {
+            if (op->kind == CSTRUCT_XOP_ZERO || (op->kind == CSTRUCT_XOP_COPY && prev->src + prev->len == op->src)) {
+                prev->len += op->len;
+                return 0;
+            }
+        }
+    }
+    if (xc->count >= capacity) {
+        return -1;
+    }
+    xc->ops[xc->count++] = *op;
+    return 0;
+}
+
+/**
+ * @brief フォーマット間の変換をコンパイルする
+ *
+ * @param xc 初期化する変換
+ * @param ops 処理単位の格納先
+ * @param capacity opsの要素数
+ * @param src 変換元のプラン（xcより長く保持すること）
+ * @param dst 変換先のプラン（xcより長く保持すること）
+ * @param map 変換先のフィールド（パディングを除く）ごとの変換元のフィールド番号、
+ *            またはCSTRUCT_TRANSCODE_NONE（NULLで同じ番号どうしを対応付ける）
+ * @return 成功時はxc、エラー時（容量不足、変換できない組み合わせ、要素数の不一致）はNULL
+ */
+cstruct_transcoder_t *cstruct_transcoder_compile(cstruct_transcoder_t *xc, cstruct_xop_t *ops, size_t capacity,
+                                                 const cstruct_plan_t *src, const cstruct_plan_t *dst,
+                                                 const int *map) {
+    xc->src = src;
+    xc->dst = dst;
+    xc->ops = ops;
+    xc->count = 0;
+
+    size_t doff = 0;
+    size_t field = 0;
+    for (size_t i = 0; i < dst->count; i++) {
+        const cstruct_token_t *dtok = &dst->tokens[i];
+        size_t dlen = dtok->size * dtok->count;
+        cstruct_xop_t op = {CSTRUCT_XOP_ZERO, 0, doff, dlen, NULL, NULL};
+
+        if (dtok->type != CSTRUCT_TYPE_PADDING) {
+            int sfield = (map != NULL) ? map[field] : (int)field;
+            field++;
+
+            // 変換元のフィールドを探す
+            const cstruct_token_t *stok = NULL;
+            size_t soff = 0;
+            if (sfield != CSTRUCT_TRANSCODE_NONE) {
+                int n = 0;
+                for (size_t j = 0; j < src->count; j++) {
+                    const cstruct_token_t *t = &src->tokens[j];
+                    if (t->type != CSTRUCT_TYPE_PADDING && n++ == sfield) {
+                        stok = t;
+                        break;
+                    }
+                    soff += t->size * t->count;
+                }
+                if (stok == NULL) {
+                    return NULL;
+                }
+            }
+
+            if (stok != NULL) {
+                op.src = soff;
+                op.stok = stok;
+                op.dtok = dtok;
+                if (stok->type == CSTRUCT_TYPE_STRING || dtok->type == CSTRUCT_TYPE_STRING) {
+                    if (stok->type != dtok->type) {
+                        return NULL;
+                    }
+                    op.kind = CSTRUCT_XOP_STRING;
+                } else if (stok->count != dtok->count) {
+                    return NULL;
+                } else if (stok->type == dtok->type && stok->size == dtok->size) {
+                    if (stok->size == 1 || stok->endian == dtok->endian) {
+                        op.kind = CSTRUCT_XOP_COPY;
+                        op.stok = op.dtok = NULL;
+                    } else if (stok->type == CSTRUCT_TYPE_PACKED12) {
+                        // 12ビットの組はバイト順の逆転では詰め方を変換できない
+                        return NULL;
+                    } else {
+                        op.kind = CSTRUCT_XOP_SWAP;
+                    }
+                } else if (cstruct_xc_numeric(stok->type) && cstruct_xc_numeric(dtok->type)) {
+                    op.kind = CSTRUCT_XOP_CONVERT;
+                } else {
+                    return NULL;
+                }
+            }
+        }
+
+        if (dlen > 0 && cstruct_xc_emit(xc, capacity, &op) != 0) {
+            return NULL;
+        }
+        doff += dlen;
+    }
+
+    return xc;
+}
+
+/**
+ * @brief 幅を縮めた整数（"i:24"など）の範囲に値を飽和させる
+ *
+ * cstruct_unpack_convert()はC言語上の型の範囲で飽和させるため、ワイヤ上の幅が狭い場合は
+ * そのままパックすると上位ビットが切り捨てられて値が回り込みます。
+ *
+ * @param vals C言語上の型の値の配列
+ * @param tok 変換先のトークン
+ * @param n 要素数
+ */
+static void cstruct_xc_clamp_narrow(void *vals, const cstruct_token_t *tok, size_t n) {
+    size_t csize;
+    int is_signed;
+    switch (tok->type) {
+        case CSTRUCT_TYPE_INT8:   csize = 1; is_signed = 1; break;
+        case CSTRUCT_TYPE_UINT8:  csize = 1; is_signed = 0; break;
+        case CSTRUCT_TYPE_INT16:  csize = 2; is_signed = 1; break;
+        case CSTRUCT_TYPE_UINT16: csize = 2; is_signed = 0; break;
+        case CSTRUCT_TYPE_INT32:  csize = 4; is_signed = 1; break;
+        case CSTRUCT_TYPE_UINT32: csize = 4; is_signed = 0; break;
+        case CSTRUCT_TYPE_INT64:  csize = 8; is_signed = 1; break;
+        case CSTRUCT_TYPE_UINT64: csize = 8; is_signed = 0; break;
+        default: return;
+    }
+    if (tok->size >= csize) {
+        return;
+    }
+
+    unsigned bits = (unsigned)tok->size * 8;
+    uint8_t *p = (uint8_t *)vals;
+    for (size_t i = 0; i < n; i++, p += csize) {
+        if (is_signed) {
+            int64_t v, hi = ((int64_t)1 << (bits - 1)) - 1, lo = -hi - 1;
+            switch (csize) {
+                case 2: { int16_t t; memcpy(&t, p, 2); v = t; break; }
+                case 4: { int32_t t; memcpy(&t, p, 4); v = t; break; }
+                default: memcpy(&v, p, 8); break;
+            }
+            if (v > hi || v < lo) {
+                v = v > hi ? hi : lo;
+                switch (csize) {
+                    case 2: { int16_t t = (int16_t)v; memcpy(p, &t, 2); break; }
+                    case 4: { int32_t t = (int32_t)v; memcpy(p, &t, 4); break; }
+                    default: memcpy(p, &v, 8); break;
+                }
+            }
+        } else {
+            uint64_t v, hi = ((uint64_t)1 << bits) - 1;
+            switch (csize) {
+                case 2: { uint16_t t; memcpy(&t, p, 2); v = t; break; }
+                case 4: { uint32_t t; memcpy(&t, p, 4); v = t; break; }
+                default: memcpy(&v, p, 8); break;
+            }
+            if (v > hi) {
+                switch (csize) {
+                    case 2: { uint16_t t = (uint16_t)hi; memcpy(p, &t, 2); break; }
+                    case 4: { uint32_t t = (uint32_t)hi; memcpy(p, &t, 4); break; }
+                    default: memcpy(p, &hi, 8); break;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief 型変換の処理単位を実行する
+ *
+ * cstruct_unpack_convert()で変換先のC言語上の型に取り出し、変換先のトークンでパックします。
+ * 変換先が幅を縮めた整数の場合は、その幅の範囲に飽和させてからパックします。
+ *
+ * @param out 変換先
+ * @param in 変換元
+ * @param op 処理単位
+ */
+static void cstruct_xc_convert(uint8_t *out, const uint8_t *in, const cstruct_xop_t *op) {
+    union {
+        uint64_t u[CSTRUCT_XC_BLOCK];
+        double d[CSTRUCT_XC_BLOCK];
+    } tmp;
+    cstruct_token_t spart = *op->stok;
+    cstruct_token_t dpart = *op->dtok;
+    cstruct_type_t ctype = cstruct_xc_ctype(op->dtok->type);
+
+    // ワイヤ上の並びはインターリーブの有無によらないため、通常の配列として変換する
+    spart.channels = dpart.channels = 0;
+
+    for (size_t left = op->stok->count; left > 0; left -= spart.count) {
+        spart.count = dpart.count = left < CSTRUCT_XC_BLOCK ? left : CSTRUCT_XC_BLOCK;
+        cstruct_unpack_convert(in, spart.size * spart.count, &spart, &tmp, ctype, 1.0, 0.0);
+        cstruct_xc_clamp_narrow(&tmp, &dpart, dpart.count);
+        out = (uint8_t *)cstruct_pack_token(out, &dpart, &tmp);
+        in += spart.size * spart.count;
+    }
+}
+
+/**
+ * @brief 処理単位を1レコード分実行する
+ * @param out 出力先のレコード
+ * @param in 入力元のレコード
+ * @param op 処理単位
+ */
+static void cstruct_xc_op(uint8_t *out, const uint8_t *in, const cstruct_xop_t *op) {
+    switch (op->kind) {
+        case CSTRUCT_XOP_COPY:
+            memcpy(out + op->dst, in + op->src, op->len);
+            break;
+
+        case CSTRUCT_XOP_SWAP: {
+            // 1トークンのプランとしてバイト順を逆転する
+            cstruct_plan_t one = {(cstruct_token_t *)op->dtok, 1, op->len, 1};
+            memcpy(out + op->dst, in + op->src, op->len);
+            cstruct_swap_inplace_plan(out + op->dst, op->len, &one);
+            break;
+        }
+
+        case CSTRUCT_XOP_CONVERT:
+            cstruct_xc_convert(out + op->dst, in + op->src, op);
+            break;
+
+        case CSTRUCT_XOP_STRING: {
+            size_t n = op->stok->size < op->len ? op->stok->size : op->len;
+            memcpy(out + op->dst, in + op->src, n);
+            memset(out + op->dst + n, 0, op->len - n);
+            break;
+        }
+
+        default:
+            memset(out + op->dst, 0, op->len);
+            break;
+    }
+}
+
+/**
+ * @brief 複数のレコードのスカラーフィールドをまとめて型変換する
+ *
+ * 各レコードのフィールドを連続した領域に集めて1つの配列として変換し、
+ * 結果を各レコードへ書き戻します。
+ *
+ * @param out 出力先の先頭のレコード
+ * @param in 入力元の先頭のレコード
+ * @param op 処理単位（要素数1の型変換）
+ * @param xc 変換
+ * @param nrec レコード数（CSTRUCT_XC_BLOCK以下）
+ */
+static void cstruct_xc_convert_column(uint8_t *out, const uint8_t *in, const cstruct_xop_t *op,
+                                      const cstruct_transcoder_t *xc, size_t nrec) {
+    uint64_t gather[CSTRUCT_XC_BLOCK];
+    uint64_t scatter[CSTRUCT_XC_BLOCK];
+    cstruct_xop_t col = *op;
+    cstruct_token_t spart = *op->stok;
+    cstruct_token_t dpart = *op->dtok;
+    size_t ssize = spart.size;
+    size_t dsize = dpart.size;
+
+    for (size_t r = 0; r < nrec; r++) {
+        memcpy((uint8_t *)gather + ssize * r, in + xc->src->size * r + op->src, ssize);
+    }
+    spart.count = dpart.count = nrec;
+    col.stok = &spart;
+    col.dtok = &dpart;
+    cstruct_xc_convert((uint8_t *)scatter, (const uint8_t *)gather, &col);
+    for (size_t r = 0; r < nrec; r++) {
+        memcpy(out + xc->dst->size * r + op->dst, (const uint8_t *)scatter + dsize * r, dsize);
+    }
+}
+
+/**
+ * @brief レコードを1つ変換する
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param xc 変換
+ * @return 出力の次の位置、エラー時はNULL
+ */
+void *cstruct_transcode(void *dst, size_t dstlen, const void *src, size_t srclen, const cstruct_transcoder_t *xc) {
+    if (dstlen < xc->dst->size || srclen < xc->src->size) {
+        return NULL;
+    }
+    for (size_t i = 0; i < xc->count; i++) {
+        cstruct_xc_op((uint8_t *)dst, (const uint8_t *)src, &xc->ops[i]);
+    }
+    return (uint8_t *)dst + xc->dst->size;
+}
+
+/**
+ * @brief 連続したレコード列を変換する
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param src 入力元バッファ（レコードが隙間なく並んだもの）
+ * @param srclen 入力元バッファのサイズ
+ * @param xc 変換
+ * @param nrec レコード数
+ * @return 出力の次の位置、エラー時はNULL
+ */
+void *cstruct_transcode_batch(void *dst, size_t dstlen, const void *src, size_t srclen,
+                              const cstruct_transcoder_t *xc, size_t nrec) {
+    uint8_t *out = (uint8_t *)dst;
+    const uint8_t *in = (const uint8_t *)src;
+    size_t ssize = xc->src->size;
+    size_t dsize = xc->dst->size;
+
+    if ((ssize != 0 && nrec > srclen / ssize) || (dsize != 0 && nrec > dstlen / dsize)) {
+        return NULL;
+    }
+
+    // 作業領域に収まる数のレコードごとに、処理単位を順に適用する
+    for (size_t left = nrec; left > 0;) {
+        size_t n = left < CSTRUCT_XC_BLOCK ? left : CSTRUCT_XC_BLOCK;
+        for (size_t i = 0; i < xc->count; i++) {
+            const cstruct_xop_t *op = &xc->ops[i];
+            if (op->kind == CSTRUCT_XOP_CONVERT && op->stok->count == 1) {
+                cstruct_xc_convert_column(out, in, op, xc, n);
+            } else {
+                for (size_t r = 0; r < n; r++) {
+                    cstruct_xc_op(out + dsize * r, in + ssize * r, op);
+                }
+            }
+        }
+        out += dsize * n;
+        in += ssize * n;
+        left -= n;
+    }
+    return out;
+}
@@ -0,0 +1,118 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file cstruct_transcode.h
+ * @brief フォーマット間の変換（トランスコード）のヘッダファイル
+ *
+ * あるフォーマットでパックされたレコードを、値を変数に取り出さずに
+ * 別のフォーマットへ直接変換します（例: ">HhhHe" → "<HffHf"）。
+ *
+ * 変換元プラン・変換先プラン・フィールドの対応表から、フィールドごとの処理
+ * （コピー・バイト順の逆転・型変換・0埋め）の列を作ります。
+ *
+ * - 変換先のフィールドは対応表で指定した変換元のフィールドから作る
+ *   （並べ替え、および変換元のフィールドの省略ができる）
+ * - 型やサイズが異なる数値フィールドはcstruct_unpack_convert()と同じ規則で変換する
+ *   （拡張、飽和付きの縮小、float16とfloat32/float64の相互変換）
+ *   変換先が幅を縮めた整数（"i:24"など）の場合は、ワイヤ上の幅の範囲で飽和させる
+ * - 変換元とワイヤ上の位置が連続したコピーは1回のmemcpyにまとめる
+ * - 変換先のパディングと、対応する変換元のないフィールドは0で埋める
+ */
+#ifndef CSTRUCT_TRANSCODE_H
+#define CSTRUCT_TRANSCODE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cstruct.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief 対応する変換元のフィールドがない（0で埋める） */
+#define CSTRUCT_TRANSCODE_NONE (-1)
+
+/**
+ * @brief 変換の処理の種類
+ */
+typedef enum {
+    CSTRUCT_XOP_COPY,    /**< そのままコピーする */
+    CSTRUCT_XOP_SWAP,    /**< コピーして要素ごとにバイト順を逆転する */
+    CSTRUCT_XOP_CONVERT, /**< 型を変換する */
+    CSTRUCT_XOP_STRING,  /**< 文字列をコピーし、余りを0で埋める */
+    CSTRUCT_XOP_ZERO     /**< 0で埋める */
+} cstruct_xop_kind_t;
+
+/**
+ * @brief 変換の処理単位
+ */
+typedef struct {
+    cstruct_xop_kind_t kind;     /**< 処理の種類 */
+    size_t src;                  /**< 変換元のオフセット */
+    size_t dst;                  /**< 変換先のオフセット */
+    size_t len;                  /**< 変換先のバイト数 */
+    const cstruct_token_t *stok; /**< 変換元のトークン（COPY・ZEROではNULL） */
+    const cstruct_token_t *dtok; /**< 変換先のトークン（COPY・ZEROではNULL） */
+} cstruct_xop_t;
+
+/**
+ * @brief コンパイル済みの変換
+ */
+typedef struct {
+    const cstruct_plan_t *src; /**< 変換元のプラン */
+    const cstruct_plan_t *dst; /**< 変換先のプラン */
+    cstruct_xop_t *ops;        /**< 処理単位の列 */
+    size_t count;              /**< 処理単位の数 */
+} cstruct_transcoder_t;
+
+/**
+ * @brief フォーマット間の変換をコンパイルする
+ *
+ * @param xc 初期化する変換
+ * @param ops 処理単位の格納先
+ * @param capacity opsの要素数
+ * @param src 変換元のプラン（xcより長く保持すること）
+ * @param dst 変換先のプラン（xcより長く保持すること）
+ * @param map 変換先のフィールド（パディングを除く）ごとの変換元のフィールド番号、
+ *            またはCSTRUCT_TRANSCODE_NONE（NULLで同じ番号どうしを対応付ける）
+ * @return 成功時はxc、エラー時（容量不足、変換できない組み合わせ、要素数の不一致）はNULL
+ */
+cstruct_transcoder_t *cstruct_transcoder_compile(cstruct_transcoder_t *xc, cstruct_xop_t *ops, size_t capacity,
+                                                 const cstruct_plan_t *src, const cstruct_plan_t *dst,
+                                                 const int *map);
+
+/**
+ * @brief レコードを1つ変換する
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param xc 変換
+ * @return 出力の次の位置、エラー時はNULL
+ */
+void *cstruct_transcode(void *dst, size_t dstlen, const void *src, size_t srclen, const cstruct_transcoder_t *xc);
+
+/**
+ * @brief 連続したレコード列を変換する
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param src 入力元バッファ（レコードが隙間なく並んだもの）
+ * @param srclen 入力元バッファのサイズ
+ * @param xc 変換
+ * @param nrec レコード数
+ * @return 出力の次の位置、エラー時はNULL
+ */
+void *cstruct_transcode_batch(void *dst, size_t dstlen, const void *src, size_t srclen,
+                              const cstruct_transcoder_t *xc, size_t nrec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CSTRUCT_TRANSCODE_H */
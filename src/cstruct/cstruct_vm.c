@@ -0,0 +1,533 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file cstruct_vm.c
+ * @brief コンパイル済みフォーマットのバイトコード実行系の実装
+ *
+ * # 命令形式
+ * - 単一値・融合命令: オペコード1バイト
+ * - 配列・文字列・パディング: オペコード1バイト + 要素数（リトルエンディアン16ビット）
+ *
+ * オペコードはデータ型をワイヤ上のサイズとエンディアンだけで区別します
+ * （符号の有無や整数・浮動小数点数の違いはバイト列の並べ替えに影響しないため）。
+ */
+#include "cstruct_vm.h"
+#include <string.h>
+
+// エンディアン検出マクロ
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__) && defined(__ORDER_BIG_ENDIAN__)
+    #define CSTRUCT_VM_HOST_BE (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#else
+    #define CSTRUCT_VM_HOST_BE ( \
+        (((union { uint16_t u16; uint8_t u8[2]; }){ 0x0100 }).u8[0] == 0x01) )
+#endif
+
+/** @brief リトルエンディアンの値を読み書きする際にバイト順の逆転が必要か */
+#define CSTRUCT_VM_SWAP_LE (CSTRUCT_VM_HOST_BE)
+/** @brief ビッグエンディアンの値を読み書きする際にバイト順の逆転が必要か */
+#define CSTRUCT_VM_SWAP_BE (!CSTRUCT_VM_HOST_BE)
+
+// GCC/Clangでは計算型gotoで命令を実行する
+#if defined(__GNUC__) && !defined(CSTRUCT_VM_NO_THREADED)
+    #define CSTRUCT_VM_THREADED 1
+#else
+    #define CSTRUCT_VM_THREADED 0
+#endif
+
+/** @brief 配列・文字列・パディングの要素数の上限 */
+#define CSTRUCT_VM_MAX_OPERAND 0xFFFFu
+
+/**
+ * @brief 単一値・配列・その他の命令（この順序がオペコードの値になる）
+ *
+ * 単一値はU8、LE16、BE16、…の順に並べ、サイズとエンディアンから計算で求められるようにしています。
+ */
+#define CSTRUCT_VM_BASE_OPS(X) \
+    X(END) \
+    X(U8) X(LE16) X(BE16) X(LE32) X(BE32) X(LE64) X(BE64) X(LE128) X(BE128) X(F16LE) X(F16BE) \
+    X(U8_N) X(LE16_N) X(BE16_N) X(LE32_N) X(BE32_N) X(LE64_N) X(BE64_N) X(LE128_N) X(BE128_N) \
+    X(F16LE_N) X(F16BE_N) \
+    X(STR) X(PAD)
+
+/**
+ * @brief 2フィールドの融合命令（名前、1つ目のサイズ、2つ目のサイズ、エンディアン）
+ *
+ * 「エンディアン × 16 + 1つ目のサイズ指数 × 4 + 2つ目のサイズ指数」の順に並べています。
+ * BE_8_8はLE_8_8と同じ動作で、変換時には使われません。
+ */
+#define CSTRUCT_VM_PAIR_OPS(P) \
+    P(LE_8_8, 1, 1, LE)   P(LE_8_16, 1, 2, LE)  P(LE_8_32, 1, 4, LE)  P(LE_8_64, 1, 8, LE)  \
+    P(LE_16_8, 2, 1, LE)  P(LE_16_16, 2, 2, LE) P(LE_16_32, 2, 4, LE) P(LE_16_64, 2, 8, LE) \
+    P(LE_32_8, 4, 1, LE)  P(LE_32_16, 4, 2, LE) P(LE_32_32, 4, 4, LE) P(LE_32_64, 4, 8, LE) \
+    P(LE_64_8, 8, 1, LE)  P(LE_64_16, 8, 2, LE) P(LE_64_32, 8, 4, LE) P(LE_64_64, 8, 8, LE) \
+    P(BE_8_8, 1, 1, BE)   P(BE_8_16, 1, 2, BE)  P(BE_8_32, 1, 4, BE)  P(BE_8_64, 1, 8, BE)  \
+    P(BE_16_8, 2, 1, BE)  P(BE_16_16, 2, 2, BE) P(BE_16_32, 2, 4, BE) P(BE_16_64, 2, 8, BE) \
+    P(BE_32_8, 4, 1, BE)  P(BE_32_16, 4, 2, BE) P(BE_32_32, 4, 4, BE) P(BE_32_64, 4, 8, BE) \
+    P(BE_64_8, 8, 1, BE)  P(BE_64_16, 8, 2, BE) P(BE_64_32, 8, 4, BE) P(BE_64_64, 8, 8, BE)
+
+/** @brief 3フィールドの融合命令（"HBI"の並び） */
+#define CSTRUCT_VM_TRIPLE_OPS(T) \
+    T(LE_16_8_32, 2, 1, 4, LE) T(BE_16_8_32, 2, 1, 4, BE)
+
+#define CSTRUCT_VM_ENUM_BASE(name) CSTRUCT_VM_##name,
+#define CSTRUCT_VM_ENUM_PAIR(name, a, b, e) CSTRUCT_VM_##name,
+#define CSTRUCT_VM_ENUM_TRIPLE(name, a, b, c, e) CSTRUCT_VM_##name,
+
+/**
+ * @brief オペコード
+ */
+enum {
+    CSTRUCT_VM_BASE_OPS(CSTRUCT_VM_ENUM_BASE)
+    CSTRUCT_VM_PAIR_OPS(CSTRUCT_VM_ENUM_PAIR)
+    CSTRUCT_VM_TRIPLE_OPS(CSTRUCT_VM_ENUM_TRIPLE)
+    CSTRUCT_VM_OP_COUNT
+};
+
+/**
+ * @brief バイト順を必要に応じて逆転しながら1要素をコピーする
+ *
+ * nとswapは呼び出し元で定数になるため、インライン展開後は分岐が消えます。
+ *
+ * @param dst コピー先
+ * @param src コピー元
+ * @param n 要素のバイト数
+ * @param swap バイト順を逆転する場合は1
+ */
+static inline void cstruct_vm_move(uint8_t *dst, const uint8_t *src, size_t n, int swap) {
+    if (!swap || n == 1) {
+        memcpy(dst, src, n);
+        return;
+    }
+#if defined(__GNUC__)
+    if (n == 2) {
+        uint16_t v;
+        memcpy(&v, src, 2);
+        v = __builtin_bswap16(v);
+        memcpy(dst, &v, 2);
+        return;
+    }
+    if (n == 4) {
+        uint32_t v;
+        memcpy(&v, src, 4);
+        v = __builtin_bswap32(v);
+        memcpy(dst, &v, 4);
+        return;
+    }
+    if (n == 8) {
+        uint64_t v;
+        memcpy(&v, src, 8);
+        v = __builtin_bswap64(v);
+        memcpy(dst, &v, 8);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = src[n - 1 - i];
+    }
+}
+
+/**
+ * @brief バイト順を必要に応じて逆転しながら配列をコピーする
+ * @param dst コピー先
+ * @param src コピー元
+ * @param n 要素のバイト数
+ * @param count 要素数
+ * @param swap バイト順を逆転する場合は1
+ */
+static inline void cstruct_vm_move_array(uint8_t *dst, const uint8_t *src, size_t n, size_t count, int swap) {
+    if (!swap || n == 1) {
+        memcpy(dst, src, n * count);
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        cstruct_vm_move(dst + i * n, src + i * n, n, swap);
+    }
+}
+
+/**
+ * @brief 単一値の融合に使うサイズ指数を求める
+ * @param tok フォーマットトークン
+ * @return サイズ1/2/4/8バイトの単一値なら0〜3、融合できない場合は-1
+ */
+static int cstruct_vm_fusable(const cstruct_token_t *tok) {
+    if (tok->count != 1 || tok->channels != 0 || tok->type == CSTRUCT_TYPE_PADDING ||
+        tok->type == CSTRUCT_TYPE_STRING || tok->type == CSTRUCT_TYPE_FLOAT16 ||
+        tok->size != cstruct_token_elem_size(tok)) {
+        return -1;
+    }
+    switch (tok->size) {
+        case 1: return 0;
+        case 2: return 1;
+        case 4: return 2;
+        case 8: return 3;
+        default: return -1;
+    }
+}
+
+/**
+ * @brief 命令を1つ書き込む
+ * @param prog プログラム
+ * @param code バイトコードの格納先
+ * @param capacity codeのバイト数
+ * @param op オペコード
+ * @param has_operand 要素数を伴う命令なら1
+ * @param operand 要素数
+ * @return 成功時は0、エラー時は-1
+ */
+static int cstruct_vm_emit(cstruct_vm_prog_t *prog, uint8_t *code, size_t capacity, int op, int has_operand,
+                           size_t operand) {
+    size_t need = has_operand ? 3 : 1;
+
+    if (capacity - prog->len < need || operand > CSTRUCT_VM_MAX_OPERAND) {
+        return -1;
+    }
+    code[prog->len++] = (uint8_t)op;
+    if (has_operand) {
+        code[prog->len++] = (uint8_t)(operand & 0xFF);
+        code[prog->len++] = (uint8_t)(operand >> 8);
+    }
+    return 0;
+}
+
+/**
+ * @brief プランをバイトコードに変換する
+ *
+ * @param prog 変換結果を格納するプログラム
+ * @param code バイトコードの格納先
+ * @param capacity codeのバイト数
+ * @param plan プラン
+ * @return 成功時はprog、エラー時（容量不足、要素数が65535を超える配列・文字列、幅を縮めた整数、インターリーブした配列）はNULL
+ */
+cstruct_vm_prog_t *cstruct_vm_compile(cstruct_vm_prog_t *prog, uint8_t *code, size_t capacity, const cstruct_plan_t *plan) {
+    const cstruct_token_t *tokens = plan->tokens;
+    size_t i = 0;
+    int r = 0;
+
+    prog->code = code;
+    prog->len = 0;
+    prog->size = plan->size;
+    prog->fields = plan->fields;
+
+    while (i < plan->count && r == 0) {
+        const cstruct_token_t *tok = &tokens[i];
+        int e = (tok->endian == CSTRUCT_ENDIAN_BIG) ? 1 : 0;
+        int a = cstruct_vm_fusable(tok);
+
+        if (a >= 0) {
+            int b = (i + 1 < plan->count) ? cstruct_vm_fusable(&tokens[i + 1]) : -1;
+            int c = (i + 2 < plan->count) ? cstruct_vm_fusable(&tokens[i + 2]) : -1;
+
+            // "HBI"（2バイト、1バイト、4バイトの並び）
+            if (a == 1 && b == 0 && c == 2 && tokens[i + 2].endian == tok->endian) {
+                r = cstruct_vm_emit(prog, code, capacity, CSTRUCT_VM_LE_16_8_32 + e, 0, 0);
+                i += 3;
+                continue;
+            }
+            // 2フィールドの並び（1バイトの値はどちらのエンディアンとも組み合わせられる）
+            if (b >= 0) {
+                int e2 = (tokens[i + 1].endian == CSTRUCT_ENDIAN_BIG) ? 1 : 0;
+                if (a == 0 || b == 0 || e == e2) {
+                    int pe = (a == 0) ? e2 : e;
+                    r = cstruct_vm_emit(prog, code, capacity, CSTRUCT_VM_LE_8_8 + pe * 16 + a * 4 + b, 0, 0);
+                    i += 2;
+                    continue;
+                }
+            }
+        }
+
+        // インターリーブした配列（"2*256h"など）に対応する命令はない
+        if (tok->channels != 0) {
+            r = -1;
+            break;
+        }
+
+        switch (tok->type) {
+            case CSTRUCT_TYPE_PADDING: {
+                // 長いパディングは複数の命令に分ける
+                size_t n = tok->size * tok->count;
+                while (n > 0 && r == 0) {
+                    size_t chunk = (n > CSTRUCT_VM_MAX_OPERAND) ? CSTRUCT_VM_MAX_OPERAND : n;
+                    r = cstruct_vm_emit(prog, code, capacity, CSTRUCT_VM_PAD, 1, chunk);
+                    n -= chunk;
+                }
+                break;
+            }
+
+            case CSTRUCT_TYPE_STRING:
+                r = cstruct_vm_emit(prog, code, capacity, CSTRUCT_VM_STR, 1, tok->size);
+                break;
+
+            case CSTRUCT_TYPE_FLOAT16:
+                if (tok->count == 1) {
+                    r = cstruct_vm_emit(prog, code, capacity, CSTRUCT_VM_F16LE + e, 0, 0);
+                } else {
+                    r = cstruct_vm_emit(prog, code, capacity, CSTRUCT_VM_F16LE_N + e, 1, tok->count);
+                }
+                break;
+
+            default: {
+                // 幅を縮めた整数（"i:24"など）に対応する命令はない
+                if (tok->size != cstruct_token_elem_size(tok)) {
+                    r = -1;
+                    break;
+                }
+                // 単一値のオペコードはU8、LE16、BE16、LE32、…の順に並んでいる
+                int op;
+                switch (tok->size) {
+                    case 1: op = CSTRUCT_VM_U8; break;
+                    case 2: op = CSTRUCT_VM_LE16 + e; break;
+                    case 4: op = CSTRUCT_VM_LE32 + e; break;
+                    case 8: op = CSTRUCT_VM_LE64 + e; break;
+                    default: op = CSTRUCT_VM_LE128 + e; break;
+                }
+                if (tok->count == 1) {
+                    r = cstruct_vm_emit(prog, code, capacity, op, 0, 0);
+                } else {
+                    r = cstruct_vm_emit(prog, code, capacity, op + (CSTRUCT_VM_U8_N - CSTRUCT_VM_U8), 1, tok->count);
+                }
+                break;
+            }
+        }
+        i++;
+    }
+
+    if (r != 0 || cstruct_vm_emit(prog, code, capacity, CSTRUCT_VM_END, 0, 0) != 0) {
+        return NULL;
+    }
+    return prog;
+}
+
+/** @brief 命令に続く16ビットの要素数を読み出す */
+#define VM_OPERAND() (pc += 2, (size_t)pc[-2] | ((size_t)pc[-1] << 8))
+
+#if CSTRUCT_VM_THREADED
+    #define VM_LABEL_BASE(name) &&L_##name,
+    #define VM_LABEL_PAIR(name, a, b, e) &&L_##name,
+    #define VM_LABEL_TRIPLE(name, a, b, c, e) &&L_##name,
+    #define VM_CASE(name) L_##name:
+    #define VM_NEXT() goto *labels[*pc++]
+    #define VM_BEGIN() \
+        static const void *const labels[CSTRUCT_VM_OP_COUNT] = { \
+            CSTRUCT_VM_BASE_OPS(VM_LABEL_BASE) \
+            CSTRUCT_VM_PAIR_OPS(VM_LABEL_PAIR) \
+            CSTRUCT_VM_TRIPLE_OPS(VM_LABEL_TRIPLE) \
+        }; \
+        VM_NEXT();
+    #define VM_END()
+#else
+    #define VM_CASE(name) case CSTRUCT_VM_##name:
+    #define VM_NEXT() continue
+    #define VM_BEGIN() for (;;) { switch (*pc++) {
+    #define VM_END() default: return NULL; } }
+#endif
+
+#define VM_PACK_SCALAR(name, n, e) \
+    VM_CASE(name) cstruct_vm_move(out, (const uint8_t *)*vp++, n, CSTRUCT_VM_SWAP_##e); out += n; VM_NEXT();
+#define VM_PACK_ARRAY(name, n, e) \
+    VM_CASE(name) count = VM_OPERAND(); \
+    cstruct_vm_move_array(out, (const uint8_t *)*vp++, n, count, CSTRUCT_VM_SWAP_##e); out += n * count; VM_NEXT();
+#define VM_PACK_PAIR(name, a, b, e) \
+    VM_CASE(name) \
+    cstruct_vm_move(out, (const uint8_t *)vp[0], a, CSTRUCT_VM_SWAP_##e); \
+    cstruct_vm_move(out + a, (const uint8_t *)vp[1], b, CSTRUCT_VM_SWAP_##e); \
+    vp += 2; out += a + b; VM_NEXT();
+#define VM_PACK_TRIPLE(name, a, b, c, e) \
+    VM_CASE(name) \
+    cstruct_vm_move(out, (const uint8_t *)vp[0], a, CSTRUCT_VM_SWAP_##e); \
+    cstruct_vm_move(out + a, (const uint8_t *)vp[1], b, CSTRUCT_VM_SWAP_##e); \
+    cstruct_vm_move(out + a + b, (const uint8_t *)vp[2], c, CSTRUCT_VM_SWAP_##e); \
+    vp += 3; out += a + b + c; VM_NEXT();
+
+#if CSTRUCT_VM_THREADED
+    // 計算型gotoはGNU拡張のため、インタプリタ関数に限って-pedanticの警告を抑止する
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+/**
+ * @brief バイトコードに従ってパックする
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param prog プログラム
+ * @param values フィールドごとの値へのポインタ（文字列の場合は文字列）
+ * @return パック後の次の位置、エラー時はNULL
+ */
+void *cstruct_vm_pack(void *dst, size_t dstlen, const cstruct_vm_prog_t *prog, const void *const *values) {
+    const uint8_t *pc = prog->code;
+    const void *const *vp = values;
+    uint8_t *out = (uint8_t *)dst;
+    size_t count;
+
+    // パック後のサイズは固定のため、サイズチェックは一度だけ行う
+    if (dstlen < prog->size) {
+        return NULL;
+    }
+
+    VM_BEGIN()
+    VM_CASE(END)
+        return out;
+    VM_PACK_SCALAR(U8, 1, LE)
+    VM_PACK_SCALAR(LE16, 2, LE)
+    VM_PACK_SCALAR(BE16, 2, BE)
+    VM_PACK_SCALAR(LE32, 4, LE)
+    VM_PACK_SCALAR(BE32, 4, BE)
+    VM_PACK_SCALAR(LE64, 8, LE)
+    VM_PACK_SCALAR(BE64, 8, BE)
+    VM_PACK_SCALAR(LE128, 16, LE)
+    VM_PACK_SCALAR(BE128, 16, BE)
+    VM_CASE(F16LE)
+        out = (uint8_t *)cstruct_pack_float16_le(out, *(const float *)*vp++);
+        VM_NEXT();
+    VM_CASE(F16BE)
+        out = (uint8_t *)cstruct_pack_float16_be(out, *(const float *)*vp++);
+        VM_NEXT();
+    VM_PACK_ARRAY(U8_N, 1, LE)
+    VM_PACK_ARRAY(LE16_N, 2, LE)
+    VM_PACK_ARRAY(BE16_N, 2, BE)
+    VM_PACK_ARRAY(LE32_N, 4, LE)
+    VM_PACK_ARRAY(BE32_N, 4, BE)
+    VM_PACK_ARRAY(LE64_N, 8, LE)
+    VM_PACK_ARRAY(BE64_N, 8, BE)
+    VM_PACK_ARRAY(LE128_N, 16, LE)
+    VM_PACK_ARRAY(BE128_N, 16, BE)
+    VM_CASE(F16LE_N) {
+        const float *arr = (const float *)*vp++;
+        count = VM_OPERAND();
+        for (size_t i = 0; i < count; i++) {
+            out = (uint8_t *)cstruct_pack_float16_le(out, arr[i]);
+        }
+        VM_NEXT();
+    }
+    VM_CASE(F16BE_N) {
+        const float *arr = (const float *)*vp++;
+        count = VM_OPERAND();
+        for (size_t i = 0; i < count; i++) {
+            out = (uint8_t *)cstruct_pack_float16_be(out, arr[i]);
+        }
+        VM_NEXT();
+    }
+    VM_CASE(STR)
+        count = VM_OPERAND();
+        out = (uint8_t *)cstruct_pack_string(out, (const char *)*vp++, count);
+        VM_NEXT();
+    VM_CASE(PAD)
+        // cstruct_pack_padding()と同じく、パディング領域には書き込まない
+        count = VM_OPERAND();
+        out += count;
+        VM_NEXT();
+    CSTRUCT_VM_PAIR_OPS(VM_PACK_PAIR)
+    CSTRUCT_VM_TRIPLE_OPS(VM_PACK_TRIPLE)
+    VM_END()
+}
+
+#if CSTRUCT_VM_THREADED
+    #pragma GCC diagnostic pop
+#endif
+
+#define VM_UNPACK_SCALAR(name, n, e) \
+    VM_CASE(name) cstruct_vm_move((uint8_t *)*vp++, in, n, CSTRUCT_VM_SWAP_##e); in += n; VM_NEXT();
+#define VM_UNPACK_ARRAY(name, n, e) \
+    VM_CASE(name) count = VM_OPERAND(); \
+    cstruct_vm_move_array((uint8_t *)*vp++, in, n, count, CSTRUCT_VM_SWAP_##e); in += n * count; VM_NEXT();
+#define VM_UNPACK_PAIR(name, a, b, e) \
+    VM_CASE(name) \
+    cstruct_vm_move((uint8_t *)vp[0], in, a, CSTRUCT_VM_SWAP_##e); \
+    cstruct_vm_move((uint8_t *)vp[1], in + a, b, CSTRUCT_VM_SWAP_##e); \
+    vp += 2; in += a + b; VM_NEXT();
+#define VM_UNPACK_TRIPLE(name, a, b, c, e) \
+    VM_CASE(name) \
+    cstruct_vm_move((uint8_t *)vp[0], in, a, CSTRUCT_VM_SWAP_##e); \
+    cstruct_vm_move((uint8_t *)vp[1], in + a, b, CSTRUCT_VM_SWAP_##e); \
+    cstruct_vm_move((uint8_t *)vp[2], in + a + b, c, CSTRUCT_VM_SWAP_##e); \
+    vp += 3; in += a + b + c; VM_NEXT();
+
+#if CSTRUCT_VM_THREADED
+    // 計算型gotoを使うため、cstruct_vm_pack()と同様に-pedanticの警告を抑止する
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+/**
+ * @brief バイトコードに従ってアンパックする
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param prog プログラム
+ * @param values フィールドごとの格納先へのポインタ
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_vm_unpack(const void *src, size_t srclen, const cstruct_vm_prog_t *prog, void *const *values) {
+    const uint8_t *pc = prog->code;
+    void *const *vp = values;
+    const uint8_t *in = (const uint8_t *)src;
+    size_t count;
+
+    // パック後のサイズは固定のため、サイズチェックは一度だけ行う
+    if (srclen < prog->size) {
+        return NULL;
+    }
+
+    VM_BEGIN()
+    VM_CASE(END)
+        return in;
+    VM_UNPACK_SCALAR(U8, 1, LE)
+    VM_UNPACK_SCALAR(LE16, 2, LE)
+    VM_UNPACK_SCALAR(BE16, 2, BE)
+    VM_UNPACK_SCALAR(LE32, 4, LE)
+    VM_UNPACK_SCALAR(BE32, 4, BE)
+    VM_UNPACK_SCALAR(LE64, 8, LE)
+    VM_UNPACK_SCALAR(BE64, 8, BE)
+    VM_UNPACK_SCALAR(LE128, 16, LE)
+    VM_UNPACK_SCALAR(BE128, 16, BE)
+    VM_CASE(F16LE)
+        in = (const uint8_t *)cstruct_unpack_float16_le(in, (float *)*vp++);
+        VM_NEXT();
+    VM_CASE(F16BE)
+        in = (const uint8_t *)cstruct_unpack_float16_be(in, (float *)*vp++);
+        VM_NEXT();
+    VM_UNPACK_ARRAY(U8_N, 1, LE)
+    VM_UNPACK_ARRAY(LE16_N, 2, LE)
+    VM_UNPACK_ARRAY(BE16_N, 2, BE)
+    VM_UNPACK_ARRAY(LE32_N, 4, LE)
+    VM_UNPACK_ARRAY(BE32_N, 4, BE)
+    VM_UNPACK_ARRAY(LE64_N, 8, LE)
+    VM_UNPACK_ARRAY(BE64_N, 8, BE)
+    VM_UNPACK_ARRAY(LE128_N, 16, LE)
+    VM_UNPACK_ARRAY(BE128_N, 16, BE)
+    VM_CASE(F16LE_N) {
+        float *arr = (float *)*vp++;
+        count = VM_OPERAND();
+        for (size_t i = 0; i < count; i++) {
+            in = (const uint8_t *)cstruct_unpack_float16_le(in, &arr[i]);
+        }
+        VM_NEXT();
+    }
+    VM_CASE(F16BE_N) {
+        float *arr = (float *)*vp++;
+        count = VM_OPERAND();
+        for (size_t i = 0; i < count; i++) {
+            in = (const uint8_t *)cstruct_unpack_float16_be(in, &arr[i]);
+        }
+        VM_NEXT();
+    }
+    VM_CASE(STR)
+        count = VM_OPERAND();
+        in = (const uint8_t *)cstruct_unpack_string(in, (char *)*vp++, count);
+        VM_NEXT();
+    VM_CASE(PAD)
+        count = VM_OPERAND();
+        in += count;
+        VM_NEXT();
+    CSTRUCT_VM_PAIR_OPS(VM_UNPACK_PAIR)
+    CSTRUCT_VM_TRIPLE_OPS(VM_UNPACK_TRIPLE)
+    VM_END()
+}
+
+#if CSTRUCT_VM_THREADED
+    #pragma GCC diagnostic pop
+#endif
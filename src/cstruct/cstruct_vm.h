@@ -0,0 +1,80 @@
+/* =========================================================================
+    cstruct; binary pack/unpack tools.
+    Copyright (c) 2025 Sensignal Co.,Ltd.
+    SPDX-License-Identifier: Apache-2.0
+========================================================================= */
+
+/**
+ * @file cstruct_vm.h
+ * @brief コンパイル済みフォーマットのバイトコード実行系のヘッダファイル
+ *
+ * プランをトークン列よりも小さなバイトコードに変換し、専用のインタプリタで
+ * パック・アンパックします。
+ *
+ * - 1命令は1バイト（単一値）または3バイト（配列・文字列・パディング、要素数は16ビット）
+ * - データ型・エンディアン・単一値か配列かを1つのオペコードにまとめ、実行時の分岐をなくす
+ * - よく現れる単一値の並び（2フィールド、および "HBI"）は1命令に融合する
+ * - GCC/Clangでは計算型goto（スレッデッドディスパッチ）で命令を実行する
+ *
+ * 値は、フィールド（パディングを除く）ごとのポインタ配列で受け渡します。
+ * 変換後はトークン列の領域が不要になるため、プランのトークン列は一時領域で構いません。
+ */
+#ifndef CSTRUCT_VM_H
+#define CSTRUCT_VM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cstruct.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief バイトコード化したフォーマット
+ */
+typedef struct {
+    const uint8_t *code; /**< バイトコード */
+    size_t len;          /**< バイトコードのバイト数 */
+    size_t size;         /**< パック後のバイト数 */
+    size_t fields;       /**< 値を受け渡すフィールド数（パディングを除く） */
+} cstruct_vm_prog_t;
+
+/**
+ * @brief プランをバイトコードに変換する
+ *
+ * @param prog 変換結果を格納するプログラム
+ * @param code バイトコードの格納先
+ * @param capacity codeのバイト数
+ * @param plan プラン
+ * @return 成功時はprog、エラー時（容量不足、要素数が65535を超える配列・文字列、幅を縮めた整数、インターリーブした配列）はNULL
+ */
+cstruct_vm_prog_t *cstruct_vm_compile(cstruct_vm_prog_t *prog, uint8_t *code, size_t capacity, const cstruct_plan_t *plan);
+
+/**
+ * @brief バイトコードに従ってパックする
+ *
+ * @param dst 出力先バッファ
+ * @param dstlen 出力先バッファのサイズ
+ * @param prog プログラム
+ * @param values フィールドごとの値へのポインタ（文字列の場合は文字列）
+ * @return パック後の次の位置、エラー時はNULL
+ */
+void *cstruct_vm_pack(void *dst, size_t dstlen, const cstruct_vm_prog_t *prog, const void *const *values);
+
+/**
+ * @brief バイトコードに従ってアンパックする
+ *
+ * @param src 入力元バッファ
+ * @param srclen 入力元バッファのサイズ
+ * @param prog プログラム
+ * @param values フィールドごとの格納先へのポインタ
+ * @return アンパック後の次の位置、エラー時はNULL
+ */
+const void *cstruct_vm_unpack(const void *src, size_t srclen, const cstruct_vm_prog_t *prog, void *const *values);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CSTRUCT_VM_H */